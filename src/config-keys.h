@@ -112,6 +112,7 @@
 #define MOD_CFG_MAP_TRACK_COL         "TRACK_COLOUR"
 #define MOD_CFG_MAP_TRACK_NUM         "TRACK_NUMBER"
 #define MOD_CFG_MAP_KEEP_RATIO        "KEEP_RATIO"
+#define MOD_CFG_MAP_SAT_LAYER         "SAT_LAYER"
 #define MOD_CFG_MAP_SHADOW_ALPHA      "SHADOW_ALPHA"
 #define MOD_CFG_MAP_SHOWTRACKS        "SHOWTRACKS"
 #define MOD_CFG_MAP_HIDECOVS          "HIDECOVS"
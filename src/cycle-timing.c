@@ -0,0 +1,214 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file cycle-timing.c
+ * \brief Timing of the module update cycle.
+ *
+ * When a module can not keep up with its refresh rate, the time is spent
+ * in one or more of the phases of the update cycle: the QTH update, the
+ * AOS/LOS updates, the propagation or one of the views. Each phase is
+ * timed with the monotonic clock and the most recent durations are kept
+ * in a ring buffer, from which the median, the 95th percentile and the
+ * maximum are calculated on demand. The summaries are shown in the
+ * preferences and, if enabled, written to the log once a minute.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cycle-timing.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+
+/** \brief Interval between the logged summaries [usec]. */
+#define CYCLE_TIMING_LOG_INTERVAL (60 * G_USEC_PER_SEC)
+
+/** \brief Names of the phases, in the order of cycle_phase_t. */
+static const gchar *const PHASE_NAME[CYCLE_PHASE_NUM] = {
+    N_("Timeout"),
+    N_("QTH update"),
+    N_("Header"),
+    N_("Event scheduling"),
+    N_("Event search"),
+    N_("Sky at glance"),
+    N_("Propagation"),
+    N_("View update"),
+    N_("Snapshot copy"),
+    N_("List view"),
+    N_("Map view"),
+    N_("Polar view"),
+    N_("Single sat view"),
+    N_("Event list view"),
+    N_("Second sat view"),
+    N_("Two sat view"),
+    N_("Autotracking"),
+    N_("Rig/rotator control")
+};
+
+
+static int compare_usec(const void *a, const void *b)
+{
+    gint64          x = *(const gint64 *)a;
+    gint64          y = *(const gint64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief Create a new, empty timing record.
+ * \return The new record, free it with cycle_timing_free().
+ */
+cycle_timing_t *cycle_timing_new(void)
+{
+    cycle_timing_t *timing = g_new0(cycle_timing_t, 1);
+
+    timing->last_log = g_get_monotonic_time();
+
+    return timing;
+}
+
+/** \brief Free a timing record. */
+void cycle_timing_free(cycle_timing_t * timing)
+{
+    g_free(timing);
+}
+
+/** \brief Remove all samples. */
+void cycle_timing_reset(cycle_timing_t * timing)
+{
+    memset(timing->hist, 0, sizeof(timing->hist));
+    timing->last_log = g_get_monotonic_time();
+}
+
+/**
+ * \brief Add a sample.
+ * \param timing The timing record.
+ * \param phase The phase.
+ * \param usec The duration of the phase [usec].
+ *
+ * The oldest sample is dropped when the ring buffer is full.
+ */
+void cycle_timing_add(cycle_timing_t * timing, cycle_phase_t phase,
+                      gint64 usec)
+{
+    cycle_hist_t   *hist = &timing->hist[phase];
+
+    hist->usec[hist->next] = usec;
+    hist->next = (hist->next + 1) % CYCLE_TIMING_SAMPLES;
+    if (hist->num < CYCLE_TIMING_SAMPLES)
+        hist->num++;
+}
+
+/**
+ * \brief Add the time since start as a sample.
+ * \param timing The timing record.
+ * \param phase The phase.
+ * \param start The start of the phase from g_get_monotonic_time().
+ */
+void cycle_timing_end(cycle_timing_t * timing, cycle_phase_t phase,
+                      gint64 start)
+{
+    cycle_timing_add(timing, phase, g_get_monotonic_time() - start);
+}
+
+/**
+ * \brief Summarize the samples of a phase.
+ * \param timing The timing record.
+ * \param phase The phase.
+ * \param sum The summary; all zero if there are no samples.
+ */
+void cycle_timing_get(const cycle_timing_t * timing, cycle_phase_t phase,
+                      cycle_summary_t * sum)
+{
+    const cycle_hist_t *hist = &timing->hist[phase];
+    gint64          sorted[CYCLE_TIMING_SAMPLES];
+
+    memset(sum, 0, sizeof(cycle_summary_t));
+    if (hist->num == 0)
+        return;
+
+    /* the valid samples are at the start until the buffer has been filled */
+    memcpy(sorted, hist->usec, hist->num * sizeof(gint64));
+    qsort(sorted, hist->num, sizeof(gint64), compare_usec);
+
+    sum->num = hist->num;
+    sum->p50 = sorted[(hist->num - 1) / 2];
+    sum->p95 = sorted[(hist->num - 1) * 95 / 100];
+    sum->max = sorted[hist->num - 1];
+}
+
+/** \brief Get the translated name of a phase. */
+const gchar    *cycle_timing_phase_name(cycle_phase_t phase)
+{
+    return _(PHASE_NAME[phase]);
+}
+
+/**
+ * \brief Log a summary of all phases if it is due.
+ * \param timing The timing record.
+ * \param name The name of the module.
+ *
+ * Nothing is logged unless enabled with SAT_CFG_BOOL_LOG_TIMING and a
+ * minute has passed since the last summary. Phases without samples are
+ * skipped.
+ */
+void cycle_timing_log(cycle_timing_t * timing, const gchar * name)
+{
+    cycle_summary_t sum;
+    gint64          now = g_get_monotonic_time();
+    guint           i;
+
+    if (now - timing->last_log < CYCLE_TIMING_LOG_INTERVAL)
+        return;
+
+    timing->last_log = now;
+
+    if (!sat_cfg_get_bool(SAT_CFG_BOOL_LOG_TIMING))
+        return;
+
+    for (i = 0; i < CYCLE_PHASE_NUM; i++)
+    {
+        cycle_timing_get(timing, i, &sum);
+        if (sum.num == 0)
+            continue;
+
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %s: %s: p50 %.2f ms, p95 %.2f ms, max %.2f ms "
+                      "(%d samples)"),
+                    __func__, name, cycle_timing_phase_name(i),
+                    sum.p50 / 1000.0, sum.p95 / 1000.0, sum.max / 1000.0,
+                    sum.num);
+    }
+}
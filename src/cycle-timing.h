@@ -0,0 +1,92 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef CYCLE_TIMING_H
+#define CYCLE_TIMING_H 1
+
+#include <glib.h>
+
+
+/** \brief Number of samples kept per phase. */
+#define CYCLE_TIMING_SAMPLES 256
+
+/** \brief Phases of the module update cycle. */
+typedef enum {
+    CYCLE_PHASE_TIMEOUT = 0,    /*!< The whole timeout callback */
+    CYCLE_PHASE_QTH,            /*!< QTH and gpsd update */
+    CYCLE_PHASE_HEADER,         /*!< Header and time controller */
+    CYCLE_PHASE_EVENTS,         /*!< Scheduling of AOS/LOS updates */
+    CYCLE_PHASE_EVENT_SEARCH,   /*!< AOS/LOS search on the workers */
+    CYCLE_PHASE_SKG,            /*!< Sky at glance */
+    CYCLE_PHASE_PROPAGATE,      /*!< Propagation on the worker */
+    CYCLE_PHASE_UPDATE,         /*!< The whole view update */
+    CYCLE_PHASE_APPLY,          /*!< Copying the snapshot to the satellites */
+    CYCLE_PHASE_VIEW_LIST,      /*!< GtkSatList views */
+    CYCLE_PHASE_VIEW_MAP,       /*!< GtkSatMap views */
+    CYCLE_PHASE_VIEW_POLAR,     /*!< GtkPolarView views */
+    CYCLE_PHASE_VIEW_SINGLE,    /*!< GtkSingleSat views */
+    CYCLE_PHASE_VIEW_EVENT,     /*!< GtkEventList views */
+    CYCLE_PHASE_VIEW_SECOND,    /*!< GtkSecondSat views */
+    CYCLE_PHASE_VIEW_TWO,       /*!< GtkTwoSat views */
+    CYCLE_PHASE_AUTOTRACK,      /*!< Autotracking */
+    CYCLE_PHASE_CTRL,           /*!< Radio and rotator controllers */
+    CYCLE_PHASE_NUM             /*!< Number of phases */
+} cycle_phase_t;
+
+/** \brief The most recent durations of one phase. */
+typedef struct {
+    gint64          usec[CYCLE_TIMING_SAMPLES]; /*!< Ring buffer [usec] */
+    guint           next;       /*!< Where the next sample goes */
+    guint           num;        /*!< Number of valid samples */
+} cycle_hist_t;
+
+/** \brief Timing of the update cycle of one module. */
+typedef struct {
+    cycle_hist_t    hist[CYCLE_PHASE_NUM];      /*!< One per phase */
+    gint64          last_log;   /*!< Time of the last logged summary */
+} cycle_timing_t;
+
+/** \brief Summary of one phase, see cycle_timing_get(). */
+typedef struct {
+    guint           num;        /*!< Number of samples */
+    gint64          p50;        /*!< Median [usec] */
+    gint64          p95;        /*!< 95th percentile [usec] */
+    gint64          max;        /*!< Maximum [usec] */
+} cycle_summary_t;
+
+cycle_timing_t *cycle_timing_new(void);
+void            cycle_timing_free(cycle_timing_t * timing);
+void            cycle_timing_reset(cycle_timing_t * timing);
+void            cycle_timing_add(cycle_timing_t * timing, cycle_phase_t phase,
+                                 gint64 usec);
+void            cycle_timing_end(cycle_timing_t * timing, cycle_phase_t phase,
+                                 gint64 start);
+void            cycle_timing_get(const cycle_timing_t * timing,
+                                 cycle_phase_t phase, cycle_summary_t * sum);
+const gchar    *cycle_timing_phase_name(cycle_phase_t phase);
+void            cycle_timing_log(cycle_timing_t * timing, const gchar * name);
+
+#endif
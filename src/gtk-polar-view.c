@@ -42,11 +42,18 @@
 #define POLV_DEFAULT_MARGIN 25
 #define MARKER_SIZE_HALF 2
 
+/* Distance in pixels at which the mouse pointer still finds a satellite */
+#define HIT_TOLERANCE 4
+
 /* extra size for line outside 0 deg circle (inside margin) */
 #define POLV_LINE_EXTRA 5
 
-static void     update_sat(gpointer key, gpointer value, gpointer data);
+static void     update_sat(GtkPolarView * polv, sat_t * sat);
 static void     update_track(gpointer key, gpointer value, gpointer data);
+static void     update_hits(GtkPolarView * polv, sat_obj_t * obj, gint catnum,
+                            gfloat x, gfloat y);
+static gint     sat_at(GtkPolarView * polv, gdouble x, gdouble y);
+static gchar   *sat_tooltip(GtkPolarView * polv, sat_t * sat);
 
 static GtkVBoxClass *parent_class = NULL;
 
@@ -80,6 +87,9 @@ static void gtk_polar_view_destroy(GtkWidget * widget)
 {
     gtk_polar_view_store_showtracks(GTK_POLAR_VIEW(widget));
 
+    hit_grid_free(GTK_POLAR_VIEW(widget)->hits);
+    GTK_POLAR_VIEW(widget)->hits = NULL;
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -103,6 +113,7 @@ static void gtk_polar_view_init(GtkPolarView * polview,
     polview->sats = NULL;
     polview->qth = NULL;
     polview->obj = NULL;
+    polview->hits = NULL;
     polview->naos = 0.0;
     polview->ncat = 0;
     polview->size = 0;
@@ -189,25 +200,24 @@ static gboolean on_button_press(GooCanvasItem * item,
                                 GooCanvasItem * target,
                                 GdkEventButton * event, gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
+    gint            catnum = sat_at(polv, event->x, event->y);
     sat_t          *sat = NULL;
 
+    (void)item;
     (void)target;
 
+    /* clicked on the background */
+    if (catnum == 0)
+        return TRUE;
+
     switch (event->button)
     {
         /* double-left-click */
     case 1:
         if (event->type == GDK_2BUTTON_PRESS)
         {
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = catnum;
-
-            sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+            sat = sat_array_lookup(polv->sats, catnum);
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(data)));
@@ -217,15 +227,10 @@ static gboolean on_button_press(GooCanvasItem * item,
                 /* double-clicked on map */
             }
         }
-
-        g_free(catpoint);
         break;
         /* pop-up menu */
     case 3:
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = catnum;
-
-        sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+        sat = sat_array_lookup(polv->sats, catnum);
 
         if (sat != NULL)
         {
@@ -241,7 +246,6 @@ static gboolean on_button_press(GooCanvasItem * item,
                         ("%s:%d: Could not find satellite (%d) in hash table"),
                         __FILE__, __LINE__, catnum);
         }
-        g_free(catpoint);
         break;
     default:
         break;
@@ -288,16 +292,19 @@ static gboolean on_button_release(GooCanvasItem * item,
                                   GooCanvasItem * target,
                                   GdkEventButton * event, gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
+    gint            catnum = sat_at(polv, event->x, event->y);
     gint           *catpoint = NULL;
     sat_obj_t      *obj = NULL;
     guint32         color;
 
+    (void)item;
     (void)target;
 
+    /* clicked on the background */
+    if (catnum == 0)
+        return TRUE;
+
     catpoint = g_try_new0(gint, 1);
     *catpoint = catnum;
 
@@ -495,6 +502,10 @@ static gboolean on_motion_notify(GooCanvasItem * item,
  *
  * This function is called when a canvas item is created. Its purpose is to connect
  * the corresponding signals to the created items.
+ *
+ * Only the root item is connected. The satellite items do not receive events,
+ * so clicks on them end up at the root item and the satellite is found from
+ * the position of the click, see sat_at().
  */
 static void on_item_created(GooCanvas * canvas,
                             GooCanvasItem * item,
@@ -507,10 +518,6 @@ static void on_item_created(GooCanvas * canvas,
         /* root item / canvas */
         g_signal_connect(item, "motion_notify_event",
                          (GCallback) on_motion_notify, data);
-    }
-
-    else if (!g_object_get_data(G_OBJECT(item), "skip-signal-connection"))
-    {
         g_signal_connect(item, "button_press_event",
                          (GCallback) on_button_press, data);
         g_signal_connect(item, "button_release_event",
@@ -518,6 +525,41 @@ static void on_item_created(GooCanvas * canvas,
     }
 }
 
+/**
+ * Show the tooltip of the satellite under the mouse pointer.
+ *
+ * The tooltip is created when it is shown instead of being updated for
+ * every satellite on every cycle.
+ */
+static gboolean on_query_tooltip(GtkWidget * widget, gint x, gint y,
+                                 gboolean keyboard, GtkTooltip * tooltip,
+                                 gpointer data)
+{
+    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
+    sat_t          *sat = NULL;
+    gdouble         cx = x;
+    gdouble         cy = y;
+    gint            catnum;
+    gchar          *text;
+
+    if (keyboard)
+        return FALSE;
+
+    goo_canvas_convert_from_pixels(GOO_CANVAS(widget), &cx, &cy);
+    catnum = sat_at(polv, cx, cy);
+    if (catnum != 0)
+        sat = sat_array_lookup(polv->sats, catnum);
+
+    if (sat == NULL)
+        return FALSE;
+
+    text = sat_tooltip(polv, sat);
+    gtk_tooltip_set_markup(tooltip, text);
+    g_free(text);
+
+    return TRUE;
+}
+
 /**
  * Transform pole coordinates.
  *
@@ -757,10 +799,10 @@ static GooCanvasItemModel *create_canvas_model(GtkPolarView * polv)
  * Create a new GtkPolarView widget.
  *
  * @param cfgdata The configuration data of the parent module.
- * @param sats Pointer to the hash table containing the associated satellites.
+ * @param sats Pointer to the array containing the associated satellites.
  * @param qth Pointer to the ground station data.
  */
-GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
+GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, sat_array_t * sats,
                                    qth_t * qth)
 {
     GtkPolarView       *polv;
@@ -813,6 +855,7 @@ GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
     /* create the canvas */
     polv->canvas = goo_canvas_new();
     g_object_set(G_OBJECT(polv->canvas), "has-tooltip", TRUE, NULL);
+    polv->hits = hit_grid_new(HIT_GRID_CELL);
     gtk_widget_set_size_request(polv->canvas, POLV_DEFAULT_SIZE, POLV_DEFAULT_SIZE);
     goo_canvas_set_bounds(GOO_CANVAS(polv->canvas), 0, 0,
                           POLV_DEFAULT_SIZE, POLV_DEFAULT_SIZE);
@@ -822,6 +865,8 @@ GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
                      G_CALLBACK(size_allocate_cb), polv);
     g_signal_connect(polv->canvas, "item_created",
                      (GCallback) on_item_created, polv);
+    g_signal_connect(polv->canvas, "query-tooltip",
+                     G_CALLBACK(on_query_tooltip), polv);
     g_signal_connect_after(polv->canvas, "realize",
                            (GCallback) on_canvas_realized, polv);
     gtk_widget_show(polv->canvas);
@@ -844,6 +889,7 @@ static void update_polv_size(GtkPolarView * polv)
     GooCanvasPoints *prec;
     gfloat          x, y;
     GooCanvasAnchorType anch = GOO_CANVAS_ANCHOR_CENTER;
+    guint           i;
 
 
     if (gtk_widget_get_realized(GTK_WIDGET(polv)))
@@ -859,6 +905,7 @@ static void update_polv_size(GtkPolarView * polv)
         /* update canvas bounds to match new size */
         goo_canvas_set_bounds(GOO_CANVAS(GTK_POLAR_VIEW(polv)->canvas), 0, 0,
                               allocation.width, allocation.height);
+        hit_grid_resize(polv->hits, allocation.width, allocation.height);
 
         /* background item */
         g_object_set(polv->bgd, "width", (gdouble) allocation.width,
@@ -939,7 +986,8 @@ static void update_polv_size(GtkPolarView * polv)
                      "x", (gfloat) polv->cx + polv->r + 2 * POLV_LINE_EXTRA,
                      "y", (gfloat) polv->cy + polv->r + POLV_LINE_EXTRA, NULL);
 
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        for (i = 0; i < polv->sats->num; i++)
+            update_sat(polv, &polv->sats->sats[i]);
 
         /* sky tracks */
         g_hash_table_foreach(polv->obj, update_track, polv);
@@ -953,7 +1001,7 @@ void gtk_polar_view_update(GtkWidget * widget)
     gchar          *buff;
     guint           h, m, s;
     sat_t          *sat = NULL;
-    gint           *catnr;
+    guint           i;
 
     if (polv->resize)
     {
@@ -975,7 +1023,8 @@ void gtk_polar_view_update(GtkWidget * widget)
         polv->ncat = 0;
 
         /* update sats */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        for (i = 0; i < polv->sats->num; i++)
+            update_sat(polv, &polv->sats->sats[i]);
 
         /* update countdown to NEXT AOS label */
         if (polv->eventinfo)
@@ -983,10 +1032,7 @@ void gtk_polar_view_update(GtkWidget * widget)
 
             if (polv->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = polv->ncat;
-                sat = SAT(g_hash_table_lookup(polv->sats, catnr));
-                g_free(catnr);
+                sat = sat_array_lookup(polv->sats, polv->ncat);
 
                 /* last desperate sanity check */
                 if (sat != NULL)
@@ -1072,11 +1118,10 @@ static gchar   *los_time_to_str(GtkPolarView * polv, sat_t * sat)
     return text;
 }
 
-static void update_sat(gpointer key, gpointer value, gpointer data)
+static void update_sat(GtkPolarView * polv, sat_t * sat)
 {
-    gint           *catnum;
-    sat_t          *sat = SAT(value);
-    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
+    gint            catnum = sat->tle.catnr;
+    gint           *key;
     sat_obj_t      *obj = NULL;
     gfloat          x, y;
     GooCanvasItemModel *root;
@@ -1084,13 +1129,9 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     gdouble         now;        // = get_current_daynum ();
     gchar          *text;
     gchar          *losstr;
-    gchar          *tooltip;
     guint32         colour;
-
-    (void)key;                  /* avoid unused parameter compiler warning */
-
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
+    PangoLayout    *layout;
+    PangoFontDescription *font;
 
     now = polv->tstamp;
 
@@ -1108,7 +1149,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     if ((sat->el < 0.00) || decayed(sat))
     {
 
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
+        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
 
         /* if sat is on canvas */
         if (obj != NULL)
@@ -1128,6 +1169,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                 goo_canvas_item_model_remove_child(root, idx);
             }
 
+            hit_grid_remove(polv->hits, catnum);
+
             /* remove sky track */
             if (obj->showtrack)
             {
@@ -1149,18 +1192,16 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             g_free(obj);
 
             /* remove sat object from hash table */
-            g_hash_table_remove(polv->obj, catnum);
+            g_hash_table_remove(polv->obj, &catnum);
 
             /* FIXME: remove track from chart */
         }
-
-        g_free(catnum);
     }
 
     /* sat is within range */
     else
     {
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
+        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
         azel_to_xy(polv, sat->az, sat->el, &x, &y);
 
         /* if sat is already on canvas */
@@ -1180,21 +1221,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             /* update label */
             g_object_set(obj->label, "text", sat->nickname, NULL);
 
-            /* update tooltip */
-            tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                              "Az: %5.1f\302\260\n"
-                                              "El: %5.1f\302\260\n"
-                                              "%s",
-                                              sat->nickname,
-                                              sat->az, sat->el, losstr);
-
+            /* the tooltip is created when it is shown, see on_query_tooltip() */
             g_object_set(obj->marker,
                          "x", x - MARKER_SIZE_HALF,
-                         "y", y - MARKER_SIZE_HALF, "tooltip", tooltip, NULL);
-            g_object_set(obj->label,
-                         "x", x, "y", y + 2, "tooltip", tooltip, NULL);
+                         "y", y - MARKER_SIZE_HALF, NULL);
+            g_object_set(obj->label, "x", x, "y", y + 2, NULL);
 
-            g_free(tooltip);
+            update_hits(polv, obj, catnum, x, y);
 
             /* update selection info if satellite is
                selected
@@ -1222,7 +1255,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                                 _
                                 ("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
-                                __FILE__, __func__, *catnum, qth_upd,
+                                __FILE__, __func__, catnum, qth_upd,
                                 time_upd);
 
                     root =
@@ -1261,7 +1294,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                 }
             }
             g_free(losstr);
-            g_free(catnum);     // FIXME: why free here, what about else?
         }
         else
         {
@@ -1274,12 +1306,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                 obj->selected = FALSE;
 
                 if (g_hash_table_lookup_extended
-                    (polv->showtracks_on, catnum, NULL, NULL))
+                    (polv->showtracks_on, &catnum, NULL, NULL))
                 {
                     obj->showtrack = TRUE;
                 }
                 else if (g_hash_table_lookup_extended
-                         (polv->showtracks_off, catnum, NULL, NULL))
+                         (polv->showtracks_off, &catnum, NULL, NULL))
                 {
                     obj->showtrack = FALSE;
                 }
@@ -1297,13 +1329,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                                          MOD_CFG_POLAR_SAT_COL,
                                          SAT_CFG_INT_POLAR_SAT_COL);
 
-                /* create tooltip */
-                tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                                  "Az: %5.1f\302\260\n"
-                                                  "El: %5.1f\302\260\n",
-                                                  sat->nickname,
-                                                  sat->az, sat->el);
-
+                /* the items do not react to the mouse pointer, see
+                   on_item_created() */
                 obj->marker = goo_canvas_rect_model_new(root,
                                                         x - MARKER_SIZE_HALF,
                                                         y - MARKER_SIZE_HALF,
@@ -1312,23 +1339,25 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                                                         "fill-color-rgba",
                                                         colour,
                                                         "stroke-color-rgba",
-                                                        colour, "tooltip",
-                                                        tooltip, NULL);
+                                                        colour,
+                                                        "pointer-events",
+                                                        GOO_CANVAS_EVENTS_NONE,
+                                                        NULL);
                 obj->label =
                     goo_canvas_text_model_new(root, sat->nickname, x, y + 2,
                                               -1, GOO_CANVAS_ANCHOR_NORTH,
                                               "font", "Sans 8",
                                               "fill-color-rgba", colour,
-                                              "tooltip", tooltip, NULL);
+                                              "pointer-events",
+                                              GOO_CANVAS_EVENTS_NONE, NULL);
 
-                g_free(tooltip);
                 if (goo_canvas_item_model_find_child(root, obj->marker) != -1)
                     goo_canvas_item_model_raise(obj->marker, NULL);
                 else
                     sat_log_log(SAT_LOG_LEVEL_ERROR,
                                 _
                                 ("%s: marker added to polarview not showing %d."),
-                                __func__, *catnum);
+                                __func__, catnum);
 
                 if (goo_canvas_item_model_find_child(root, obj->label) != -1)
                     goo_canvas_item_model_raise(obj->label, NULL);
@@ -1336,18 +1365,25 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                     sat_log_log(SAT_LOG_LEVEL_ERROR,
                                 _
                                 ("%s: label added to polarview not showing %d."),
-                                __func__, *catnum);
-
-                g_object_set_data(G_OBJECT(obj->marker), "catnum",
-                                  GINT_TO_POINTER(*catnum));
-                g_object_set_data(G_OBJECT(obj->label), "catnum",
-                                  GINT_TO_POINTER(*catnum));
+                                __func__, catnum);
+
+                /* measure the label for the hit grid */
+                layout = gtk_widget_create_pango_layout(polv->canvas,
+                                                        sat->nickname);
+                font = pango_font_description_from_string("Sans 8");
+                pango_layout_set_font_description(layout, font);
+                pango_layout_get_pixel_size(layout, &obj->lw, &obj->lh);
+                pango_font_description_free(font);
+                g_object_unref(layout);
+                update_hits(polv, obj, catnum, x, y);
 
                 /* get info about the current pass */
                 obj->pass = get_current_pass(sat, polv->qth, now);
 
                 /* add sat to hash table */
-                g_hash_table_insert(polv->obj, catnum, obj);
+                key = g_new(gint, 1);
+                *key = catnum;
+                g_hash_table_insert(polv->obj, key, obj);
 
                 /* Finally, create the sky track if necessary */
                 if (obj->showtrack)
@@ -1365,6 +1401,75 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     }
 }
 
+/**
+ * Update the position of a satellite in the hit grid.
+ *
+ * @param polv The polar view.
+ * @param obj The satellite object.
+ * @param catnum The catalogue number of the satellite.
+ * @param x The x coordinate of the satellite.
+ * @param y The y coordinate of the satellite.
+ *
+ * The box covers the marker and the label below it.
+ */
+static void update_hits(GtkPolarView * polv, sat_obj_t * obj, gint catnum,
+                        gfloat x, gfloat y)
+{
+    GooCanvasBounds box;
+
+    box.x1 = MIN(x - MARKER_SIZE_HALF, x - obj->lw / 2);
+    box.y1 = y - MARKER_SIZE_HALF;
+    box.x2 = MAX(x + MARKER_SIZE_HALF, x + obj->lw / 2);
+    box.y2 = y + 2 + obj->lh;
+
+    hit_grid_set(polv->hits, catnum, x, y, &box);
+}
+
+/**
+ * Find the satellite at a position on the canvas.
+ *
+ * @param polv The polar view.
+ * @param x The x coordinate in canvas units.
+ * @param y The y coordinate in canvas units.
+ * @return The catalogue number of the satellite or 0 if there is none.
+ *
+ * Markers and labels are checked first, then the satellite closest to the
+ * position within HIT_TOLERANCE pixels.
+ */
+static gint sat_at(GtkPolarView * polv, gdouble x, gdouble y)
+{
+    gint            catnum;
+
+    catnum = hit_grid_pick(polv->hits, x, y, NULL, NULL);
+
+    if (catnum == 0)
+        catnum = hit_grid_nearest(polv->hits, x, y, HIT_TOLERANCE);
+
+    return catnum;
+}
+
+/** Create the tooltip markup of a satellite. */
+static gchar   *sat_tooltip(GtkPolarView * polv, sat_t * sat)
+{
+    gchar          *losstr;
+    gchar          *tooltip;
+
+    if (sat->los > 0.0)
+        losstr = los_time_to_str(polv, sat);
+    else
+        losstr = g_strdup_printf(_("%s\nAlways in range"), sat->nickname);
+
+    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
+                                      "Az: %5.1f\302\260\n"
+                                      "El: %5.1f\302\260\n"
+                                      "%s",
+                                      sat->nickname,
+                                      sat->az, sat->el, losstr);
+    g_free(losstr);
+
+    return tooltip;
+}
+
 /**  Update sky track drawing after size allocate. */
 static void update_track(gpointer key, gpointer value, gpointer data)
 {
@@ -1389,7 +1494,7 @@ static void update_track(gpointer key, gpointer value, gpointer data)
         }
 
         /* create points */
-        num = g_slist_length(obj->pass->details);
+        num = obj->pass->num_details;
         if (num == 0)
         {
             sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1416,7 +1521,7 @@ static void update_track(gpointer key, gpointer value, gpointer data)
 
         for (i = 1; i < num - 1; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+            detail = &obj->pass->details[i];
             if (detail->el >= 0)
                 azel_to_xy(pv, detail->az, detail->el, &x, &y);
             points->coords[2 * i] = (double)x;
@@ -1531,7 +1636,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
     /* add sky track */
 
     /* create points */
-    num = g_slist_length(obj->pass->details);
+    num = obj->pass->num_details;
     if (num == 0)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1558,7 +1663,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+        detail = &obj->pass->details[i];
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         points->coords[2 * i] = (double)x;
@@ -1623,7 +1728,7 @@ void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj,
 }
 
 /** Reload reference to satellites (e.g. after TLE update). */
-void gtk_polar_view_reload_sats(GtkWidget * polv, GHashTable * sats)
+void gtk_polar_view_reload_sats(GtkWidget * polv, sat_array_t * sats)
 {
     GTK_POLAR_VIEW(polv)->sats = sats;
 
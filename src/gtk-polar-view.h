@@ -8,7 +8,9 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "hit-grid.h"
 #include "predict-tools.h"
+#include "sat-array.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -40,6 +42,8 @@ typedef struct {
     GooCanvasItemModel *label;  /*!< Item showing the satellite name. */
     GooCanvasItemModel *track;  /*!< Sky track. */
     GooCanvasItemModel *trtick[TRACK_TICK_NUM]; /*!< Time ticks along the sky track */
+    gint            lw;         /*!< Label width in pixels. */
+    gint            lh;         /*!< Label height in pixels. */
 } sat_obj_t;
 
 #define SAT_OBJ(obj) ((sat_obj_t *)obj)
@@ -87,10 +91,11 @@ struct _GtkPolarView {
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< module configuration data */
-    GHashTable     *sats;       /*!< Satellites. */
+    sat_array_t    *sats;       /*!< Satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
 
     GHashTable     *obj;        /*!< Canvas items representing each visible satellite */
+    hit_grid_t     *hits;       /*!< Satellites for finding the one under the mouse pointer. */
 
     guint           cx;         /*!< center X */
     guint           cy;         /*!< center Y */
@@ -118,11 +123,11 @@ struct _GtkPolarViewClass {
 GType           gtk_polar_view_get_type(void);
 
 GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata,
-                                   GHashTable * sats, qth_t * qth);
+                                   sat_array_t * sats, qth_t * qth);
 void            gtk_polar_view_update(GtkWidget * widget);
 void            gtk_polar_view_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_polar_view_reload_sats(GtkWidget * polv,
-                                           GHashTable * sats);
+                                           sat_array_t * sats);
 void            gtk_polar_view_select_sat(GtkWidget * widget, gint catnum);
 void            gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
                                             sat_t * sat);
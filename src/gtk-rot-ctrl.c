@@ -215,7 +215,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     pass_detail_t  *detail;
     gboolean        retval = FALSE;
 
-    num = g_slist_length(pass->details);
+    num = pass->num_details;
     if (type == ROT_AZ_TYPE_360)
     {
         min_az = 0;
@@ -249,7 +249,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     {
         for (i = 1; i < num - 1; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+            detail = &pass->details[i];
             caz = detail->az;
 
             while (caz > max_az)
@@ -734,7 +734,7 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
     gdouble         setaz = 0.0, setel = 45.0;
     gchar          *text;
     gboolean        error = FALSE;
-    sat_t           sat_working, *sat;
+    sat_work_t      work;
 
     /* parameters for path predictions */
     gdouble         time_delta;
@@ -868,7 +868,7 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
                      */
 
                     /* use a working copy so data does not get corrupted */
-                    sat = memcpy(&(sat_working), ctrl->target, sizeof(sat_t));
+                    predict_work_init(&work, ctrl->target);
 
                     /* compute az/el in the future that is past end of pass 
                        or exceeds tolerance
@@ -899,24 +899,25 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
                      */
                     while (step_size > (ctrl->delay / 1000.0 / 4.0 / (secday)))
                     {
-                        predict_calc(sat, ctrl->qth, ctrl->t + time_delta);
-                        /*update sat->az and sat->el to account for flips and az range */
+                        predict_calc_work(&work, ctrl->qth,
+                                          ctrl->t + time_delta);
+                        /*update az and el to account for flips and az range */
                         if ((ctrl->flipped) && (ctrl->conf->maxel >= 180.0))
                         {
-                            sat->el = 180.0 - sat->el;
-                            if (sat->az > 180.0)
-                                sat->az -= 180.0;
+                            work.data.el = 180.0 - work.data.el;
+                            if (work.data.az > 180.0)
+                                work.data.az -= 180.0;
                             else
-                                sat->az += 180.0;
+                                work.data.az += 180.0;
                         }
                         if ((ctrl->conf->aztype == ROT_AZ_TYPE_180) &&
-                            (sat->az > 180.0))
+                            (work.data.az > 180.0))
                         {
-                            sat->az = sat->az - 360.0;
+                            work.data.az = work.data.az - 360.0;
                         }
-                        if ((sat->el < 0.0) || (sat->el > 180.0) ||
-                            (fabs(setaz - sat->az) > (ctrl->threshold)) ||
-                            (fabs(setel - sat->el) > (ctrl->threshold)))
+                        if ((work.data.el < 0.0) || (work.data.el > 180.0) ||
+                            (fabs(setaz - work.data.az) > (ctrl->threshold)) ||
+                            (fabs(setel - work.data.el) > (ctrl->threshold)))
                         {
                             time_delta -= step_size;
                         }
@@ -926,8 +927,8 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
                         }
                         step_size /= 2.0;
                     }
-                    setel = SAFE_ELE(sat->el);
-                    setaz = SAFE_AZI(sat->az);
+                    setel = SAFE_ELE(work.data.el);
+                    setaz = SAFE_AZI(work.data.az);
                 }
             }
 
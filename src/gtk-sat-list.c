@@ -144,9 +144,8 @@ static void     gtk_sat_list_class_init(GtkSatListClass * class,
 static void     gtk_sat_list_init(GtkSatList * list,
 				  gpointer g_class);
 static void     gtk_sat_list_destroy(GtkWidget * widget);
-static GtkTreeModel *create_and_fill_model(GHashTable * sats);
-static void     sat_list_add_satellites(gpointer key, gpointer value,
-                                        gpointer user_data);
+static GtkTreeModel *create_and_fill_model(sat_array_t * sats);
+static void     sat_list_add_satellite(GtkListStore * store, sat_t * sat);
 static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
                                      GtkTreeIter * iter, gpointer data);
 
@@ -280,7 +279,7 @@ static void gtk_sat_list_destroy(GtkWidget * widget)
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
-GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
+GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, sat_array_t * sats,
                                  qth_t * qth, guint32 columns)
 {
 //    GtkWidget      *widget;
@@ -329,7 +328,7 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
 
     }
 
-    satlist->satellites = sats;
+    satlist->sats = sats;
     satlist->qth = qth;
 
     /* initialise column flags */
@@ -385,7 +384,7 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
     }
 
     /* create model and finalise treeview */
-    model = create_and_fill_model(satlist->satellites);
+    model = create_and_fill_model(satlist->sats);
     filter = gtk_tree_model_filter_new(model, NULL);
     sortable = gtk_tree_model_sort_new_with_model(filter);
     satlist->sortable = sortable;
@@ -430,9 +429,10 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
     return GTK_WIDGET(satlist);
 }
 
-static GtkTreeModel *create_and_fill_model(GHashTable * sats)
+static GtkTreeModel *create_and_fill_model(sat_array_t * sats)
 {
     GtkListStore   *liststore;
+    guint           i;
 
     liststore = gtk_list_store_new(SAT_LIST_COL_NUMBER, G_TYPE_STRING,  // name
                                    G_TYPE_INT,  // catnum
@@ -465,20 +465,16 @@ static GtkTreeModel *create_and_fill_model(GHashTable * sats)
         );
 
 
-    g_hash_table_foreach(sats, sat_list_add_satellites, liststore);
+    for (i = 0; i < sats->num; i++)
+        sat_list_add_satellite(liststore, &sats->sats[i]);
 
     return GTK_TREE_MODEL(liststore);
 }
 
 
-static void sat_list_add_satellites(gpointer key, gpointer value,
-                                    gpointer user_data)
+static void sat_list_add_satellite(GtkListStore * store, sat_t * sat)
 {
-    GtkListStore   *store = GTK_LIST_STORE(user_data);
     GtkTreeIter     item;
-    sat_t          *sat = SAT(value);
-
-    (void)key;
 
     gtk_list_store_append(store, &item);
     gtk_list_store_set(store, &item,
@@ -571,7 +567,7 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
                                      GtkTreeIter * iter, gpointer data)
 {
     GtkSatList     *satlist = GTK_SAT_LIST(data);
-    guint          *catnum;
+    gint            catnum;
     sat_t          *sat;
     gchar          *buff;
     gdouble         doppler;
@@ -583,23 +579,22 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
     (void)path;
 
     /* get the catalogue number for this row
-       then look it up in the hash table
+       then look it up in the satellite array
      */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(satlist->satellites, catnum));
+    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, &catnum, -1);
+    sat = sat_array_lookup(satlist->sats, catnum);
 
     if (sat == NULL)
     {
         /* satellite not tracked anymore => remove */
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Failed to get data for #%d."), __func__, *catnum);
+                    _("%s: Failed to get data for #%d."), __func__, catnum);
 
         gtk_list_store_remove(GTK_LIST_STORE(model), iter);
 
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Satellite #%d removed from list."), __func__,
-                    *catnum);
+                    catnum);
     }
     else
     {
@@ -800,8 +795,6 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
         }
     }
 
-    g_free(catnum);
-
     /* Return value not documented what to return, but it seems that
        FALSE continues to next row while TRUE breaks
      */
@@ -1292,31 +1285,27 @@ static void row_activated_cb(GtkTreeView * tree_view,
 {
     GtkTreeModel   *model;
     GtkTreeIter     iter;
-    guint          *catnum;
+    gint            catnum;
     sat_t          *sat;
 
     (void)column;
 
-    catnum = g_new0(guint, 1);
-
     model = gtk_tree_view_get_model(tree_view);
     gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
+    gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &catnum, -1);
 
-    sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+    sat = sat_array_lookup(GTK_SAT_LIST(list)->sats, catnum);
 
     if (sat == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
                     _("%s:%d Failed to get data for %d."), __FILE__, __LINE__,
-                    *catnum);
+                    catnum);
     }
     else
     {
         show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(list)));
     }
-
-    g_free(catnum);
 }
 
 static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
@@ -1325,24 +1314,22 @@ static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
     GtkTreeSelection *selection;
     GtkTreeModel   *model;
     GtkTreeIter     iter;
-    guint          *catnum;
+    gint            catnum;
     sat_t          *sat;
 
-    catnum = g_new0(guint, 1);
-
     /* get selected satellite */
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
     if (gtk_tree_selection_get_selected(selection, &model, &iter))
     {
-        gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
+        gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &catnum, -1);
 
-        sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+        sat = sat_array_lookup(GTK_SAT_LIST(list)->sats, catnum);
 
         if (sat == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_INFO,
                         _("%s:%d Failed to get data for %d."), __FILE__,
-                        __LINE__, *catnum);
+                        __LINE__, catnum);
 
         }
         else
@@ -1357,8 +1344,6 @@ static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
                     _("%s:%d: There is no selection; skip popup."), __FILE__,
                     __LINE__);
     }
-
-    g_free(catnum);
 }
 
 /*** FIXME: formalise with other copies, only need az,el and jul_utc */
@@ -1409,9 +1394,9 @@ static void Calculate_RADec(sat_t * sat, qth_t * qth, obs_astro_t * obs_set)
 }
 
 /** Reload reference to satellites (e.g. after TLE update). */
-void gtk_sat_list_reload_sats(GtkWidget * satlist, GHashTable * sats)
+void gtk_sat_list_reload_sats(GtkWidget * satlist, sat_array_t * sats)
 {
-    GTK_SAT_LIST(satlist)->satellites = sats;
+    GTK_SAT_LIST(satlist)->sats = sats;
 }
 
 /** Select a satellite */
@@ -1430,7 +1415,7 @@ void gtk_sat_list_select_sat(GtkWidget * satlist, gint catnum)
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(slist->treeview));
 
     /* iterate over the satellite list until a amtch is found */
-    n = g_hash_table_size(slist->satellites);
+    n = slist->sats->num;
     for (i = 0; i < n; i++)
     {
 
@@ -30,6 +30,7 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "sat-array.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -55,7 +56,7 @@ struct _gtk_sat_list {
     GtkWidget      *treeview;   /*!< the tree view itself */
     GtkWidget      *swin;       /*!< scrolled window */
 
-    GHashTable     *satellites; /*!< Satellites. */
+    sat_array_t    *sats;       /*!< Satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
 
     guint32         flags;      /*!< Flags indicating which columns are visible */
@@ -141,13 +142,13 @@ typedef enum {
 
 GType           gtk_sat_list_get_type(void);
 GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata,
-                                 GHashTable * sats,
+                                 sat_array_t * sats,
                                  qth_t * qth, guint32 columns);
 void            gtk_sat_list_update(GtkWidget * widget);
 void            gtk_sat_list_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 
 void            gtk_sat_list_reload_sats(GtkWidget * satlist,
-                                         GHashTable * sats);
+                                         sat_array_t * sats);
 void            gtk_sat_list_select_sat(GtkWidget * satlist, gint catnum);
 
 /* *INDENT-OFF* */
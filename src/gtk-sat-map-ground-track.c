@@ -38,6 +38,7 @@
 #include "config-keys.h"
 #include "gtk-sat-map.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 #include "mod-cfg-get-param.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
@@ -50,6 +51,11 @@ static void     create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                                  sat_map_obj_t * obj);
 static gboolean ssp_wrap_detected(GtkSatMap * satmap, gdouble x1, gdouble x2);
 static void     free_ssp(gpointer ssp, gpointer data);
+static void     track_reserve(ground_track_t * track, guint n);
+static void     track_drop(ground_track_t * track, long orbit);
+static void     track_request(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
+                              sat_map_obj_t * obj);
+static void     track_ready(GPtrArray * jobs, gpointer data);
 
 
 /**
@@ -64,109 +70,24 @@ static void     free_ssp(gpointer ssp, gpointer data);
  * ahead. Therefore, the resulting ground track may cross the map boundaries many
  * times, and using one single polyline for the whole ground track would look very
  * silly. To avoid this, the points will be split into several polylines.
+ *
+ * The ground track is calculated in the background and shown when it is
+ * ready, see ground_track_submit().
  */
 void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj)
 {
-    long            this_orbit; /* current orbit number */
-    long            max_orbit;  /* target orbit number, ie. this + num - 1 */
-    double          t0;         /* time when this_orbit starts */
-    double          t;
-    ssp_t          *this_ssp;
-
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Creating ground track for %s"),
                 __func__, sat->nickname);
 
-    /* just to be safe... if empty GSList is not NULL => segfault */
-    obj->track_data.latlon = NULL;
-
-    /* get configuration parameters */
-    this_orbit = sat->orbit;
-    max_orbit = sat->orbit - 1 + mod_cfg_get_int(satmap->cfgdata,
-                                                 MOD_CFG_MAP_SECTION,
-                                                 MOD_CFG_MAP_TRACK_NUM,
-                                                 SAT_CFG_INT_MAP_TRACK_NUM);
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: Start orbit: %d"), __func__, this_orbit);
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: End orbit %d"), __func__, max_orbit);
-
-    /* find the time when the current orbit started */
-
-    /* Iterate backwards in time until we reach sat->orbit < this_orbit.
-       Use predict_calc from predict-tools.c as SGP/SDP driver.
-       As a built-in safety, we stop iteration if the orbit crossing is
-       more than 24 hours back in time.
-     */
-    t0 = satmap->tstamp;        //get_current_daynum ();
-    /* use == instead of >= as it is more robust */
-    for (t = t0; (sat->orbit == this_orbit) && ((t + 1.0) > t0); t -= 0.0007)
-        predict_calc(sat, qth, t);
+    /* start from an empty ring buffer */
+    obj->track_data.first = 0;
+    obj->track_data.num = 0;
+    obj->track_orbit = 0;
 
-    /* set it so that we are in the same orbit as this_orbit
-       and not a different one */
-    t += 2 * 0.0007;
-    t0 = t;
-    predict_calc(sat, qth, t0);
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: T0: %f (%d)"), __func__, t0, sat->orbit);
-
-    /* calculate (lat,lon) for the required orbits */
-    while ((sat->orbit <= max_orbit) &&
-           (sat->orbit >= this_orbit) && (!decayed(sat)))
-    {
-        /* We use 30 sec time steps. If resolution is too fine, the
-           line drawing routine will filter out unnecessary points
-         */
-        t += 0.00035;
-        predict_calc(sat, qth, t);
-
-        /* store this SSP */
-
-        /* Note: g_slist_append() has to traverse the entire list to find the end, which
-           is inefficient when adding multiple elements. Therefore, we use g_slist_prepend()
-           and reverse the entire list when we are done.
-         */
-        this_ssp = g_try_new(ssp_t, 1);
-
-        if (this_ssp == NULL)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: MAYDAY: Insufficient memory for ground track!"),
-                        __func__);
-            return;
-        }
-
-        this_ssp->lat = sat->ssplat;
-        this_ssp->lon = sat->ssplon;
-        obj->track_data.latlon =
-            g_slist_prepend(obj->track_data.latlon, this_ssp);
-
-    }
-    /* log if there is a problem with the orbit calculation */
-    if (sat->orbit != (max_orbit + 1))
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Problem computing ground track for %s"),
-                    __func__, sat->nickname);
-        return;
-    }
-
-    /* Reset satellite structure to eliminate glitches in single sat 
-       view and other places when new ground track is laid out */
-    predict_calc(sat, qth, satmap->tstamp);
-
-    /* reverse GSList */
-    obj->track_data.latlon = g_slist_reverse(obj->track_data.latlon);
-
-    /* split points into polylines */
-    create_polylines(satmap, sat, qth, obj);
-
-    /* misc book-keeping */
-    obj->track_orbit = this_orbit;
+    track_request(satmap, sat, qth, obj);
+    ground_track_submit(satmap);
 }
 
 /**
@@ -179,15 +100,18 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
  * @param recalc Flag indicating whether ground track should be recalculated.
  *
  *    If (recalc=TRUE)
- *       call ground_track_delete (clear_ssp=TRUE)
- *       call ground_track_create
+ *       drop the orbits before the current one
+ *       request the missing orbits at the end
  *    Else
  *       call ground_track_delete (clear_ssp=FALSE)
  *       call create_polylines
  *
  *
  * The purpose with the recalc flag is to allow updates of ground track look without having
- * to recalculate the whole ground track (recalc=FALSE). 
+ * to recalculate the whole ground track (recalc=FALSE). When the satellite has passed into
+ * the next orbit only that orbit is calculated; the ground track is only calculated from
+ * scratch if the time has been moved back or more than the shown orbits ahead. The
+ * calculation is done in the background, the old ground track is shown until it is ready.
  */
 void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj, gboolean recalc)
@@ -204,8 +128,7 @@ void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
 
     if (recalc == TRUE)
     {
-        ground_track_delete(satmap, sat, qth, obj, TRUE);
-        ground_track_create(satmap, sat, qth, obj);
+        track_request(satmap, sat, qth, obj);
     }
     else
     {
@@ -214,6 +137,231 @@ void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     }
 }
 
+/**
+ * Start the calculation of the requested ground tracks.
+ *
+ * @param satmap The satellite map widget.
+ *
+ * The orbits requested by ground_track_update() and ground_track_create()
+ * are calculated on the prediction workers, see predict-jobs.c, and added
+ * to the ground tracks in the main loop when all of them are ready. Only
+ * one batch is calculated at a time; satellites that pass into a new
+ * orbit meanwhile are requested again on a later update.
+ */
+void ground_track_submit(GtkSatMap * satmap)
+{
+    if (satmap->tracks == NULL)
+        return;
+
+    satmap->tracks_busy = satmap->tracks;
+    satmap->tracks = NULL;
+    pred_batch_submit(satmap->tracks_busy);
+}
+
+/**
+ * Cancel the ground track calculations.
+ *
+ * @param satmap The satellite map widget.
+ *
+ * The requested orbits are not added to the ground tracks. The affected
+ * tracks are requested again on the next update.
+ */
+void ground_track_cancel(GtkSatMap * satmap)
+{
+    if (satmap->tracks != NULL)
+    {
+        pred_batch_cancel(satmap->tracks);
+        satmap->tracks = NULL;
+    }
+
+    if (satmap->tracks_busy != NULL)
+    {
+        pred_batch_cancel(satmap->tracks_busy);
+        satmap->tracks_busy = NULL;
+    }
+}
+
+/**
+ * Request the orbits that are missing from a ground track.
+ *
+ * @param satmap The satellite map widget.
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param obj the satellite object.
+ *
+ * The orbits before the current one are removed from the ring buffer and
+ * a job for the orbits up to the configured number is added to the
+ * ground track jobs of the map. The SSPs that are still valid are kept.
+ * Nothing is done while a batch is being calculated, since the ground
+ * track may still change.
+ */
+static void track_request(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
+                          sat_map_obj_t * obj)
+{
+    ground_track_t *track = &obj->track_data;
+    pred_job_t     *job;
+    long            this_orbit; /* current orbit number */
+    long            max_orbit;  /* target orbit number, ie. this + num - 1 */
+    long            orbit;
+
+    if (satmap->tracks_busy != NULL)
+        return;
+
+    /* get configuration parameters */
+    this_orbit = sat->orbit;
+    max_orbit = sat->orbit - 1 + mod_cfg_get_int(satmap->cfgdata,
+                                                 MOD_CFG_MAP_SECTION,
+                                                 MOD_CFG_MAP_TRACK_NUM,
+                                                 SAT_CFG_INT_MAP_TRACK_NUM);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Start orbit: %d"), __func__, this_orbit);
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: End orbit %d"), __func__, max_orbit);
+
+    track_drop(track, this_orbit);
+
+    /* start over if the time has been moved back or too far ahead */
+    if (track->num > 0 &&
+        (track->orbit[track->first] != this_orbit ||
+         track->orbit[(track->first + track->num - 1) % track->size] >
+         max_orbit))
+    {
+        track->first = 0;
+        track->num = 0;
+    }
+
+    if (track->num == 0)
+        orbit = this_orbit;
+    else
+        orbit = track->orbit[(track->first + track->num - 1) %
+                             track->size] + 1;
+
+    if (orbit <= max_orbit)
+    {
+        if (satmap->tracks == NULL)
+            satmap->tracks = pred_batch_new(qth, track_ready, satmap);
+
+        job = pred_batch_add(satmap->tracks, PRED_JOB_TRACK, sat, 0.0, 0.0,
+                             max_orbit - orbit + 1);
+        job->orbit = orbit;
+    }
+    else
+    {
+        /* fewer orbits than before; nothing to calculate */
+        ground_track_delete(satmap, sat, qth, obj, FALSE);
+        create_polylines(satmap, sat, qth, obj);
+    }
+
+    /* misc book-keeping */
+    obj->track_orbit = this_orbit;
+}
+
+/**
+ * Add the calculated orbits to the ground tracks.
+ *
+ * @param jobs The PRED_JOB_TRACK jobs submitted by ground_track_submit().
+ * @param data Pointer to the GtkSatMap widget.
+ *
+ * The orbits of a job must follow the last orbit in the ring buffer, or
+ * start with the current orbit if the ring buffer is empty. If they do
+ * not, e.g. because the ground track has been turned off and on again
+ * meanwhile, the ground track is requested again.
+ */
+static void track_ready(GPtrArray * jobs, gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    sat_map_obj_t  *obj;
+    ground_track_t *track;
+    pred_job_t     *job;
+    long            last;
+    guint           i, j, k;
+
+    satmap->tracks_busy = NULL;
+
+    for (i = 0; i < jobs->len; i++)
+    {
+        job = g_ptr_array_index(jobs, i);
+        obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj,
+                                              &job->sat->tle.catnr));
+        if (obj == NULL || !obj->showtrack)
+            continue;
+
+        track = &obj->track_data;
+        if (track->num > 0)
+            last = track->orbit[(track->first + track->num - 1) %
+                                track->size];
+        else
+            last = obj->track_orbit - 1;
+
+        if (last + 1 != job->orbit)
+        {
+            obj->track_orbit = 0;
+            continue;
+        }
+
+        track_reserve(track, job->track_len);
+        for (j = 0; j < job->track_len; j++)
+        {
+            k = (track->first + track->num) % track->size;
+            track->ssp[k].lat = job->track->lat[j];
+            track->ssp[k].lon = job->track->lon[j];
+            track->orbit[k] = job->track->orbit[j];
+            track->num++;
+        }
+
+        ground_track_delete(satmap, job->sat, satmap->qth, obj, FALSE);
+        create_polylines(satmap, job->sat, satmap->qth, obj);
+    }
+}
+
+/**
+ * Make room for more SSPs in the ring buffer.
+ *
+ * @param track The ground track.
+ * @param n The number of SSPs that will be added.
+ *
+ * The SSPs are moved to the start of the new buffer.
+ */
+static void track_reserve(ground_track_t * track, guint n)
+{
+    ssp_t          *ssp;
+    gint           *orbit;
+    guint           size;
+    guint           i, j;
+
+    if (track->num + n <= track->size)
+        return;
+
+    size = MAX(2 * track->size, track->num + n);
+    ssp = g_new(ssp_t, size);
+    orbit = g_new(gint, size);
+
+    for (i = 0; i < track->num; i++)
+    {
+        j = (track->first + i) % track->size;
+        ssp[i] = track->ssp[j];
+        orbit[i] = track->orbit[j];
+    }
+
+    g_free(track->ssp);
+    g_free(track->orbit);
+    track->ssp = ssp;
+    track->orbit = orbit;
+    track->size = size;
+    track->first = 0;
+}
+
+/** Remove the SSPs of the orbits before orbit from the ring buffer. */
+static void track_drop(ground_track_t * track, long orbit)
+{
+    while (track->num > 0 && track->orbit[track->first] < orbit)
+    {
+        track->first = (track->first + 1) % track->size;
+        track->num--;
+    }
+}
+
 /**
  * Delete the ground track for a satellite.
  *
@@ -272,27 +420,32 @@ void ground_track_delete(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     /* clear SSP too? */
     if (clear_ssp == TRUE)
     {
-        if (obj->track_data.latlon != NULL)
-        {
-            /* free allocated ssp_t */
-            g_slist_foreach(obj->track_data.latlon, free_ssp, NULL);
+        g_free(obj->track_data.ssp);
+        g_free(obj->track_data.orbit);
+        obj->track_data.ssp = NULL;
+        obj->track_data.orbit = NULL;
+        obj->track_data.size = 0;
+        obj->track_data.first = 0;
+        obj->track_data.num = 0;
 
-            /* free the SList itself */
-            g_slist_free(obj->track_data.latlon);
-            obj->track_data.latlon = NULL;
+        obj->track_orbit = 0;
 
+        /* the satellite layer draws the ground track from the SSPs */
+        if (satmap->layer != NULL)
+        {
+            sat_layer_set_track(satmap, obj);
+            sat_layer_flush(satmap);
         }
-
-        obj->track_orbit = 0;
     }
 }
 
 /**
  * Free an ssp_t structure.
  *
- * The ssp_t items in the obj->track_data.latlon GSList are dunamically allocated
- * hence they need to be freed when the cround track is deleted. This function
- * is intended to be called from a g_slist_foreach() iterator.
+ * The ssp_t items in the lists of map coordinates used by create_polylines()
+ * are dynamically allocated hence they need to be freed when a polyline has
+ * been created. This function is intended to be called from a g_slist_foreach()
+ * iterator.
  */
 static void free_ssp(gpointer ssp, gpointer data)
 {
@@ -317,12 +470,20 @@ static void create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     (void)sat;
     (void)qth;
 
+    /* the satellite layer draws the ground track from the SSPs */
+    if (satmap->layer != NULL)
+    {
+        sat_layer_set_track(satmap, obj);
+        sat_layer_flush(satmap);
+        return;
+    }
+
     /* initialise parameters */
     lastx = -50.0;
     lasty = -50.0;
     start = 0;
     num_points = 0;
-    n = g_slist_length(obj->track_data.latlon);
+    n = obj->track_data.num;
     col = mod_cfg_get_int(satmap->cfgdata,
                           MOD_CFG_MAP_SECTION,
                           MOD_CFG_MAP_TRACK_COL, SAT_CFG_INT_MAP_TRACK_COL);
@@ -330,7 +491,8 @@ static void create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     /* loop over each SSP */
     for (i = 0; i < n; i++)
     {
-        buff = (ssp_t *) g_slist_nth_data(obj->track_data.latlon, i);
+        buff = &obj->track_data.ssp[(obj->track_data.first + i) %
+                                    obj->track_data.size];
         ssp = g_try_new(ssp_t, 1);
         gtk_sat_map_lonlat_to_xy(satmap, buff->lon, buff->lat, &ssp->lon,
                                  &ssp->lat);
@@ -43,4 +43,7 @@ void            ground_track_delete(GtkSatMap * satmap, sat_t * sat,
                                     qth_t * qth, sat_map_obj_t * obj,
                                     gboolean clear_ssp);
 
+void            ground_track_submit(GtkSatMap * satmap);
+void            ground_track_cancel(GtkSatMap * satmap);
+
 #endif
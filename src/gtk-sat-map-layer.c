@@ -0,0 +1,612 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  Comments, questions and bugreports should be submitted via
+  http://sourceforge.net/projects/gpredict/
+  More details can be found at the project home page:
+
+  http://gpredict.oz9aec.net/
+ 
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Implementation of the satellite layer of the map.
+ *
+ * With many satellites the canvas items of the map (marker, label, shadows and
+ * range circle of each satellite) make every update expensive, since each of
+ * them is a GObject whose properties are set one by one. The satellite layer
+ * draws the satellites with Cairo after the canvas has drawn its own items.
+ * The drawing data is kept in one array, see sat_layer_t, and only the tiles
+ * of the canvas touched by satellites that have moved are redrawn.
+ *
+ * @note The satellite layer functions should only be called from gtk-sat-map.c,
+ *       gtk-sat-map-ground-track.c and gtk-sat-map-popup.c.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+#include "config-keys.h"
+#include "gtk-sat-map.h"
+#include "gtk-sat-map-layer.h"
+#include "mod-cfg-get-param.h"
+#include "sat-cfg.h"
+
+#define MARKER_SIZE_HALF    1
+
+/* Size of the tiles used for invalidating the canvas, in pixels */
+#define TILE_SIZE           64
+
+static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data);
+static void     draw_footprint(cairo_t * cr, sat_layer_t * layer,
+                               sat_map_obj_t * obj);
+static void     draw_track(cairo_t * cr, GtkSatMap * satmap,
+                           sat_map_obj_t * obj);
+static void     set_colour(cairo_t * cr, guint32 col);
+static void     damage(GtkSatMap * satmap, const GooCanvasBounds * bounds);
+static void     add_point(GooCanvasBounds * bounds, gdouble x, gdouble y);
+static gboolean overlap(const GooCanvasBounds * a, const GooCanvasBounds * b);
+static sat_layer_dot_t *lookup_dot(GtkSatMap * satmap, gint catnum);
+
+
+/**
+ * Create the satellite layer of a map.
+ *
+ * @param satmap The satellite map widget. The canvas must already exist.
+ *
+ * The layer is stored in satmap->layer. The satellites are added by
+ * sat_layer_set().
+ */
+void sat_layer_new(GtkSatMap * satmap)
+{
+    sat_layer_t    *layer = g_new0(sat_layer_t, 1);
+
+    layer->col = mod_cfg_get_int(satmap->cfgdata,
+                                 MOD_CFG_MAP_SECTION,
+                                 MOD_CFG_MAP_SAT_COL, SAT_CFG_INT_MAP_SAT_COL);
+    layer->selcol = mod_cfg_get_int(satmap->cfgdata,
+                                    MOD_CFG_MAP_SECTION,
+                                    MOD_CFG_MAP_SAT_SEL_COL,
+                                    SAT_CFG_INT_MAP_SAT_SEL_COL);
+    layer->covcol = mod_cfg_get_int(satmap->cfgdata,
+                                    MOD_CFG_MAP_SECTION,
+                                    MOD_CFG_MAP_SAT_COV_COL,
+                                    SAT_CFG_INT_MAP_SAT_COV_COL);
+    layer->trackcol = mod_cfg_get_int(satmap->cfgdata,
+                                      MOD_CFG_MAP_SECTION,
+                                      MOD_CFG_MAP_TRACK_COL,
+                                      SAT_CFG_INT_MAP_TRACK_COL);
+    layer->shadowcol = mod_cfg_get_int(satmap->cfgdata,
+                                       MOD_CFG_MAP_SECTION,
+                                       MOD_CFG_MAP_SHADOW_ALPHA,
+                                       SAT_CFG_INT_MAP_SHADOW_ALPHA);
+    layer->font = pango_font_description_from_string("Sans 8");
+
+    satmap->layer = layer;
+    sat_layer_reset(satmap);
+
+    g_signal_connect_after(satmap->canvas, "draw", G_CALLBACK(on_draw),
+                           satmap);
+}
+
+/** Free the satellite layer of a map. */
+void sat_layer_free(GtkSatMap * satmap)
+{
+    sat_layer_t    *layer = satmap->layer;
+
+    if (layer == NULL)
+        return;
+
+    g_signal_handlers_disconnect_by_func(satmap->canvas, on_draw, satmap);
+
+    pango_font_description_free(layer->font);
+    g_free(layer->dots);
+    g_free(layer->dirty);
+    g_free(layer);
+    satmap->layer = NULL;
+}
+
+/**
+ * Reset the satellite layer after the map or the satellites have changed.
+ *
+ * @param satmap The satellite map widget.
+ *
+ * The tiles are recreated for the current canvas size and the whole layer
+ * is redrawn on the next sat_layer_flush(). If the number of satellites has
+ * changed the layer is emptied; the satellites are added again by the next
+ * update of the map.
+ */
+void sat_layer_reset(GtkSatMap * satmap)
+{
+    sat_layer_t    *layer = satmap->layer;
+    gdouble         x2, y2;
+
+    if (layer->num != satmap->sats->num)
+    {
+        g_free(layer->dots);
+        layer->num = satmap->sats->num;
+        layer->dots = g_new0(sat_layer_dot_t, layer->num);
+    }
+
+    goo_canvas_get_bounds(GOO_CANVAS(satmap->canvas), NULL, NULL, &x2, &y2);
+    layer->cols = (guint) (x2 / TILE_SIZE) + 1;
+    layer->rows = (guint) (y2 / TILE_SIZE) + 1;
+
+    g_free(layer->dirty);
+    layer->dirty = g_new(guint8, layer->cols * layer->rows);
+    memset(layer->dirty, 1, layer->cols * layer->rows);
+    layer->damaged = TRUE;
+}
+
+/**
+ * Check whether a satellite needs to be redrawn.
+ *
+ * @param satmap The satellite map widget.
+ * @param sat The satellite.
+ * @param x The new x coordinate of the satellite.
+ * @param y The new y coordinate of the satellite.
+ * @return TRUE if the satellite is not in the layer or has moved at least
+ *         one pixel since it was last set.
+ */
+gboolean sat_layer_moved(GtkSatMap * satmap, sat_t * sat, gfloat x, gfloat y)
+{
+    sat_layer_dot_t *dot = lookup_dot(satmap, sat->tle.catnr);
+
+    if (dot == NULL || dot->obj == NULL)
+        return TRUE;
+
+    return (fabs(dot->x - x) >= 1.0) || (fabs(dot->y - y) >= 1.0);
+}
+
+/**
+ * Add or move a satellite.
+ *
+ * @param satmap The satellite map widget.
+ * @param sat The satellite.
+ * @param obj The satellite object with an up to date range circle and
+ *            label size.
+ * @param x The x coordinate of the satellite.
+ * @param y The y coordinate of the satellite.
+ *
+ * The area covered by the satellite before and after the move is marked
+ * for redraw.
+ */
+void sat_layer_set(GtkSatMap * satmap, sat_t * sat, sat_map_obj_t * obj,
+                   gfloat x, gfloat y)
+{
+    sat_layer_dot_t *dot = lookup_dot(satmap, sat->tle.catnr);
+    guint           i;
+
+    if (dot == NULL)
+        return;
+
+    if (dot->obj != NULL)
+        damage(satmap, &dot->bounds);
+
+    dot->obj = obj;
+    dot->x = x;
+    dot->y = y;
+
+    /* place the label like update_sat() does for the canvas items */
+    if (x < 50)
+    {
+        dot->lx = x + 3;
+        dot->ly = y - obj->lh / 2;
+    }
+    else if ((satmap->width - x) < 50)
+    {
+        dot->lx = x - 3 - obj->lw;
+        dot->ly = y - obj->lh / 2;
+    }
+    else if ((satmap->height - y) < 25)
+    {
+        dot->lx = x - obj->lw / 2;
+        dot->ly = y - 2 - obj->lh;
+    }
+    else
+    {
+        dot->lx = x - obj->lw / 2;
+        dot->ly = y + 2;
+    }
+
+    /* marker, label and range circle including shadows and line width */
+    dot->bounds.x1 = x - MARKER_SIZE_HALF - 1;
+    dot->bounds.y1 = y - MARKER_SIZE_HALF - 1;
+    dot->bounds.x2 = x + MARKER_SIZE_HALF + 2;
+    dot->bounds.y2 = y + MARKER_SIZE_HALF + 2;
+    add_point(&dot->bounds, dot->lx - 1, dot->ly - 1);
+    add_point(&dot->bounds, dot->lx + obj->lw + 2, dot->ly + obj->lh + 2);
+
+    for (i = 0; i < obj->rcnum1 + obj->rcnum2; i++)
+    {
+        add_point(&dot->bounds, obj->rccoords[2 * i] - 1,
+                  obj->rccoords[2 * i + 1] - 1);
+        add_point(&dot->bounds, obj->rccoords[2 * i] + 1,
+                  obj->rccoords[2 * i + 1] + 1);
+    }
+
+    damage(satmap, &dot->bounds);
+}
+
+/**
+ * Remove a satellite.
+ *
+ * @param satmap The satellite map widget.
+ * @param obj The satellite object.
+ */
+void sat_layer_remove(GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    sat_layer_dot_t *dot = lookup_dot(satmap, obj->catnum);
+
+    if (dot == NULL || dot->obj != obj)
+        return;
+
+    damage(satmap, &dot->bounds);
+    if (obj->showtrack)
+        damage(satmap, &dot->trackbounds);
+    dot->obj = NULL;
+}
+
+/**
+ * Update the area covered by the ground track of a satellite.
+ *
+ * @param satmap The satellite map widget.
+ * @param obj The satellite object with the new ground track SSPs.
+ *
+ * This is called whenever the SSPs of the ground track have changed or the
+ * map has been resized. The area covered by the old and the new ground
+ * track is marked for redraw, and on_draw() skips the ground tracks that
+ * are outside the area being drawn.
+ */
+void sat_layer_set_track(GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    sat_layer_dot_t *dot = lookup_dot(satmap, obj->catnum);
+    ground_track_t *track = &obj->track_data;
+    ssp_t          *ssp;
+    gdouble         x, y;
+    guint           i;
+
+    if (dot == NULL)
+        return;
+
+    damage(satmap, &dot->trackbounds);
+
+    /* empty, see damage() */
+    dot->trackbounds.x1 = 0.0;
+    dot->trackbounds.y1 = 0.0;
+    dot->trackbounds.x2 = -1.0;
+    dot->trackbounds.y2 = -1.0;
+
+    if (!obj->showtrack || track->num < 2)
+        return;
+
+    for (i = 0; i < track->num; i++)
+    {
+        ssp = &track->ssp[(track->first + i) % track->size];
+        gtk_sat_map_lonlat_to_xy(satmap, ssp->lon, ssp->lat, &x, &y);
+
+        if (i == 0)
+        {
+            dot->trackbounds.x1 = dot->trackbounds.x2 = x;
+            dot->trackbounds.y1 = dot->trackbounds.y2 = y;
+        }
+        else
+        {
+            add_point(&dot->trackbounds, x, y);
+        }
+    }
+
+    /* line width */
+    dot->trackbounds.x1 -= 1;
+    dot->trackbounds.y1 -= 1;
+    dot->trackbounds.x2 += 1;
+    dot->trackbounds.y2 += 1;
+
+    damage(satmap, &dot->trackbounds);
+}
+
+/**
+ * Mark a satellite for redraw.
+ *
+ * @param satmap The satellite map widget.
+ * @param obj The satellite object or NULL to redraw all satellites.
+ *
+ * This is used when the appearance of a satellite has changed, e.g. its
+ * selection or coverage area. Changed ground tracks are marked by
+ * sat_layer_set_track().
+ */
+void sat_layer_queue_draw(GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    sat_layer_t    *layer = satmap->layer;
+    sat_layer_dot_t *dot;
+
+    if (obj == NULL)
+    {
+        memset(layer->dirty, 1, layer->cols * layer->rows);
+        layer->damaged = TRUE;
+        return;
+    }
+
+    dot = lookup_dot(satmap, obj->catnum);
+    if (dot != NULL && dot->obj == obj)
+        damage(satmap, &dot->bounds);
+}
+
+/**
+ * Redraw the tiles marked since the last call.
+ *
+ * @param satmap The satellite map widget.
+ *
+ * Adjacent dirty tiles in a row are invalidated as one rectangle.
+ */
+void sat_layer_flush(GtkSatMap * satmap)
+{
+    sat_layer_t    *layer = satmap->layer;
+    GooCanvasBounds bounds;
+    guint           r, c, c0;
+
+    if (!layer->damaged)
+        return;
+
+    if (gtk_widget_get_realized(satmap->canvas))
+    {
+        for (r = 0; r < layer->rows; r++)
+        {
+            c = 0;
+            while (c < layer->cols)
+            {
+                if (!layer->dirty[r * layer->cols + c])
+                {
+                    c++;
+                    continue;
+                }
+
+                c0 = c;
+                while (c < layer->cols && layer->dirty[r * layer->cols + c])
+                    c++;
+
+                bounds.x1 = c0 * TILE_SIZE;
+                bounds.y1 = r * TILE_SIZE;
+                bounds.x2 = c * TILE_SIZE;
+                bounds.y2 = (r + 1) * TILE_SIZE;
+                goo_canvas_request_redraw(GOO_CANVAS(satmap->canvas), &bounds);
+            }
+        }
+    }
+
+    memset(layer->dirty, 0, layer->cols * layer->rows);
+    layer->damaged = FALSE;
+}
+
+/**
+ * Draw the satellite layer.
+ *
+ * This is connected after the draw handler of the canvas, so the satellites
+ * are drawn on top of the canvas items. The range circles are drawn first,
+ * then the ground tracks and finally the markers and labels.
+ */
+static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    GooCanvas      *canvas = GOO_CANVAS(widget);
+    sat_layer_t    *layer = satmap->layer;
+    sat_layer_dot_t *dot;
+    PangoLayout    *layout;
+    GooCanvasBounds clip;
+    gdouble         x1, y1, scale;
+    guint           i, n;
+
+    if (layer == NULL ||
+        !gtk_cairo_should_draw_window(cr, canvas->canvas_window))
+        return FALSE;
+
+    n = MIN(layer->num, satmap->sats->num);
+
+    cairo_save(cr);
+
+    /* use canvas coordinates like goo_canvas_draw() */
+    gtk_cairo_transform_to_window(cr, widget, canvas->canvas_window);
+    cairo_translate(cr, canvas->canvas_x_offset, canvas->canvas_y_offset);
+    scale = goo_canvas_get_scale(canvas);
+    cairo_scale(cr, scale, scale);
+    goo_canvas_get_bounds(canvas, &x1, &y1, NULL, NULL);
+    cairo_translate(cr, -x1, -y1);
+    cairo_clip_extents(cr, &clip.x1, &clip.y1, &clip.x2, &clip.y2);
+
+    cairo_set_line_width(cr, 1.0);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+
+    for (i = 0; i < n; i++)
+    {
+        dot = &layer->dots[i];
+        if (dot->obj != NULL && overlap(&dot->bounds, &clip))
+            draw_footprint(cr, layer, dot->obj);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        dot = &layer->dots[i];
+        if (dot->obj != NULL && dot->obj->showtrack &&
+            overlap(&dot->trackbounds, &clip))
+            draw_track(cr, satmap, dot->obj);
+    }
+
+    layout = gtk_widget_create_pango_layout(widget, NULL);
+    pango_layout_set_font_description(layout, layer->font);
+
+    for (i = 0; i < n; i++)
+    {
+        dot = &layer->dots[i];
+        if (dot->obj == NULL || !overlap(&dot->bounds, &clip))
+            continue;
+
+        pango_layout_set_text(layout, satmap->sats->sats[i].nickname, -1);
+
+        /* shadows first */
+        set_colour(cr, layer->shadowcol);
+        cairo_rectangle(cr, dot->x - MARKER_SIZE_HALF + 1,
+                        dot->y - MARKER_SIZE_HALF + 1,
+                        2 * MARKER_SIZE_HALF, 2 * MARKER_SIZE_HALF);
+        cairo_stroke(cr);
+        cairo_move_to(cr, dot->lx + 1, dot->ly + 1);
+        pango_cairo_show_layout(cr, layout);
+
+        set_colour(cr, dot->obj->selected ? layer->selcol : layer->col);
+        cairo_rectangle(cr, dot->x - MARKER_SIZE_HALF,
+                        dot->y - MARKER_SIZE_HALF,
+                        2 * MARKER_SIZE_HALF, 2 * MARKER_SIZE_HALF);
+        cairo_fill_preserve(cr);
+        cairo_stroke(cr);
+        cairo_move_to(cr, dot->lx, dot->ly);
+        pango_cairo_show_layout(cr, layout);
+    }
+
+    g_object_unref(layout);
+    cairo_restore(cr);
+
+    return FALSE;
+}
+
+/** Draw the range circle of a satellite, one or two parts. */
+static void draw_footprint(cairo_t * cr, sat_layer_t * layer,
+                           sat_map_obj_t * obj)
+{
+    const gdouble  *coords = obj->rccoords;
+    guint           part, num, i;
+
+    for (part = 0; part < 2; part++)
+    {
+        num = (part == 0) ? obj->rcnum1 : obj->rcnum2;
+
+        if (num > 1)
+        {
+            cairo_move_to(cr, coords[0], coords[1]);
+            for (i = 1; i < num; i++)
+                cairo_line_to(cr, coords[2 * i], coords[2 * i + 1]);
+
+            if (obj->showcov)
+            {
+                set_colour(cr, layer->covcol);
+                cairo_fill_preserve(cr);
+            }
+
+            set_colour(cr, obj->selected ? layer->selcol : layer->col);
+            cairo_stroke(cr);
+        }
+
+        coords += 2 * num;
+    }
+}
+
+/**
+ * Draw the ground track of a satellite.
+ *
+ * The track is split where it wraps around the map border and points closer
+ * than one pixel to the previous one are skipped, like the polylines created
+ * in gtk-sat-map-ground-track.c.
+ */
+static void draw_track(cairo_t * cr, GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    ground_track_t *track = &obj->track_data;
+    ssp_t          *ssp;
+    gdouble         x = 0.0, y = 0.0;
+    gdouble         lastx = 0.0, lasty = 0.0;
+    guint           i;
+
+    if (track->num < 2)
+        return;
+
+    for (i = 0; i < track->num; i++)
+    {
+        ssp = &track->ssp[(track->first + i) % track->size];
+        gtk_sat_map_lonlat_to_xy(satmap, ssp->lon, ssp->lat, &x, &y);
+
+        if (i == 0 || fabs(lastx - x) > satmap->width / 2.0)
+            cairo_move_to(cr, x, y);
+        else if ((fabs(lastx - x) > 1.0) || (fabs(lasty - y) > 1.0))
+            cairo_line_to(cr, x, y);
+        else
+            continue;
+
+        lastx = x;
+        lasty = y;
+    }
+
+    set_colour(cr, satmap->layer->trackcol);
+    cairo_stroke(cr);
+}
+
+/** Set the source colour from an RGBA value as used in the configuration. */
+static void set_colour(cairo_t * cr, guint32 col)
+{
+    cairo_set_source_rgba(cr,
+                          ((col >> 24) & 0xFF) / 255.0,
+                          ((col >> 16) & 0xFF) / 255.0,
+                          ((col >> 8) & 0xFF) / 255.0,
+                          (col & 0xFF) / 255.0);
+}
+
+/** Mark the tiles overlapping an area for redraw. */
+static void damage(GtkSatMap * satmap, const GooCanvasBounds * bounds)
+{
+    sat_layer_t    *layer = satmap->layer;
+    gint            c0, c1, r0, r1, r, c;
+
+    if (bounds->x2 < bounds->x1 || bounds->y2 < bounds->y1)
+        return;
+
+    c0 = CLAMP((gint) floor(bounds->x1 / TILE_SIZE), 0, (gint) layer->cols - 1);
+    c1 = CLAMP((gint) floor(bounds->x2 / TILE_SIZE), 0, (gint) layer->cols - 1);
+    r0 = CLAMP((gint) floor(bounds->y1 / TILE_SIZE), 0, (gint) layer->rows - 1);
+    r1 = CLAMP((gint) floor(bounds->y2 / TILE_SIZE), 0, (gint) layer->rows - 1);
+
+    for (r = r0; r <= r1; r++)
+        for (c = c0; c <= c1; c++)
+            layer->dirty[r * layer->cols + c] = 1;
+
+    layer->damaged = TRUE;
+}
+
+/** Extend bounds to include a point. */
+static void add_point(GooCanvasBounds * bounds, gdouble x, gdouble y)
+{
+    bounds->x1 = MIN(bounds->x1, x);
+    bounds->y1 = MIN(bounds->y1, y);
+    bounds->x2 = MAX(bounds->x2, x);
+    bounds->y2 = MAX(bounds->y2, y);
+}
+
+/** Check whether two bounds overlap. */
+static gboolean overlap(const GooCanvasBounds * a, const GooCanvasBounds * b)
+{
+    return a->x1 <= b->x2 && a->x2 >= b->x1 && a->y1 <= b->y2 &&
+        a->y2 >= b->y1;
+}
+
+/** Find the drawing data of a satellite. */
+static sat_layer_dot_t *lookup_dot(GtkSatMap * satmap, gint catnum)
+{
+    gint            idx = sat_array_index(satmap->sats, catnum);
+
+    if (idx < 0 || (guint) idx >= satmap->layer->num)
+        return NULL;
+
+    return &satmap->layer->dots[idx];
+}
@@ -37,6 +37,7 @@
 #include "gtk-sat-map.h"
 #include "gtk-sat-map-popup.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 #include "gtk-sat-popup-common.h"
 #include "mod-cfg-get-param.h"
 #include "orbit-tools.h"
@@ -205,6 +206,13 @@ static void coverage_toggled(GtkCheckMenuItem * item, gpointer data)
         covcol = 0x00000000;
     }
 
+    if (satmap->layer != NULL)
+    {
+        sat_layer_queue_draw(satmap, obj);
+        sat_layer_flush(satmap);
+        return;
+    }
+
     g_object_set(obj->range1, "fill-color-rgba", covcol, NULL);
 
     if (obj->newrcnum == 2)
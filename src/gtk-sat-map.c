@@ -34,6 +34,7 @@
 #include "gtk-sat-data.h"
 #include "gtk-sat-map-popup.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 #include "gtk-sat-map.h"
 #include "locator.h"
 #include "map-tools.h"
@@ -48,6 +49,9 @@
 
 #define MARKER_SIZE_HALF    1
 
+/* Distance in pixels at which the mouse pointer still finds a satellite */
+#define HIT_TOLERANCE       4
+
 /* Update terminator every 30 seconds */
 #define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
 
@@ -59,8 +63,10 @@ static void     gtk_sat_map_destroy(GtkWidget * widget);
 static void     size_allocate_cb(GtkWidget * widget,
                                  GtkAllocation * allocation, gpointer data);
 static void     update_map_size(GtkSatMap * satmap);
-static void     update_sat(gpointer key, gpointer value, gpointer data);
-static void     plot_sat(gpointer key, gpointer value, gpointer data);
+static void     update_sat(GtkSatMap * satmap, sat_t * sat);
+static void     update_track(GtkSatMap * satmap, sat_t * sat,
+                             sat_map_obj_t * obj);
+static void     plot_sat(GtkSatMap * satmap, sat_t * sat);
 static void     free_sat_obj(gpointer key, gpointer value, gpointer data);
 static void     lonlat_to_xy(GtkSatMap * m, gdouble lon, gdouble lat,
                              gfloat * x, gfloat * y);
@@ -71,6 +77,12 @@ static gboolean on_motion_notify(GooCanvasItem * item, GooCanvasItem * target,
 static void     on_item_created(GooCanvas * canvas, GooCanvasItem * item,
                                 GooCanvasItemModel * model, gpointer data);
 static void     on_canvas_realized(GtkWidget * canvas, gpointer data);
+static gboolean on_query_tooltip(GtkWidget * widget, gint x, gint y,
+                                 gboolean keyboard, GtkTooltip * tooltip,
+                                 gpointer data);
+static gint     sat_at(GtkSatMap * satmap, gdouble x, gdouble y,
+                       gboolean footprints);
+static gboolean in_footprint(gint catnum, gdouble x, gdouble y, gpointer data);
 static gboolean on_button_press(GooCanvasItem * item,
                                 GooCanvasItem * target,
                                 GdkEventButton * event, gpointer data);
@@ -81,17 +93,19 @@ static void     clear_selection(gpointer key, gpointer val, gpointer data);
 static void     load_map_file(GtkSatMap * satmap, float clon);
 static GooCanvasItemModel *create_canvas_model(GtkSatMap * satmap);
 static gdouble  arccos(gdouble, gdouble);
-static gboolean pole_is_covered(sat_t * sat);
 static gboolean north_pole_is_covered(sat_t * sat);
 static gboolean south_pole_is_covered(sat_t * sat);
 static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
                            gdouble mapbreak);
-static guint    calculate_footprint(GtkSatMap * satmap, sat_t * sat);
-static void     split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx);
+static guint    calculate_footprint(GtkSatMap * satmap, sat_t * sat,
+                                    sat_map_obj_t * obj);
+static void     split_points(GtkSatMap * satmap, sat_t * sat,
+                             sat_map_obj_t * obj, gdouble sspx);
 static void     sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                              GooCanvasPoints * points, gint num);
+                              gdouble * coords, gint num);
 static void     sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                              GooCanvasPoints * points, gint num);
+                              gdouble * coords, gint num);
+static GooCanvasPoints *range_points(sat_map_obj_t * obj, guint part);
 static gint     compare_coordinates_x(gconstpointer a, gconstpointer b,
                                       gpointer data);
 static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
@@ -102,6 +116,11 @@ static void     redraw_grid_lines(GtkSatMap * satmap);
 static void     draw_terminator(GtkSatMap * satmap, GooCanvasItemModel * root);
 static void     redraw_terminator(GtkSatMap * satmap);
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat);
+static gchar   *sat_tooltip(GtkSatMap * satmap, sat_t * sat);
+static void     measure_label(GtkSatMap * satmap, sat_t * sat,
+                              sat_map_obj_t * obj);
+static void     update_hits(GtkSatMap * satmap, sat_map_obj_t * obj,
+                            gfloat x, gfloat y);
 static void     gtk_sat_map_load_showtracks(GtkSatMap * map);
 static void     gtk_sat_map_store_showtracks(GtkSatMap * satmap);
 static void     gtk_sat_map_load_hide_coverages(GtkSatMap * map);
@@ -110,8 +129,9 @@ static void     reset_ground_track(gpointer key, gpointer value,
                                    gpointer user_data);
 
 static GtkVBoxClass *parent_class = NULL;
-static GooCanvasPoints *points1;
-static GooCanvasPoints *points2;
+
+/* cos(azimuth) for the left half of the range circle, 1 deg steps */
+static gdouble  rc_cosaz[SAT_MAP_RC_POINTS / 2];
 
 
 GType gtk_sat_map_get_type()
@@ -145,12 +165,16 @@ static void gtk_sat_map_class_init(GtkSatMapClass * class,
 				   gpointer class_data)
 {
     GtkWidgetClass *widget_class;
+    guint           azi;
 
     (void)class_data;
 
     widget_class = (GtkWidgetClass *) class;
     widget_class->destroy = gtk_sat_map_destroy;
     parent_class = g_type_class_peek_parent(class);
+
+    for (azi = 0; azi < SAT_MAP_RC_POINTS / 2; azi++)
+        rc_cosaz[azi] = cos(de2ra * (gdouble) azi);
 }
 
 static void gtk_sat_map_init(GtkSatMap * satmap,
@@ -161,8 +185,13 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
     satmap->sats = NULL;
     satmap->qth = NULL;
     satmap->obj = NULL;
+    satmap->layer = NULL;
+    satmap->hits = NULL;
+    satmap->covhits = NULL;
     satmap->showtracks = g_hash_table_new_full(g_int_hash, g_int_equal,
                                                NULL, NULL);
+    satmap->tracks = NULL;
+    satmap->tracks_busy = NULL;
     satmap->hidecovs = g_hash_table_new_full(g_int_hash, g_int_equal,
                                              NULL, NULL);
     satmap->naos = 0.0;
@@ -192,6 +221,9 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
 
     /* check widget isn't already destroyed */
     if (satmap->obj) {
+        /* the ground tracks being calculated are not needed anymore */
+        ground_track_cancel(satmap);
+
         /* save config */
         gtk_sat_map_store_showtracks(GTK_SAT_MAP(widget));
         gtk_sat_map_store_hidecovs(GTK_SAT_MAP(widget));
@@ -200,6 +232,11 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         g_hash_table_foreach(satmap->obj, free_sat_obj, satmap);
         g_hash_table_destroy(satmap->obj);
         satmap->obj = NULL;
+        sat_layer_free(satmap);
+        hit_grid_free(satmap->hits);
+        satmap->hits = NULL;
+        hit_grid_free(satmap->covhits);
+        satmap->covhits = NULL;
 
         /* these objects destruct themselves cleanly */
         g_object_unref(satmap->origmap);
@@ -280,12 +317,13 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
-GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
+GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, sat_array_t * sats,
                                 qth_t * qth)
 {
     GtkSatMap      *satmap;
     GooCanvasItemModel *root;
     guint32         col;
+    guint           i;
 
     satmap = g_object_new(GTK_TYPE_SAT_MAP, NULL);
 
@@ -373,9 +411,21 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     goo_canvas_set_root_item_model(GOO_CANVAS(satmap->canvas), root);
     g_object_unref(root);
 
+    /* draw the satellites in one layer instead of using canvas items */
+    if (mod_cfg_get_bool(cfgdata, MOD_CFG_MAP_SECTION,
+                         MOD_CFG_MAP_SAT_LAYER, SAT_CFG_BOOL_MAP_SAT_LAYER))
+        sat_layer_new(satmap);
+
+    /* the satellites under the mouse pointer are found in the hit grids */
+    satmap->hits = hit_grid_new(HIT_GRID_CELL);
+    satmap->covhits = hit_grid_new(HIT_GRID_CELL);
+    g_signal_connect(satmap->canvas, "query-tooltip",
+                     G_CALLBACK(on_query_tooltip), satmap);
+
     gtk_sat_map_load_showtracks(satmap);
     gtk_sat_map_load_hide_coverages(satmap);
-    g_hash_table_foreach(satmap->sats, plot_sat, satmap);
+    for (i = 0; i < satmap->sats->num; i++)
+        plot_sat(satmap, &satmap->sats->sats[i]);
 
     gtk_box_pack_start(GTK_BOX(satmap), satmap->canvas, TRUE, TRUE, 0);
 
@@ -515,6 +565,7 @@ static void update_map_size(GtkSatMap * satmap)
     gfloat          x, y;
     gfloat          ratio;      /* ratio between map width and height */
     gfloat          size;       /* size = min (alloc.w, ratio*alloc.h) */
+    guint           i;
 
     if (gtk_widget_get_realized(GTK_WIDGET(satmap)))
     {
@@ -560,6 +611,8 @@ static void update_map_size(GtkSatMap * satmap)
         /* set canvas bounds to match new size */
         goo_canvas_set_bounds(GOO_CANVAS(GTK_SAT_MAP(satmap)->canvas), 0, 0,
                               satmap->width, satmap->height);
+        hit_grid_resize(satmap->hits, allocation.width, allocation.height);
+        hit_grid_resize(satmap->covhits, allocation.width, allocation.height);
 
 
         /* redraw static elements */
@@ -596,7 +649,16 @@ static void update_map_size(GtkSatMap * satmap)
                      "x", (gdouble) satmap->x0 + satmap->width - 2,
                      "y", (gdouble) satmap->y0 + satmap->height - 1, NULL);
 
-        g_hash_table_foreach(satmap->sats, update_sat, satmap);
+        if (satmap->layer != NULL)
+            sat_layer_reset(satmap);
+
+        for (i = 0; i < satmap->sats->num; i++)
+            update_sat(satmap, &satmap->sats->sats[i]);
+        ground_track_submit(satmap);
+
+        if (satmap->layer != NULL)
+            sat_layer_flush(satmap);
+
         satmap->resize = FALSE;
     }
 }
@@ -620,8 +682,8 @@ void gtk_sat_map_update(GtkWidget * widget)
     sat_t          *sat = NULL;
     gdouble         number, now;
     gchar          *buff;
-    gint           *catnr;
     guint           h, m, s;
+    guint           i;
     gchar          *ch, *cm, *cs;
     gfloat          x, y;
     gdouble         oldx, oldy;
@@ -669,7 +731,16 @@ void gtk_sat_map_update(GtkWidget * widget)
                      "x", (gdouble) satmap->x0 + 2,
                      "y", (gdouble) satmap->y0 + 1, NULL);
 
-        g_hash_table_foreach(satmap->sats, update_sat, satmap);
+        for (i = 0; i < satmap->sats->num; i++)
+            update_sat(satmap, &satmap->sats->sats[i]);
+
+        /* redraw the parts of the satellite layer that have changed */
+        if (satmap->layer != NULL)
+            sat_layer_flush(satmap);
+
+        /* calculate the ground tracks of the satellites that have passed
+           into a new orbit */
+        ground_track_submit(satmap);
 
         /* Update the Solar Terminator if necessary */
         if (satmap->show_terminator &&
@@ -684,10 +755,7 @@ void gtk_sat_map_update(GtkWidget * widget)
         {
             if (satmap->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = satmap->ncat;
-                sat = SAT(g_hash_table_lookup(satmap->sats, catnr));
-                g_free(catnr);
+                sat = sat_array_lookup(satmap->sats, satmap->ncat);
 
                 /* last desperate sanity check */
                 if (sat != NULL)
@@ -827,16 +895,51 @@ static gboolean on_motion_notify(GooCanvasItem * item,
     return TRUE;
 }
 
+/**
+ * Show the tooltip of the satellite under the mouse pointer.
+ *
+ * The satellite items do not react to the mouse pointer, so the tooltip is
+ * created here when it is shown instead of being updated on every cycle.
+ */
+static gboolean on_query_tooltip(GtkWidget * widget, gint x, gint y,
+                                 gboolean keyboard, GtkTooltip * tooltip,
+                                 gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    sat_t          *sat = NULL;
+    gdouble         cx = x;
+    gdouble         cy = y;
+    gint            catnum;
+    gchar          *text;
+
+    if (keyboard)
+        return FALSE;
+
+    goo_canvas_convert_from_pixels(GOO_CANVAS(widget), &cx, &cy);
+    catnum = sat_at(satmap, cx, cy, FALSE);
+    if (catnum != 0)
+        sat = sat_array_lookup(satmap->sats, catnum);
+
+    if (sat == NULL)
+        return FALSE;
+
+    text = sat_tooltip(satmap, sat);
+    gtk_tooltip_set_markup(tooltip, text);
+    g_free(text);
+
+    return TRUE;
+}
+
 /*
  * Finish canvas item setup.
  *
  * This function is called when a canvas item is created. Its purpose is to connect
  * the corresponding signals to the created items.
  *
- * The root item, ie the background is connected to motion notify event, while other
- * items (sats) are connected to mouse click events.
- *
- * @bug Should filter out QTH or do we want to click on the QTH?
+ * The root item, ie the background is connected to motion notify and mouse
+ * click events. The satellite items do not receive events, so the clicks on
+ * them end up at the root item as well and the satellite is found from the
+ * position of the click, see sat_at().
  */
 static void on_item_created(GooCanvas * canvas,
                             GooCanvasItem * item,
@@ -848,9 +951,6 @@ static void on_item_created(GooCanvas * canvas,
         /* root item / canvas */
         g_signal_connect(item, "motion_notify_event",
                          (GCallback) on_motion_notify, data);
-    }
-    else if (!g_object_get_data(G_OBJECT(item), "skip-signal-connection"))
-    {
         g_signal_connect(item, "button_press_event",
                          (GCallback) on_button_press, data);
         g_signal_connect(item, "button_release_event",
@@ -858,17 +958,58 @@ static void on_item_created(GooCanvas * canvas,
     }
 }
 
+/**
+ * Find the satellite at a position on the canvas.
+ *
+ * @param satmap The satellite map.
+ * @param x The x coordinate in canvas units.
+ * @param y The y coordinate in canvas units.
+ * @param footprints Whether to include the range circles.
+ * @return The catalogue number of the satellite or 0 if there is none.
+ *
+ * Markers and labels are checked first, then the satellite closest to the
+ * position within HIT_TOLERANCE pixels and finally the range circles.
+ */
+static gint sat_at(GtkSatMap * satmap, gdouble x, gdouble y,
+                   gboolean footprints)
+{
+    gint            catnum;
+
+    catnum = hit_grid_pick(satmap->hits, x, y, NULL, NULL);
+
+    if (catnum == 0)
+        catnum = hit_grid_nearest(satmap->hits, x, y, HIT_TOLERANCE);
+
+    if (catnum == 0 && footprints)
+        catnum = hit_grid_pick(satmap->covhits, x, y, in_footprint, satmap);
+
+    return catnum;
+}
+
+/** Check whether a position is inside the range circle of a satellite. */
+static gboolean in_footprint(gint catnum, gdouble x, gdouble y, gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    sat_map_obj_t  *obj;
+
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
+    if (obj == NULL)
+        return FALSE;
+
+    return hit_grid_in_polygon(obj->rccoords, obj->rcnum1, x, y) ||
+        hit_grid_in_polygon(obj->rccoords + 2 * obj->rcnum1, obj->rcnum2,
+                            x, y);
+}
+
 static gboolean on_button_press(GooCanvasItem * item,
                                 GooCanvasItem * target, GdkEventButton * event,
                                 gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
+    gint            catnum = sat_at(satmap, event->x, event->y, TRUE);
     sat_t          *sat = NULL;
 
+    (void)item;
     (void)target;
 
     switch (event->button)
@@ -877,10 +1018,7 @@ static gboolean on_button_press(GooCanvasItem * item,
     case 1:
         if (event->type == GDK_2BUTTON_PRESS)
         {
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = catnum;
-
-            sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+            sat = sat_array_lookup(satmap->sats, catnum);
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(data)));
@@ -890,14 +1028,11 @@ static gboolean on_button_press(GooCanvasItem * item,
                 /* double-clicked on map */
             }
         }
-        g_free(catpoint);
         break;
 
         /* pop-up menu */
     case 3:
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = catnum;
-        sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+        sat = sat_array_lookup(satmap->sats, catnum);
         if (sat != NULL)
         {
             gtk_sat_map_popup_exec(sat, satmap->qth, satmap, event,
@@ -908,7 +1043,6 @@ static gboolean on_button_press(GooCanvasItem * item,
         {
             /* clicked on map -> map pop-up in the future */
         }
-        g_free(catpoint);
         break;
     default:
         break;
@@ -921,16 +1055,19 @@ static gboolean on_button_release(GooCanvasItem * item,
                                   GooCanvasItem * target,
                                   GdkEventButton * event, gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
+    gint            catnum = sat_at(satmap, event->x, event->y, TRUE);
     gint           *catpoint = NULL;
     sat_map_obj_t  *obj = NULL;
     guint32         col;
 
+    (void)item;
     (void)target;
 
+    /* clicked on the map */
+    if (catnum == 0)
+        return TRUE;
+
     catpoint = g_try_new0(gint, 1);
     *catpoint = catnum;
 
@@ -968,19 +1105,28 @@ static gboolean on_button_release(GooCanvasItem * item,
                 g_object_set(satmap->sel, "text", "", NULL);
             }
 
-            g_object_set(obj->marker,
-                         "fill-color-rgba", col,
-                         "stroke-color-rgba", col, NULL);
-            g_object_set(obj->label,
-                         "fill-color-rgba", col,
-                         "stroke-color-rgba", col, NULL);
-            g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
-
-            if (obj->oldrcnum == 2)
-                g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+            if (satmap->layer == NULL)
+            {
+                g_object_set(obj->marker,
+                             "fill-color-rgba", col,
+                             "stroke-color-rgba", col, NULL);
+                g_object_set(obj->label,
+                             "fill-color-rgba", col,
+                             "stroke-color-rgba", col, NULL);
+                g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
+
+                if (obj->oldrcnum == 2)
+                    g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+            }
 
             /* clear other selections */
             g_hash_table_foreach(satmap->obj, clear_selection, catpoint);
+
+            if (satmap->layer != NULL)
+            {
+                sat_layer_queue_draw(satmap, NULL);
+                sat_layer_flush(satmap);
+            }
         }
         break;
     default:
@@ -1003,6 +1149,10 @@ static void clear_selection(gpointer key, gpointer val, gpointer data)
     {
         obj->selected = FALSE;
 
+        /* the satellite layer is redrawn by the caller */
+        if (obj->marker == NULL)
+            return;
+
         /** FIXME: this is only global default; need the satmap here! */
         col = sat_cfg_get_int(SAT_CFG_INT_MAP_SAT_COL);
 
@@ -1043,17 +1193,28 @@ void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
                               MOD_CFG_MAP_SAT_SEL_COL,
                               SAT_CFG_INT_MAP_SAT_SEL_COL);
 
-        g_object_set(obj->marker,
-                     "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
-        g_object_set(obj->label,
-                     "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
-        g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
+        if (smap->layer == NULL)
+        {
+            g_object_set(obj->marker,
+                         "fill-color-rgba", col, "stroke-color-rgba", col,
+                         NULL);
+            g_object_set(obj->label,
+                         "fill-color-rgba", col, "stroke-color-rgba", col,
+                         NULL);
+            g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
 
-        if (obj->oldrcnum == 2)
-            g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+            if (obj->oldrcnum == 2)
+                g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+        }
 
         /* clear other selections */
         g_hash_table_foreach(smap->obj, clear_selection, catpoint);
+
+        if (smap->layer != NULL)
+        {
+            sat_layer_queue_draw(smap, NULL);
+            sat_layer_flush(smap);
+        }
     }
 
     g_free(catpoint);
@@ -1187,15 +1348,6 @@ static gdouble arccos(gdouble x, gdouble y)
     return 0.0;
 }
 
-/* Check whether the footprint covers the North or South pole. */
-static gboolean pole_is_covered(sat_t * sat)
-{
-    if (north_pole_is_covered(sat) || south_pole_is_covered(sat))
-        return TRUE;
-    else
-        return FALSE;
-}
-
 /* Check whether the footprint covers the North pole. */
 static gboolean north_pole_is_covered(sat_t * sat)
 {
@@ -1287,8 +1439,7 @@ static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
  *
  * @param satmap TheGtkSatMap widget.
  * @param sat The satellite.
- * @param points1 Initialised GooCanvasPoints structure with 360 points.
- * @param points2 Initialised GooCanvasPoints structure with 360 points.
+ * @param obj The satellite object holding the range circle buffer.
  * @return The number of range circle parts.
  *
  * This function calculates the "left" side of the range circle and mirrors
@@ -1312,16 +1463,26 @@ static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
  * 3. Else nothing needs to be done since the points are already suitable for
  *    a polyline.
  *
- * The function will re-initialise points1 and points2 according to its needs. The
- * total number of points will always be 360, even with the addition of the two
- * extra points. 
+ * The result is stored in obj->rccoords, obj->rcnum1 and obj->rcnum2. The
+ * total number of points will always be SAT_MAP_RC_POINTS, even with the
+ * addition of the two extra points.
+ *
+ * The sines of the range circle latitudes are evaluated for all azimuths in a
+ * first pass using the precomputed rc_cosaz table, which leaves only asin and
+ * acos per point for the second pass.
  */
-static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
+static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
+                                 sat_map_obj_t * obj)
 {
     guint           azi;
     gfloat          sx, sy, msx, msy, ssx, ssy;
-    gdouble         ssplat, ssplon, beta, azimuth, num, dem;
+    gdouble         ssplon, beta, num, dem;
+    gdouble         sinlat, coslat, sinbeta, cosbeta, a, b;
     gdouble         rangelon, rangelat, mlon;
+    gdouble         sinrlat[SAT_MAP_RC_POINTS / 2];
+    gdouble         cosrlat[SAT_MAP_RC_POINTS / 2];
+    gdouble        *coords = obj->rccoords;
+    gboolean        north, south;
     gboolean        warped = FALSE;
     guint           numrc = 1;
 
@@ -1330,29 +1491,36 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
      * who borrowed from John Magliacane, KD2BD.
      * Optimized by Alexandru Csete and William J Beksi.
      */
-    ssplat = sat->ssplat * de2ra;
+    sinlat = sin(sat->ssplat * de2ra);
+    coslat = cos(sat->ssplat * de2ra);
     ssplon = sat->ssplon * de2ra;
     beta = (0.5 * sat->footprint) / xkmper;
+    sinbeta = sin(beta);
+    cosbeta = cos(beta);
+    a = sinlat * cosbeta;
+    b = sinbeta * coslat;
 
-    for (azi = 0; azi < 180; azi++)
+    north = north_pole_is_covered(sat);
+    south = south_pole_is_covered(sat);
+
+    for (azi = 0; azi < SAT_MAP_RC_POINTS / 2; azi++)
     {
-        azimuth = de2ra * (double)azi;
-        rangelat = asin(sin(ssplat) * cos(beta) + cos(azimuth) *
-                        sin(beta) * cos(ssplat));
-        num = cos(beta) - (sin(ssplat) * sin(rangelat));
-        dem = cos(ssplat) * cos(rangelat);
+        sinrlat[azi] = CLAMP(a + b * rc_cosaz[azi], -1.0, 1.0);
+        cosrlat[azi] = sqrt(1.0 - sinrlat[azi] * sinrlat[azi]);
+    }
 
-        if (azi == 0 && north_pole_is_covered(sat))
+    for (azi = 0; azi < SAT_MAP_RC_POINTS / 2; azi++)
+    {
+        rangelat = asin(sinrlat[azi]);
+        num = cosbeta - (sinlat * sinrlat[azi]);
+        dem = coslat * cosrlat[azi];
+
+        if (azi == 0 && north)
             rangelon = ssplon + pi;
         else if (fabs(num / dem) > 1.0)
             rangelon = ssplon;
         else
-        {
-            if ((180.0 - azi) >= 0)
-                rangelon = ssplon - arccos(num, dem);
-            else
-                rangelon = ssplon + arccos(num, dem);
-        }
+            rangelon = ssplon - arccos(num, dem);
 
         while (rangelon < -pi)
             rangelon += twopi;
@@ -1370,23 +1538,26 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
         lonlat_to_xy(satmap, rangelon, rangelat, &sx, &sy);
         lonlat_to_xy(satmap, mlon, rangelat, &msx, &msy);
 
-        points1->coords[2 * azi] = sx;
-        points1->coords[2 * azi + 1] = sy;
+        coords[2 * azi] = sx;
+        coords[2 * azi + 1] = sy;
 
         /* Add mirrored point */
-        points1->coords[718 - 2 * azi] = msx;
-        points1->coords[719 - 2 * azi] = msy;
+        coords[2 * SAT_MAP_RC_POINTS - 2 - 2 * azi] = msx;
+        coords[2 * SAT_MAP_RC_POINTS - 1 - 2 * azi] = msy;
     }
 
-    /* points1 now contains 360 pairs of map-based XY coordinates.
+    obj->rcnum1 = SAT_MAP_RC_POINTS;
+    obj->rcnum2 = 0;
+
+    /* rccoords now contains 360 pairs of map-based XY coordinates.
        Check whether actions 1, 2 or 3 have to be performed.
      */
 
-    /* pole is covered => sort points1 and add additional points */
-    if (pole_is_covered(sat))
+    /* pole is covered => sort points and add additional points */
+    if (north || south)
     {
 
-        sort_points_x(satmap, sat, points1, 360);
+        sort_points_x(satmap, sat, coords, SAT_MAP_RC_POINTS);
         numrc = 1;
     }
 
@@ -1396,13 +1567,13 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
     {
 
         lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &ssx, &ssy);
-        split_points(satmap, sat, ssx);
+        split_points(satmap, sat, obj, ssx);
         numrc = 2;
 
     }
     else
     {
-        /* the nominal condition => points1 is adequate */
+        /* the nominal condition => rccoords is adequate */
         numrc = 1;
     }
 
@@ -1413,31 +1584,34 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
  * Split and sort polyline points.
  *
  * @param satmap The GtkSatMap structure.
- * @param points1 GooCanvasPoints containing the footprint points.
- * @param points2 A GooCanvasPoints structure containing the second set of points.
+ * @param sat The satellite data structure.
+ * @param obj The satellite object; obj->rccoords contains the footprint points
+ *            on input and the two parts of the range circle on output.
  * @param sspx Canvas based x-coordinate of SSP.
- * @bug We should ensure that the endpoints in points1 have x=x0, while in
- *      the endpoints in points2 should have x=x0+width (TBC).
+ * @bug We should ensure that the endpoints in the first part have x=x0, while
+ *      the endpoints in the second part should have x=x0+width (TBC).
  *
  * @note This function works on canvas-based coordinates rather than lat/lon
  * @note DO NOT USE this function when the footprint covers one of the poles
  *       (the end result may freeze the X-server requiring a hard-reset!)
  */
-static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
+static void split_points(GtkSatMap * satmap, sat_t * sat,
+                         sat_map_obj_t * obj, gdouble sspx)
 {
-    GooCanvasPoints *tps1, *tps2;
+    gdouble         tps1[2 * SAT_MAP_RC_POINTS];
+    gdouble         tps2[2 * SAT_MAP_RC_POINTS];
+    gdouble        *points1 = obj->rccoords;
+    gdouble        *points2;
     gint            n, n1, n2, ns, i, j, k;
 
     /* initialize parameters */
-    n = points1->num_points;
+    n = obj->rcnum1;
     n1 = 0;
     n2 = 0;
     i = 0;
     j = 0;
     k = 0;
     ns = 0;
-    tps1 = goo_canvas_points_new(n);
-    tps2 = goo_canvas_points_new(n);
 
     //if ((sspx >= (satmap->x0 + satmap->width - 0.6)) ||
     //    (sspx >= (satmap->x0 - 0.6))) {
@@ -1452,16 +1626,16 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
          */
         for (i = 0; i < n; i++)
         {
-            if (points1->coords[2 * i] > (satmap->x0 + satmap->width / 2))
+            if (points1[2 * i] > (satmap->x0 + satmap->width / 2))
             {
-                tps1->coords[2 * n1] = points1->coords[2 * i];
-                tps1->coords[2 * n1 + 1] = points1->coords[2 * i + 1];
+                tps1[2 * n1] = points1[2 * i];
+                tps1[2 * n1 + 1] = points1[2 * i + 1];
                 n1++;
             }
             else
             {
-                tps2->coords[2 * n2] = points1->coords[2 * i];
-                tps2->coords[2 * n2 + 1] = points1->coords[2 * i + 1];
+                tps2[2 * n2] = points1[2 * i];
+                tps2[2 * n2 + 1] = points1[2 * i + 1];
                 n2++;
             }
         }
@@ -1480,16 +1654,16 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
            Copy tps1 => points1 and tps2 => points2
          */
-        while (points1->coords[2 * i] <= sspx)
+        while (points1[2 * i] <= sspx)
         {
             i++;
         }
         ns = i - 1;
 
-        while (points1->coords[2 * i] > (satmap->x0 + satmap->width / 2))
+        while (points1[2 * i] > (satmap->x0 + satmap->width / 2))
         {
-            tps2->coords[2 * j] = points1->coords[2 * i];
-            tps2->coords[2 * j + 1] = points1->coords[2 * i + 1];
+            tps2[2 * j] = points1[2 * i];
+            tps2[2 * j + 1] = points1[2 * i + 1];
             i++;
             j++;
             n2++;
@@ -1497,8 +1671,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (i < n)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1[2 * i];
+            tps1[2 * k + 1] = points1[2 * i + 1];
             i++;
             k++;
             n1++;
@@ -1506,8 +1680,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         for (i = 0; i <= ns; i++)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1[2 * i];
+            tps1[2 * k + 1] = points1[2 * i + 1];
             k++;
             n1++;
         }
@@ -1523,16 +1697,16 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
          */
         i = n - 1;
-        while (points1->coords[2 * i] >= sspx)
+        while (points1[2 * i] >= sspx)
         {
             i--;
         }
         ns = i + 1;
 
-        while (points1->coords[2 * i] < (satmap->x0 + satmap->width / 2))
+        while (points1[2 * i] < (satmap->x0 + satmap->width / 2))
         {
-            tps2->coords[2 * j] = points1->coords[2 * i];
-            tps2->coords[2 * j + 1] = points1->coords[2 * i + 1];
+            tps2[2 * j] = points1[2 * i];
+            tps2[2 * j + 1] = points1[2 * i + 1];
             i--;
             j++;
             n2++;
@@ -1540,8 +1714,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (i >= 0)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1[2 * i];
+            tps1[2 * k + 1] = points1[2 * i + 1];
             i--;
             k++;
             n1++;
@@ -1549,8 +1723,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         for (i = n - 1; i >= ns; i--)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1[2 * i];
+            tps1[2 * k + 1] = points1[2 * i + 1];
             k++;
             n1++;
         }
@@ -1558,40 +1732,27 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
     //g_print ("NS:%d  N1:%d  N2:%d\n", ns, n1, n2);
 
-    /* free points and copy new contents */
-    goo_canvas_points_unref(points1);
-    goo_canvas_points_unref(points2);
-
-    points1 = goo_canvas_points_new(n1);
-    for (i = 0; i < n1; i++)
-    {
-        points1->coords[2 * i] = tps1->coords[2 * i];
-        points1->coords[2 * i + 1] = tps1->coords[2 * i + 1];
-    }
-    goo_canvas_points_unref(tps1);
-
-    points2 = goo_canvas_points_new(n2);
-    for (i = 0; i < n2; i++)
-    {
-        points2->coords[2 * i] = tps2->coords[2 * i];
-        points2->coords[2 * i + 1] = tps2->coords[2 * i + 1];
-    }
-    goo_canvas_points_unref(tps2);
+    /* copy new contents; the second part follows the first one */
+    memcpy(points1, tps1, 2 * n1 * sizeof(gdouble));
+    points2 = points1 + 2 * n1;
+    memcpy(points2, tps2, 2 * n2 * sizeof(gdouble));
+    obj->rcnum1 = n1;
+    obj->rcnum2 = n2;
 
     /* stretch end points to map borders */
-    if (points1->coords[0] > (satmap->x0 + satmap->width / 2))
+    if (points1[0] > (satmap->x0 + satmap->width / 2))
     {
-        points1->coords[0] = satmap->x0 + satmap->width;
-        points1->coords[2 * (n1 - 1)] = satmap->x0 + satmap->width;
-        points2->coords[0] = satmap->x0;
-        points2->coords[2 * (n2 - 1)] = satmap->x0;
+        points1[0] = satmap->x0 + satmap->width;
+        points1[2 * (n1 - 1)] = satmap->x0 + satmap->width;
+        points2[0] = satmap->x0;
+        points2[2 * (n2 - 1)] = satmap->x0;
     }
     else
     {
-        points2->coords[0] = satmap->x0 + satmap->width;
-        points2->coords[2 * (n2 - 1)] = satmap->x0 + satmap->width;
-        points1->coords[0] = satmap->x0;
-        points1->coords[2 * (n1 - 1)] = satmap->x0;
+        points2[0] = satmap->x0 + satmap->width;
+        points2[2 * (n2 - 1)] = satmap->x0 + satmap->width;
+        points1[0] = satmap->x0;
+        points1[2 * (n1 - 1)] = satmap->x0;
     }
 }
 
@@ -1600,7 +1761,7 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
  *
  * @param satmap The GtkSatMap structure.
  * @param sat The satellite data structure.
- * @param points The points to sort.
+ * @param coords The (x,y) pairs to sort.
  * @param num The number of points. By specifying it as parameter we can
  *            sort incomplete arrays.
  *
@@ -1622,41 +1783,41 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
  *
  */
 static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                          GooCanvasPoints * points, gint num)
+                          gdouble * coords, gint num)
 {
     gsize           size = 2 * sizeof(double);
 
     /* call g_qsort_with_data, which warps the qsort function
        from stdlib */
-    g_qsort_with_data(points->coords, num, size, compare_coordinates_x, NULL);
+    g_qsort_with_data(coords, num, size, compare_coordinates_x, NULL);
 
     /* move point at position 0 to position 1 */
-    points->coords[2] = satmap->x0;
-    points->coords[3] = points->coords[1];
+    coords[2] = satmap->x0;
+    coords[3] = coords[1];
 
     /* move point at position N to position N-1 */
-    points->coords[716] = satmap->x0 + satmap->width;   //points->coords[718];
-    points->coords[717] = points->coords[719];
+    coords[2 * num - 4] = satmap->x0 + satmap->width;
+    coords[2 * num - 3] = coords[2 * num - 1];
 
     if (sat->ssplat > 0.0)
     {
         /* insert (x0-1,y0) into position 0 */
-        points->coords[0] = satmap->x0;
-        points->coords[1] = satmap->y0;
+        coords[0] = satmap->x0;
+        coords[1] = satmap->y0;
 
         /* insert (x0+width,y0) into position N */
-        points->coords[718] = satmap->x0 + satmap->width;
-        points->coords[719] = satmap->y0;
+        coords[2 * num - 2] = satmap->x0 + satmap->width;
+        coords[2 * num - 1] = satmap->y0;
     }
     else
     {
         /* insert (x0,y0+height) into position 0 */
-        points->coords[0] = satmap->x0;
-        points->coords[1] = satmap->y0 + satmap->height;
+        coords[0] = satmap->x0;
+        coords[1] = satmap->y0 + satmap->height;
 
         /* insert (x0+width,y0+height) into position N */
-        points->coords[718] = satmap->x0 + satmap->width;
-        points->coords[719] = satmap->y0 + satmap->height;
+        coords[2 * num - 2] = satmap->x0 + satmap->width;
+        coords[2 * num - 1] = satmap->y0 + satmap->height;
     }
 }
 
@@ -1665,7 +1826,7 @@ static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
  *
  * @param satmap The GtkSatMap structure.
  * @param sat The satellite data structure.
- * @param points The points to sort.
+ * @param coords The (x,y) pairs to sort.
  * @param num The number of points. By specifying it as parameter we can
  *            sort incomplete arrays.
  *
@@ -1673,7 +1834,7 @@ static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
  * to their y value.
  */
 static void sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                          GooCanvasPoints * points, gint num)
+                          gdouble * coords, gint num)
 {
     gsize           size;
 
@@ -1683,7 +1844,27 @@ static void sort_points_y(GtkSatMap * satmap, sat_t * sat,
 
     /* call g_qsort_with_data, which warps the qsort function
        from stdlib */
-    g_qsort_with_data(points->coords, num, size, compare_coordinates_y, NULL);
+    g_qsort_with_data(coords, num, size, compare_coordinates_y, NULL);
+}
+
+/**
+ * Create canvas points for one part of a range circle.
+ *
+ * @param obj The satellite object.
+ * @param part The range circle part, 1 or 2.
+ * @return A new GooCanvasPoints structure that must be unreferenced by the caller.
+ */
+static GooCanvasPoints *range_points(sat_map_obj_t * obj, guint part)
+{
+    GooCanvasPoints *points;
+    guint           num = (part == 1) ? obj->rcnum1 : obj->rcnum2;
+
+    points = goo_canvas_points_new(num);
+    memcpy(points->coords,
+           obj->rccoords + ((part == 1) ? 0 : 2 * obj->rcnum1),
+           2 * num * sizeof(gdouble));
+
+    return points;
 }
 
 /**
@@ -1766,26 +1947,20 @@ static gint compare_coordinates_y(gconstpointer a, gconstpointer b,
 /**
  * Plot a satellite.
  *
- * @param key The hash table key.
- * @param value Pointer to the satellite.
- * @param data Pointer to the GtkSatMap widget.
+ * @param satmap Pointer to the GtkSatMap widget.
+ * @param sat Pointer to the satellite.
  *
  * This function creates and initializes the canvas objects (rectangle, label,
- * footprint) for a satellite. The function is called as a g_hash_table_foreach
- * callback.
+ * footprint) for a satellite.
  */
-static void plot_sat(gpointer key, gpointer value, gpointer data)
+static void plot_sat(GtkSatMap * satmap, sat_t * sat)
 {
-    GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
-    sat_t          *sat = SAT(value);
     GooCanvasItemModel *root;
     gint           *catnum;
     guint32         col, covcol, shadowcol;
     gfloat          x, y;
-    gchar          *tooltip;
-
-    (void)key;
+    GooCanvasPoints *points;
 
     if (decayed(sat))
     {
@@ -1832,9 +2007,30 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->newrcnum = 0;
     obj->range2 = NULL;
     obj->catnum = sat->tle.catnr;
-    obj->track_data.latlon = NULL;
+    obj->track_data.ssp = NULL;
+    obj->track_data.orbit = NULL;
+    obj->track_data.size = 0;
+    obj->track_data.first = 0;
+    obj->track_data.num = 0;
     obj->track_data.lines = NULL;
     obj->track_orbit = 0;
+    measure_label(satmap, sat, obj);
+
+    /* the satellite layer draws the satellite without canvas items */
+    if (satmap->layer != NULL)
+    {
+        obj->marker = NULL;
+        obj->shadowm = NULL;
+        obj->label = NULL;
+        obj->shadowl = NULL;
+        obj->range1 = NULL;
+        obj->newrcnum = calculate_footprint(satmap, sat, obj);
+        obj->oldrcnum = obj->newrcnum;
+        sat_layer_set(satmap, sat, obj, x, y);
+        update_hits(satmap, obj, x, y);
+        g_hash_table_insert(satmap->obj, catnum, obj);
+        return;
+    }
 
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
@@ -1868,17 +2064,8 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                 MOD_CFG_MAP_SHADOW_ALPHA,
                                 SAT_CFG_INT_MAP_SHADOW_ALPHA);
 
-    /* create tooltip */
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el);
-
-    /* create satellite marker and label + shadows. We create shadows first */
+    /* create satellite marker and label + shadows. We create shadows first.
+       The items do not react to the mouse pointer, see on_item_created() */
     obj->shadowm = goo_canvas_rect_model_new(root,
                                              x - MARKER_SIZE_HALF + 1,
                                              y - MARKER_SIZE_HALF + 1,
@@ -1886,7 +2073,8 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                              2 * MARKER_SIZE_HALF,
                                              "fill-color-rgba", 0x00,
                                              "stroke-color-rgba", shadowcol,
-                                             NULL);
+                                             "pointer-events",
+                                             GOO_CANVAS_EVENTS_NONE, NULL);
     obj->marker = goo_canvas_rect_model_new(root,
                                             x - MARKER_SIZE_HALF,
                                             y - MARKER_SIZE_HALF,
@@ -1894,7 +2082,8 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                             2 * MARKER_SIZE_HALF,
                                             "fill-color-rgba", col,
                                             "stroke-color-rgba", col,
-                                            "tooltip", tooltip, NULL);
+                                            "pointer-events",
+                                            GOO_CANVAS_EVENTS_NONE, NULL);
 
     obj->shadowl = goo_canvas_text_model_new(root, sat->nickname,
                                              x + 1,
@@ -1903,7 +2092,8 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                              GOO_CANVAS_ANCHOR_NORTH,
                                              "font", "Sans 8",
                                              "fill-color-rgba", shadowcol,
-                                             NULL);
+                                             "pointer-events",
+                                             GOO_CANVAS_EVENTS_NONE, NULL);
     obj->label = goo_canvas_text_model_new(root, sat->nickname,
                                            x,
                                            y + 2,
@@ -1911,22 +2101,13 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                            GOO_CANVAS_ANCHOR_NORTH,
                                            "font", "Sans 8",
                                            "fill-color-rgba", col,
-                                           "tooltip", tooltip, NULL);
-
-    g_free(tooltip);
-
-    g_object_set_data(G_OBJECT(obj->marker), "catnum",
-                      GINT_TO_POINTER(*catnum));
-    g_object_set_data(G_OBJECT(obj->label), "catnum",
-                      GINT_TO_POINTER(*catnum));
-
-    /* initialize points for footprint */
-    points1 = goo_canvas_points_new(360);
-    points2 = goo_canvas_points_new(360);
+                                           "pointer-events",
+                                           GOO_CANVAS_EVENTS_NONE, NULL);
 
     /* calculate footprint */
-    obj->newrcnum = calculate_footprint(satmap, sat);
+    obj->newrcnum = calculate_footprint(satmap, sat, obj);
     obj->oldrcnum = obj->newrcnum;
+    points = range_points(obj, 1);
 
     /* invisible footprint for decayed sats (STS fix) */
     /*     if (sat->otype == ORBIT_TYPE_DECAYED) { */
@@ -1935,24 +2116,24 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
 
     /* always create first part of range circle */
     obj->range1 = goo_canvas_polyline_model_new(root, FALSE, 0,
-                                                "points", points1,
+                                                "points", points,
                                                 "line-width", 1.0,
                                                 "fill-color-rgba", covcol,
                                                 "stroke-color-rgba", col,
                                                 "line-cap",
                                                 CAIRO_LINE_CAP_SQUARE,
                                                 "line-join",
-                                                CAIRO_LINE_JOIN_MITER, NULL);
-    g_object_set_data(G_OBJECT(obj->range1), "catnum",
-                      GINT_TO_POINTER(*catnum));
+                                                CAIRO_LINE_JOIN_MITER,
+                                                "pointer-events",
+                                                GOO_CANVAS_EVENTS_NONE, NULL);
+    goo_canvas_points_unref(points);
 
     /* create second part if available */
     if (obj->newrcnum == 2)
     {
-        //g_print ("N1:%d  N2:%d\n", points1->num_points, points2->num_points);
-
+        points = range_points(obj, 2);
         obj->range2 = goo_canvas_polyline_model_new(root, FALSE, 0,
-                                                    "points", points2,
+                                                    "points", points,
                                                     "line-width", 1.0,
                                                     "fill-color-rgba", covcol,
                                                     "stroke-color-rgba", col,
@@ -1960,14 +2141,13 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                                     CAIRO_LINE_CAP_SQUARE,
                                                     "line-join",
                                                     CAIRO_LINE_JOIN_MITER,
+                                                    "pointer-events",
+                                                    GOO_CANVAS_EVENTS_NONE,
                                                     NULL);
-        g_object_set_data(G_OBJECT(obj->range2), "catnum",
-                          GINT_TO_POINTER(*catnum));
-
+        goo_canvas_points_unref(points);
     }
 
-    goo_canvas_points_unref(points1);
-    goo_canvas_points_unref(points2);
+    update_hits(satmap, obj, x, y);
 
     /* add sat to hash table */
     g_hash_table_insert(satmap->obj, catnum, obj);
@@ -1995,6 +2175,20 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
 
     (void)key;
 
+    hit_grid_remove(satmap->hits, obj->catnum);
+    hit_grid_remove(satmap->covhits, obj->catnum);
+
+    if (satmap->layer != NULL)
+    {
+        sat_layer_remove(satmap, obj);
+        if (obj->showtrack)
+        {
+            sat = sat_array_lookup(satmap->sats, obj->catnum);
+            ground_track_delete(satmap, sat, satmap->qth, obj, TRUE);
+        }
+        return;
+    }
+
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
     idx = goo_canvas_item_model_find_child(root, obj->marker);
@@ -2029,34 +2223,28 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
 
     if (obj->showtrack)
     {
-        sat = SAT(g_hash_table_lookup(satmap->sats, &obj->catnum));
+        sat = sat_array_lookup(satmap->sats, obj->catnum);
         ground_track_delete(satmap, sat, satmap->qth, obj, TRUE);
     }
 }
 
 /** Update a given satellite. */
-static void update_sat(gpointer key, gpointer value, gpointer data)
+static void update_sat(GtkSatMap * satmap, sat_t * sat)
 {
-    gint           *catnum;
-    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    gint            catnum = sat->tle.catnr;
     sat_map_obj_t  *obj = NULL;
-    sat_t          *sat = SAT(value);
     gfloat          x, y;
     gdouble         oldx, oldy;
     gdouble         now;        // = get_current_daynum ();
     GooCanvasItemModel *root;
     gint            idx;
     guint32         col, covcol;
-    gchar          *tooltip;
-    gchar          *aosstr;
+    GooCanvasPoints *points;
 
     //gdouble sspla,ssplo;
 
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
-
     now = satmap->tstamp;
 
     /* update next AOS */
@@ -2069,13 +2257,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
 
     /* get rid of a decayed satellite */
     if (decayed(sat) && obj != NULL)
     {
         free_sat_obj(NULL, obj, satmap);
-        g_hash_table_remove(satmap->obj, catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         return;
     }
 
@@ -2089,7 +2277,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         {
             /* satellite was decayed now is visible
                time controller backed up time */
-            plot_sat(key, value, data);
+            plot_sat(satmap, sat);
             return;
         }
     }
@@ -2100,25 +2288,25 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         update_selected(satmap, sat);
     }
 
-    g_object_set(obj->label, "text", sat->nickname, NULL);
-    g_object_set(obj->shadowl, "text", sat->nickname, NULL);
+    lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
 
-    aosstr = aoslos_time_to_str(satmap, sat);
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260\n"
-                                      "%s",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el, aosstr);
-    g_object_set(obj->marker, "tooltip", tooltip, NULL);
-    g_object_set(obj->label, "tooltip", tooltip, NULL);
-    g_free(tooltip);
-    g_free(aosstr);
+    /* the tooltip is created when it is shown, see on_query_tooltip() */
+    if (satmap->layer != NULL)
+    {
+        if (sat_layer_moved(satmap, sat, x, y))
+        {
+            obj->newrcnum = calculate_footprint(satmap, sat, obj);
+            obj->oldrcnum = obj->newrcnum;
+            sat_layer_set(satmap, sat, obj, x, y);
+            update_hits(satmap, obj, x, y);
+        }
 
-    lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
+        update_track(satmap, sat, obj);
+        return;
+    }
+
+    g_object_set(obj->label, "text", sat->nickname, NULL);
+    g_object_set(obj->shadowl, "text", sat->nickname, NULL);
 
     /* update only if satellite has moved at least
        2 * MARKER_SIZE_HALF (no need to drain CPU all the time)
@@ -2178,18 +2366,17 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                          "anchor", GOO_CANVAS_ANCHOR_NORTH, NULL);
         }
 
-        /* initialize points for footprint */
-        points1 = goo_canvas_points_new(360);
-        points2 = goo_canvas_points_new(360);
-
         /* calculate footprint */
-        obj->newrcnum = calculate_footprint(satmap, sat);
+        obj->newrcnum = calculate_footprint(satmap, sat, obj);
 
         /* always update first part */
-        g_object_set(obj->range1, "points", points1, NULL);
+        points = range_points(obj, 1);
+        g_object_set(obj->range1, "points", points, NULL);
+        goo_canvas_points_unref(points);
 
         if (obj->newrcnum == 2)
         {
+            points = range_points(obj, 2);
             if (obj->oldrcnum == 1)
             {
                 /* we need to create the second part */
@@ -2220,7 +2407,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                     covcol = 0x00000000;
                 }
                 obj->range2 = goo_canvas_polyline_model_new(root, FALSE, 0,
-                                                            "points", points2,
+                                                            "points", points,
                                                             "line-width", 1.0,
                                                             "fill-color-rgba",
                                                             covcol,
@@ -2229,15 +2416,16 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                                                             CAIRO_LINE_CAP_SQUARE,
                                                             "line-join",
                                                             CAIRO_LINE_JOIN_MITER,
+                                                            "pointer-events",
+                                                            GOO_CANVAS_EVENTS_NONE,
                                                             NULL);
-                g_object_set_data(G_OBJECT(obj->range2), "catnum",
-                                  GINT_TO_POINTER(*catnum));
             }
             else
             {
                 /* just update the second part */
-                g_object_set(obj->range2, "points", points2, NULL);
+                g_object_set(obj->range2, "points", points, NULL);
             }
+            goo_canvas_points_unref(points);
         }
         else
         {
@@ -2255,10 +2443,15 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         /* update rc-number */
         obj->oldrcnum = obj->newrcnum;
 
-        goo_canvas_points_unref(points1);
-        goo_canvas_points_unref(points2);
+        update_hits(satmap, obj, x, y);
     }
 
+    update_track(satmap, sat, obj);
+}
+
+/** Update the ground track of a satellite if it is shown. */
+static void update_track(GtkSatMap * satmap, sat_t * sat, sat_map_obj_t * obj)
+{
     /* if ground track is visible check whether we have passed into a
        new orbit, in which case we need to recalculate the ground track
      */
@@ -2275,7 +2468,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    g_free(catnum);
 }
 
 /**
@@ -2740,14 +2932,19 @@ void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
     *y = (gdouble) fy;
 }
 
-void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
+void gtk_sat_map_reload_sats(GtkWidget * satmap, sat_array_t * sats)
 {
     GTK_SAT_MAP(satmap)->sats = sats;
     GTK_SAT_MAP(satmap)->naos = 0.0;
     GTK_SAT_MAP(satmap)->ncat = 0;
 
-    /* reset ground track orbit to force repaint */
+    /* the elements may have changed, so the ground tracks are
+       recalculated from scratch */
+    ground_track_cancel(GTK_SAT_MAP(satmap));
     g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, NULL);
+
+    if (GTK_SAT_MAP(satmap)->layer != NULL)
+        sat_layer_reset(GTK_SAT_MAP(satmap));
 }
 
 static void reset_ground_track(gpointer key, gpointer value,
@@ -2758,6 +2955,7 @@ static void reset_ground_track(gpointer key, gpointer value,
     (void) user_data;
 
     obj->track_orbit = 0;
+    obj->track_data.num = 0;
 }
 
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat)
@@ -2796,6 +2994,98 @@ static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat)
     return text;
 }
 
+/** Create the tooltip markup of a satellite. */
+static gchar   *sat_tooltip(GtkSatMap * satmap, sat_t * sat)
+{
+    gchar          *aosstr;
+    gchar          *tooltip;
+
+    aosstr = aoslos_time_to_str(satmap, sat);
+    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
+                                      "Lon: %5.1f\302\260\n"
+                                      "Lat: %5.1f\302\260\n"
+                                      " Az: %5.1f\302\260\n"
+                                      " El: %5.1f\302\260\n"
+                                      "%s",
+                                      sat->nickname,
+                                      sat->ssplon, sat->ssplat,
+                                      sat->az, sat->el, aosstr);
+    g_free(aosstr);
+
+    return tooltip;
+}
+
+/** Measure the label of a satellite, which has the font of the label items. */
+static void measure_label(GtkSatMap * satmap, sat_t * sat,
+                          sat_map_obj_t * obj)
+{
+    PangoFontDescription *font;
+    PangoLayout    *layout;
+
+    font = pango_font_description_from_string("Sans 8");
+    layout = gtk_widget_create_pango_layout(satmap->canvas, sat->nickname);
+    pango_layout_set_font_description(layout, font);
+    pango_layout_get_pixel_size(layout, &obj->lw, &obj->lh);
+    g_object_unref(layout);
+    pango_font_description_free(font);
+}
+
+/**
+ * Update the position of a satellite in the hit grids.
+ *
+ * @param satmap The satellite map.
+ * @param obj The satellite object with an up to date range circle.
+ * @param x The x coordinate of the satellite.
+ * @param y The y coordinate of the satellite.
+ *
+ * The label is placed like in update_sat().
+ */
+static void update_hits(GtkSatMap * satmap, sat_map_obj_t * obj,
+                        gfloat x, gfloat y)
+{
+    GooCanvasBounds box;
+    gdouble         lx, ly;
+    guint           i;
+
+    if (x < 50)
+    {
+        lx = x + 3;
+        ly = y - obj->lh / 2;
+    }
+    else if ((satmap->width - x) < 50)
+    {
+        lx = x - 3 - obj->lw;
+        ly = y - obj->lh / 2;
+    }
+    else if ((satmap->height - y) < 25)
+    {
+        lx = x - obj->lw / 2;
+        ly = y - 2 - obj->lh;
+    }
+    else
+    {
+        lx = x - obj->lw / 2;
+        ly = y + 2;
+    }
+
+    box.x1 = MIN(x - MARKER_SIZE_HALF, lx);
+    box.y1 = MIN(y - MARKER_SIZE_HALF, ly);
+    box.x2 = MAX(x + MARKER_SIZE_HALF, lx + obj->lw);
+    box.y2 = MAX(y + MARKER_SIZE_HALF, ly + obj->lh);
+    hit_grid_set(satmap->hits, obj->catnum, x, y, &box);
+
+    box.x1 = box.x2 = x;
+    box.y1 = box.y2 = y;
+    for (i = 0; i < obj->rcnum1 + obj->rcnum2; i++)
+    {
+        box.x1 = MIN(box.x1, obj->rccoords[2 * i]);
+        box.y1 = MIN(box.y1, obj->rccoords[2 * i + 1]);
+        box.x2 = MAX(box.x2, obj->rccoords[2 * i]);
+        box.y2 = MAX(box.y2, obj->rccoords[2 * i + 1]);
+    }
+    hit_grid_set(satmap->covhits, obj->catnum, x, y, &box);
+}
+
 /** Load the satellites that we should show tracks for */
 static void gtk_sat_map_load_showtracks(GtkSatMap * satmap)
 {
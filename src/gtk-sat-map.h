@@ -8,6 +8,9 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "hit-grid.h"
+#include "predict-jobs.h"
+#include "sat-array.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -31,12 +34,25 @@ typedef struct {
     double          lon;        /*!< Longitude in decimal degrees West. */
 } ssp_t;
 
-/** Data storage for ground tracks */
+/**
+ * Data storage for ground tracks.
+ *
+ * The SSPs are kept in a ring buffer in time order, starting with the
+ * oldest one at ssp[first]. Whole orbits are added at the end and removed
+ * at the start when the satellite moves into a new orbit.
+ */
 typedef struct {
-    GSList         *latlon;     /*!< List of ssp_t */
+    ssp_t          *ssp;        /*!< Ring buffer of SSPs */
+    gint           *orbit;      /*!< Orbit number of each SSP */
+    guint           size;       /*!< Allocated size of the ring buffer */
+    guint           first;      /*!< Index of the oldest SSP */
+    guint           num;        /*!< Number of SSPs in the ring buffer */
     GSList         *lines;      /*!< List of GooCanvasPolyLine */
 } ground_track_t;
 
+/** Number of points in the range circle polyline(s). */
+#define SAT_MAP_RC_POINTS 360
+
 /**
  * Satellite object.
  *
@@ -46,6 +62,10 @@ typedef struct {
  * whether it is split or not. The oldrcnum and newrcnum fields are used for
  * keeping track of whether the range circle has one or two parts.
  *
+ * The range circle points are kept in rccoords as (x,y) pairs. The first part
+ * has rcnum1 points and the second part, if any, follows it with rcnum2 points.
+ * Each object owns its buffer so that footprints of different satellites do not
+ * share any state.
  */
 typedef struct {
     /* flags */
@@ -65,7 +85,12 @@ typedef struct {
     /* book keeping */
     guint           oldrcnum;   /*!< Number of RC parts in prev. cycle. */
     guint           newrcnum;   /*!< Number of RC parts in this cycle. */
+    guint           rcnum1;     /*!< Number of points in first RC part. */
+    guint           rcnum2;     /*!< Number of points in second RC part. */
+    gdouble         rccoords[2 * SAT_MAP_RC_POINTS];    /*!< RC points. */
     gint            catnum;     /*!< Catalogue number of satellite. */
+    gint            lw;         /*!< Label width in pixels. */
+    gint            lh;         /*!< Label height in pixels. */
 
     ground_track_t  track_data; /*!< Ground track data. */
     long            track_orbit;        /*!< Orbit when the ground track has been updated. */
@@ -74,6 +99,41 @@ typedef struct {
 
 #define SAT_MAP_OBJ(obj) ((sat_map_obj_t *)obj)
 
+/** A satellite drawn by the satellite layer. */
+typedef struct {
+    gfloat          x;          /*!< X coordinate of the marker. */
+    gfloat          y;          /*!< Y coordinate of the marker. */
+    gfloat          lx;         /*!< X coordinate of the label (top left). */
+    gfloat          ly;         /*!< Y coordinate of the label (top left). */
+    GooCanvasBounds bounds;     /*!< Area covered by marker, label and range circle. */
+    GooCanvasBounds trackbounds;        /*!< Area covered by the ground track. */
+    sat_map_obj_t  *obj;        /*!< The satellite object or NULL if not shown. */
+} sat_layer_dot_t;
+
+/**
+ * Satellite layer.
+ *
+ * When the satellite layer is enabled the satellites, their range circles
+ * and ground tracks are not canvas items; they are drawn with Cairo on top of
+ * the canvas from the dots array, which has one entry for each satellite in
+ * the sat_array_t of the map. Only the tiles touched by satellites that have
+ * moved are redrawn. See gtk-sat-map-layer.c.
+ */
+typedef struct {
+    sat_layer_dot_t *dots;      /*!< Drawing data, indexed like GtkSatMap::sats. */
+    guint           num;        /*!< Number of elements in dots. */
+    guint8         *dirty;      /*!< Tiles that need to be redrawn. */
+    guint           cols;       /*!< Number of tile columns. */
+    guint           rows;       /*!< Number of tile rows. */
+    gboolean        damaged;    /*!< At least one tile is dirty. */
+    guint32         col;        /*!< Satellite colour. */
+    guint32         selcol;     /*!< Colour of the selected satellite. */
+    guint32         covcol;     /*!< Coverage area colour. */
+    guint32         trackcol;   /*!< Ground track colour. */
+    guint32         shadowcol;  /*!< Shadow colour. */
+    PangoFontDescription *font; /*!< Label font. */
+} sat_layer_t;
+
 /** The satellite map data structure. */
 typedef struct {
     GtkBox          vbox;
@@ -107,12 +167,17 @@ typedef struct {
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< Module configuration data. */
-    GHashTable     *sats;       /*!< Pointer to satellites (owned by parent GtkSatModule). */
+    sat_array_t    *sats;       /*!< Pointer to satellites (owned by parent GtkSatModule). */
     qth_t          *qth;        /*!< Pointer to current location. */
 
     GHashTable     *obj;        /*!< Canvas items representing each satellite. */
     GHashTable     *showtracks; /*!< A hash of satellites to show tracks for. */
+    pred_batch_t   *tracks;     /*!< Ground track jobs of this update, see ground_track_submit(). */
+    pred_batch_t   *tracks_busy;        /*!< Ground track jobs being calculated. */
     GHashTable     *hidecovs;   /*!< A hash of satellites to hide coverage for. */
+    sat_layer_t    *layer;      /*!< Satellite layer or NULL if canvas items are used. */
+    hit_grid_t     *hits;       /*!< Markers and labels for finding satellites under the mouse pointer. */
+    hit_grid_t     *covhits;    /*!< Range circles for finding satellites under the mouse pointer. */
 
     guint           x0;         /*!< X0 of the canvas map. */
     guint           y0;         /*!< Y0 of the canvas map. */
@@ -142,14 +207,14 @@ struct _GtkSatMapClass {
 
 GType           gtk_sat_map_get_type(void);
 GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata,
-                                GHashTable * sats, qth_t * qth);
+                                sat_array_t * sats, qth_t * qth);
 void            gtk_sat_map_update(GtkWidget * widget);
 void            gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
                                          gdouble lon, gdouble lat,
                                          gdouble * x, gdouble * y);
 
-void            gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats);
+void            gtk_sat_map_reload_sats(GtkWidget * satmap, sat_array_t * sats);
 void            gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum);
 
 /* *INDENT-OFF* */
@@ -60,6 +60,8 @@
 #include "mod-cfg-get-param.h"
 #include "mod-mgr.h"
 #include "orbit-tools.h"
+#include "pass-cache.h"
+#include "predict-jobs.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
@@ -69,17 +71,13 @@
 
 static GtkVBoxClass *parent_class = NULL;
 
-static void gtk_sat_module_free_sat(gpointer sat)
-{
-    gtk_sat_data_free_sat(SAT(sat));
-}
+static void     gtk_sat_module_snapshot_ready(sat_propagator_t * prop,
+                                              gpointer data);
 
 static void update_autotrack(GtkSatModule * module)
 {
-    GList          *satlist = NULL;
-    GList          *iter;
     sat_t          *sat = NULL;
-    guint           i, n;
+    guint           i;
     double          next_aos;
     gint            next_sat;
     int             min_ele = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
@@ -87,26 +85,22 @@ static void update_autotrack(GtkSatModule * module)
     //sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s: Function called", __func__);
 
     if (module->target > 0)
-        sat = g_hash_table_lookup(module->satellites, &module->target);
+        sat = sat_array_lookup(module->sats, module->target);
 
     /* do nothing if current target is still above horizon */
     if (sat != NULL && sat->el > min_ele)
         return;
 
     /* set target to satellite with next AOS */
-    satlist = g_hash_table_get_values(module->satellites);
-    iter = satlist;
-    n = g_list_length(satlist);
-    if (n == 0)
+    if (module->sats->num == 0)
         return;
 
     next_aos = module->tmgCdnum + 10.f; /* hope there is AOS within 10 days */
     next_sat = module->target;
 
-    i = 0;
-    while (i++ < n)
+    for (i = 0; i < module->sats->num; i++)
     {
-        sat = (sat_t *) iter->data;
+        sat = &module->sats->sats[i];
 
         /* if sat is above horizon, select it and we are done */
         if (sat->el > min_ele)
@@ -121,8 +115,6 @@ static void update_autotrack(GtkSatModule * module)
             next_aos = sat->aos;
             next_sat = sat->tle.catnr;
         }
-
-        iter = iter->next;
     }
 
     if (next_sat != module->target)
@@ -132,8 +124,6 @@ static void update_autotrack(GtkSatModule * module)
                     module->target, next_sat);
         gtk_sat_module_select_sat(module, next_sat);
     }
-
-    g_list_free(satlist);
 }
 
 
@@ -142,10 +132,8 @@ static void update_autotrack(GtkSatModule * module)
 // Above TODO status: done (fixed)
 static void update_autotrack_second_sat(GtkSatModule * module)
 {
-    GList          *satlist = NULL;
-    GList          *iter;
     sat_t          *sat = NULL;
-    guint           i, n;
+    guint           i;
     double          next_aos;
     gint            next_sat;
     int             min_ele = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
@@ -153,26 +141,22 @@ static void update_autotrack_second_sat(GtkSatModule * module)
     //sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s: Function called", __func__);
 
     if (module->target2 > 0)
-        sat = g_hash_table_lookup(module->satellites, &module->target2);
+        sat = sat_array_lookup(module->sats, module->target2);
 
     /* do nothing if current target is still above horizon */
     if (sat != NULL && sat->el > min_ele)
         return;
 
     /* set target to satellite with next AOS */
-    satlist = g_hash_table_get_values(module->satellites);
-    iter = satlist;
-    n = g_list_length(satlist);
-    if (n == 0)
+    if (module->sats->num == 0)
         return;
 
     next_aos = module->tmgCdnum + 10.f; /* hope there is AOS within 10 days */
     next_sat = module->target2;
 
-    i = 0;
-    while (i++ < n)
+    for (i = 0; i < module->sats->num; i++)
     {
-        sat = (sat_t *) iter->data;
+        sat = &module->sats->sats[i];
 
         /* if sat is above horizon, select it and we are done */
         if (sat->el > min_ele)
@@ -187,8 +171,6 @@ static void update_autotrack_second_sat(GtkSatModule * module)
             next_aos = sat->aos;
             next_sat = sat->tle.catnr;
         }
-
-        iter = iter->next;
     }
 
     if (next_sat != module->target2)
@@ -198,8 +180,16 @@ static void update_autotrack_second_sat(GtkSatModule * module)
                     module->target2, next_sat);
         gtk_sat_module_select_sat_second(module, next_sat);
     }
+}
 
-    g_list_free(satlist);
+/** Cancel the AOS/LOS update started by gtk_sat_module_update_events(). */
+static void gtk_sat_module_cancel_events(GtkSatModule * module)
+{
+    if (module->events != NULL)
+    {
+        pred_batch_cancel(module->events);
+        module->events = NULL;
+    }
 }
 
 static void gtk_sat_module_destroy(GtkWidget * widget)
@@ -257,9 +247,18 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
     }
 
     /* clean up satellites */
-    if (module->satellites)
+    gtk_sat_module_cancel_events(module);
+
+    if (module->prop)
     {
-        g_hash_table_destroy(module->satellites);
+        sat_propagator_free(module->prop);
+        module->prop = NULL;
+    }
+
+    if (module->sats)
+    {
+        sat_array_free(module->sats);
+        module->sats = NULL;
         module->satellites = NULL;
     }
 
@@ -269,6 +268,12 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         module->grid = NULL;
     }
 
+    if (module->timing)
+    {
+        cycle_timing_free(module->timing);
+        module->timing = NULL;
+    }
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -296,8 +301,11 @@ static void gtk_sat_module_init(GtkSatModule * module,
     module->qth = g_try_new0(qth_t, 1);
     qth_init(module->qth);
 
-    module->satellites = g_hash_table_new_full(g_int_hash, g_int_equal,
-                                               g_free, gtk_sat_module_free_sat);
+    module->sats = sat_array_new();
+    module->satellites = module->sats->index;
+    module->prop = NULL;
+    module->events = NULL;
+    module->timing = cycle_timing_new();
 
     module->rotctrlwin = NULL;
     module->rotctrl = NULL;
@@ -376,17 +384,17 @@ static GtkWidget *create_view(GtkSatModule * module, guint num)
     {
     case GTK_SAT_MOD_VIEW_LIST:
         view = gtk_sat_list_new(module->cfgdata,
-                                module->satellites, module->qth, 0);
+                                module->sats, module->qth, 0);
         break;
 
     case GTK_SAT_MOD_VIEW_MAP:
         view = gtk_sat_map_new(module->cfgdata,
-                               module->satellites, module->qth);
+                               module->sats, module->qth);
         break;
 
     case GTK_SAT_MOD_VIEW_POLAR:
         view = gtk_polar_view_new(module->cfgdata,
-                                  module->satellites, module->qth);
+                                  module->sats, module->qth);
         break;
 
     case GTK_SAT_MOD_VIEW_SINGLE:
@@ -418,7 +426,7 @@ static GtkWidget *create_view(GtkSatModule * module, guint num)
                     __FILE__, __LINE__, num);
 
         view = gtk_sat_list_new(module->cfgdata,
-                                module->satellites, module->qth, 0);
+                                module->sats, module->qth, 0);
         break;
     }
 
@@ -497,17 +505,14 @@ static void create_module_layout(GtkSatModule * module)
  * Read satellites into memory.
  *
  * This function reads the list of satellites from the configfile and
- * and then adds each satellite to the hash table.
+ * and then reads the satellites into the satellite array.
  */
 static void gtk_sat_module_load_sats(GtkSatModule * module)
 {
     gint           *sats = NULL;
     gsize           length;
     GError         *error = NULL;
-    guint           i;
-    sat_t          *sat;
-    guint          *key = NULL;
-    guint           succ = 0;
+    guint           succ;
 
     /* get list of satellites from config file; abort in case of error */
     sats = g_key_file_get_integer_list(module->cfgdata,
@@ -531,53 +536,34 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
         return;
     }
 
-    /* read each satellite into hash table */
-    for (i = 0; i < length; i++)
-    {
-        sat = g_new(sat_t, 1);
-
-        if (gtk_sat_data_read_sat(sats[i], sat))
-        {
-            /* the satellite could not be read */
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Error reading data for #%d"),
-                        __func__, sats[i]);
-
-            g_free(sat);
-        }
-        else
-        {
-            /* check whether satellite is already in list
-               in order to avoid duplicates
-             */
-            key = g_new0(guint, 1);
-            *key = sats[i];
-
-            if (g_hash_table_lookup(module->satellites, key) == NULL)
-            {
-                gtk_sat_data_init_sat(sat, module->qth);
-                g_hash_table_insert(module->satellites, key, sat);
-                succ++;
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: Read data for #%d"), __func__, sats[i]);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_WARN,
-                            _("%s: Sat #%d already in list"),
-                            __func__, sats[i]);
-
-                /* it is not needed in this case */
-                g_free(sat);
-            }
-
-        }
-    }
+    succ = sat_array_load(module->sats, sats, length, module->qth);
 
     sat_log_log(SAT_LOG_LEVEL_INFO,
                 _("%s: Read %d out of %d satellites"), __func__, succ, length);
 
     g_free(sats);
+
+    module->prop = sat_propagator_new(module->sats,
+                                      sat_cfg_get_int
+                                      (SAT_CFG_INT_PRED_EPHEM_TOL),
+                                      sat_cfg_get_int
+                                      (SAT_CFG_INT_PRED_SLOW_REFRESH),
+                                      gtk_sat_module_snapshot_ready, module);
+}
+
+/**
+ * Replace the GtkSkyGlance widget with a new one.
+ *
+ * Destroying the old widget cancels its pass predictions, so the done
+ * callback never sees satellites that have been freed in the meantime.
+ */
+static void replace_skg(GtkSatModule * module)
+{
+    gtk_container_remove(GTK_CONTAINER(module->skgwin), module->skg);
+    module->skg =
+        gtk_sky_glance_new(module->satellites, module->qth, module->tmgCdnum);
+    gtk_container_add(GTK_CONTAINER(module->skgwin), module->skg);
+    gtk_widget_show_all(module->skg);
 }
 
 /**
@@ -612,12 +598,7 @@ static void update_skg(GtkSatModule * module)
                     _("%s: Updating GtkSkyGlance for %s"),
                     __func__, module->name);
 
-        gtk_container_remove(GTK_CONTAINER(module->skgwin), module->skg);
-        module->skg =
-            gtk_sky_glance_new(module->satellites, module->qth,
-                               module->tmgCdnum);
-        gtk_container_add(GTK_CONTAINER(module->skgwin), module->skg);
-        gtk_widget_show_all(module->skg);
+        replace_skg(module);
 
         module->lastSkgUpd = module->tmgCdnum;
         qth_small_save(module->qth, &(module->lastSkgUpdqth));
@@ -656,50 +637,62 @@ static void update_header(GtkSatModule * module)
  *
  * @param child Pointer to the child widget (views)
  * @param tstamp The current timestamp
+ * @param timing The timing record of the module
  *
  * This function is called by the main loop of the GtkSatModule widget for
  * each view in the layout grid.
  */
-static void update_child(GtkWidget * child, gdouble tstamp)
+static void update_child(GtkWidget * child, gdouble tstamp,
+                         cycle_timing_t * timing)
 {
+    gint64          start = g_get_monotonic_time();
+    cycle_phase_t   phase;
+
     if (IS_GTK_SAT_LIST(child))
     {
+        phase = CYCLE_PHASE_VIEW_LIST;
         GTK_SAT_LIST(child)->tstamp = tstamp;
         gtk_sat_list_update(child);
     }
 
     else if (IS_GTK_SAT_MAP(child))
     {
+        phase = CYCLE_PHASE_VIEW_MAP;
         GTK_SAT_MAP(child)->tstamp = tstamp;
         gtk_sat_map_update(child);
     }
 
     else if (IS_GTK_POLAR_VIEW(child))
     {
+        phase = CYCLE_PHASE_VIEW_POLAR;
         GTK_POLAR_VIEW(child)->tstamp = tstamp;
         gtk_polar_view_update(child);
     }
 
     else if (IS_GTK_SINGLE_SAT(child))
     {
+        phase = CYCLE_PHASE_VIEW_SINGLE;
         GTK_SINGLE_SAT(child)->tstamp = tstamp;
         gtk_single_sat_update(child);
     }
 
     else if (IS_GTK_SECOND_SAT(child))
     {
+        phase = CYCLE_PHASE_VIEW_SECOND;
         GTK_SECOND_SAT(child)->tstamp = tstamp;
         gtk_second_sat_update(child);
     }
 
     else if (IS_GTK_EVENT_LIST(child))
     {
+        phase = CYCLE_PHASE_VIEW_EVENT;
         GTK_EVENT_LIST(child)->tstamp = tstamp;
         gtk_event_list_update(child);
     }
 
     else if (IS_GTK_TWO_SAT(child))
     {
+        phase = CYCLE_PHASE_VIEW_TWO;
         GTK_TWO_SAT(child)->tstamp = tstamp;
         gtk_two_sat_update_first(child);
         gtk_two_sat_update_second(child);
@@ -709,108 +702,328 @@ static void update_child(GtkWidget * child, gdouble tstamp)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%d: Unknown child type"), __FILE__, __LINE__);
+        return;
+    }
+
+    cycle_timing_end(timing, phase, start);
+}
+
+/**
+ * Store the new AOS and LOS times.
+ *
+ * @param jobs The PRED_JOB_EVENTS jobs submitted by
+ *             gtk_sat_module_update_events() or
+ *             gtk_sat_module_update_expired().
+ * @param data Pointer to the GtkSatModule widget.
+ *
+ * The times are for the module time when the jobs were added. They are
+ * still good if the time has moved forward since; any that are now in the
+ * past are picked up by gtk_sat_module_update_expired(). If the time
+ * controller has moved the time back, the satellites may have an earlier
+ * AOS, so the results are dropped and a full update is done on the next
+ * cycle.
+ */
+static void gtk_sat_module_events_ready(GPtrArray * jobs, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+    pred_job_t     *job;
+    guint           i;
+
+    module->events = NULL;
+
+    if (jobs->len == 0)
+        return;
+
+    cycle_timing_end(module->timing, CYCLE_PHASE_EVENT_SEARCH,
+                     module->events_start);
+
+    job = g_ptr_array_index(jobs, 0);
+    if (module->tmgCdnum < job->start)
+    {
+        module->event_count = 0;
+        return;
+    }
+
+    module->events_dnum = job->start;
+
+    for (i = 0; i < jobs->len; i++)
+    {
+        job = g_ptr_array_index(jobs, i);
+        job->sat->aos = job->aos;
+        job->sat->los = job->los;
     }
 }
 
+/** Add an event prediction job for a satellite that can have AOS. */
+static void gtk_sat_module_add_event_job(GtkSatModule * module, sat_t * sat)
+{
+    /* Note that has_aos may return TRUE for geostationary sats
+       whose orbit deviate from a true-geostat orbit, however,
+       find_events will not look for an AOS beyond the time limit
+       we specify (in those cases we use 0.0 for AOS/LOS times).
+       We use SAT_CFG_INT_PRED_LOOK_AHEAD for upper time limit */
+    if (has_aos(sat, module->qth))
+        pred_batch_add(module->events, PRED_JOB_EVENTS, sat,
+                       module->tmgCdnum,
+                       (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD),
+                       0);
+}
+
 /**
- * Update a given satellite.
+ * Recalculate the next AOS and LOS of all satellites.
  *
- * @param key The hash table key (catnum)
- * @param val The hash table value (sat_t structure)
- * @param data User data (the GtkSatModule widget).
+ * @param module Pointer to the GtkSatModule widget.
  *
- * This function updates the tracking data for a given satellite. It is called by
- * the timeout handler for each element in the hash table.
+ * The events are calculated on the prediction worker threads and stored by
+ * gtk_sat_module_events_ready() when all satellites are done, so a module
+ * with many satellites does not stall the timeout. Until then the views
+ * keep showing the previous times. A pending update is cancelled; its
+ * results would be for an old time or location.
  */
-static void gtk_sat_module_update_sat(gpointer key, gpointer val,
-                                      gpointer data)
+static void gtk_sat_module_update_events(GtkSatModule * module)
+{
+    guint           i;
+
+    gtk_sat_module_cancel_events(module);
+
+    if (module->sats == NULL)
+        return;
+
+    module->events = pred_batch_new(module->qth,
+                                    gtk_sat_module_events_ready, module);
+    for (i = 0; i < module->sats->num; i++)
+        gtk_sat_module_add_event_job(module, &module->sats->sats[i]);
+    module->events_start = g_get_monotonic_time();
+    pred_batch_submit(module->events);
+}
+
+/**
+ * Recalculate the AOS and LOS of satellites whose events have passed.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ *
+ * An AOS or LOS before the current time can not be the next event of that
+ * satellite. Its AOS and LOS are recalculated in the background like in
+ * gtk_sat_module_update_events(); the old times are shown until the new
+ * ones are ready. An AOS or LOS of 0.0 means that none was found within
+ * the look-ahead time and is left for the periodic full update, so
+ * satellites in parking orbits are not searched on every cycle.
+ *
+ * Nothing is done while another update is in progress; its results may
+ * already cover these satellites and any that are still in the past are
+ * handled on a later cycle.
+ */
+static void gtk_sat_module_update_expired(GtkSatModule * module)
 {
     sat_t          *sat;
-    GtkSatModule   *module;
-    gdouble         daynum;
+    gdouble         daynum = module->tmgCdnum;
     gdouble         maxdt;
+    guint           i;
+    guint           n = 0;
 
-    (void)key;
-
-    g_return_if_fail((val != NULL) && (data != NULL));
+    if (module->events != NULL || module->sats == NULL)
+        return;
 
-    sat = SAT(val);
-    module = GTK_SAT_MODULE(data);
     maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
 
-    /* get current time (real or simulated */
-    daynum = module->tmgCdnum;
-
-    /* update events if the event counter has been reset
-       and the other requirements are fulfilled */
-    if ((GTK_SAT_MODULE(module)->event_count == 0) &&
-        has_aos(sat, module->qth))
-    {
-        /* Note that has_aos may return TRUE for geostationary sats
-           whose orbit deviate from a true-geostat orbit, however,
-           find_aos and find_los will not go beyond the time limit
-           we specify (in those cases they return 0.0 for AOS/LOS times.
-           We use SAT_CFG_INT_PRED_LOOK_AHEAD for upper time limit */
-        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
-        sat->los = find_los(sat, module->qth, daynum, maxdt);
-    }
-    /*
-       Update AOS and LOS for this satellite if it was known and is before
-       the current time.
-
-       daynum is the current time in the module.
-
-       The conditional aos < daynum is merely saying that aos occurred
-       in the past. Therefore it cannot be the next event or aos/los
-       for that satellite.
-
-       The conditional aos > 0.0 is a short hand for saying that the
-       aos was successfully computed before. find_aos returns 0.0 when it
-       cannot find an AOS.
-
-       This code should not execute find_aos(los) if the conditional before
-       is triggered as the newly computed aos(los) should either be in
-       the future (aos > daynum) or (aos == 0 ).
-
-       Single sat/list/event/map views all use these values and they
-       should be up to date.
-
-       The above code is still required for dealing with circumstances
-       where the qth moves from someplace where the qth can have an AOS and
-       where qth does not and for satellites in parking orbits where the
-       AOS may be further than maxdt out results in aos==0.0 until the
-       next aos is closer than maxdt. It also prevents the aos from
-       being computed every pass through the module for the parking orbits.
-
-       To be completely correct, when time can move forward and backwards
-       as it can with the time controller, the time the aos/los was
-       computed should be stored and associated with aos/los. That way
-       if daynum <time_computed, the aos can be recomputed as there is
-       no assurance that the current stored aos is the next aos. As a
-       practical matter the above code handles time reversing acceptably
-       for most circumstances.
-     */
-    if (sat->aos > 0 && sat->aos < daynum)
-        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
+    for (i = 0; i < module->sats->num; i++)
+    {
+        sat = &module->sats->sats[i];
+        if ((sat->aos > 0.0 && sat->aos < daynum) ||
+            (sat->los > 0.0 && sat->los < daynum))
+        {
+            if (module->events == NULL)
+                module->events = pred_batch_new(module->qth,
+                                                gtk_sat_module_events_ready,
+                                                module);
+            pred_batch_add(module->events, PRED_JOB_EVENTS, sat, daynum,
+                           maxdt, 0);
+            n++;
+        }
+    }
+
+    if (n > 0)
+    {
+        module->events_start = g_get_monotonic_time();
+        pred_batch_submit(module->events);
+    }
+}
+
+/** Time before AOS when a satellite is back at the full rate [days]. */
+#define SLOW_AOS_MARGIN (5.0 / 1440.0)
+
+/** Keep a satellite at the full update rate. */
+static void gtk_sat_module_set_full(GtkSatModule * module, const sat_t * sat)
+{
+    gint            i;
+
+    if (sat == NULL)
+        return;
+
+    i = sat_array_index(module->sats, sat->tle.catnr);
+    if (i >= 0)
+        sat_propagator_set_slow(module->prop, i, 0.0);
+}
+
+/**
+ * Tell the propagator which satellites can be updated at the slow rate.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ *
+ * A satellite that is below the horizon is only shown on the map and in
+ * the lists until shortly before its AOS. Satellites without an AOS in the
+ * look-ahead time can be slow until the end of the search; while the
+ * events are being searched they are kept at the full rate, since their
+ * AOS is not known yet. The selected satellites and the targets of the
+ * controllers are always at the full rate.
+ */
+static void gtk_sat_module_schedule(GtkSatModule * module)
+{
+    GtkWidget      *child;
+    sat_t          *sat;
+    gdouble         t = module->tmgCdnum;
+    gdouble         end;
+    gdouble         until;
+    guint           i;
+
+    end = module->events_dnum +
+        (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+
+    for (i = 0; i < module->sats->num; i++)
+    {
+        sat = &module->sats->sats[i];
+        if (sat->el > 0.0)
+            until = 0.0;
+        else if (sat->aos > t)
+            until = sat->aos - SLOW_AOS_MARGIN;
+        else if (sat->aos == 0.0 && module->events == NULL)
+            until = end;
+        else
+            until = 0.0;
+
+        sat_propagator_set_slow(module->prop, i, until);
+    }
 
-    if (sat->los > 0 && sat->los < daynum)
-        sat->los = find_los(sat, module->qth, daynum, maxdt);
+    if (module->target > 0)
+        gtk_sat_module_set_full(module,
+                                sat_array_lookup(module->sats,
+                                                 module->target));
+    if (module->target2 > 0)
+        gtk_sat_module_set_full(module,
+                                sat_array_lookup(module->sats,
+                                                 module->target2));
+    if (module->rigctrl)
+        gtk_sat_module_set_full(module, GTK_RIG_CTRL(module->rigctrl)->target);
+    if (module->rotctrl)
+        gtk_sat_module_set_full(module, GTK_ROT_CTRL(module->rotctrl)->target);
 
-    predict_calc(sat, module->qth, daynum);
+    for (i = 0; i < module->nviews; i++)
+    {
+        child = GTK_WIDGET(g_slist_nth_data(module->views, i));
+        if (IS_GTK_SINGLE_SAT(child))
+            gtk_sat_module_set_full(module,
+                                    SAT(g_slist_nth_data
+                                        (GTK_SINGLE_SAT(child)->sats,
+                                         GTK_SINGLE_SAT(child)->selected)));
+        else if (IS_GTK_SECOND_SAT(child))
+            gtk_sat_module_set_full(module,
+                                    SAT(g_slist_nth_data
+                                        (GTK_SECOND_SAT(child)->sats,
+                                         GTK_SECOND_SAT(child)->selected2)));
+        else if (IS_GTK_TWO_SAT(child))
+        {
+            gtk_sat_module_set_full(module,
+                                    SAT(g_slist_nth_data
+                                        (GTK_TWO_SAT(child)->sats,
+                                         GTK_TWO_SAT(child)->selected1)));
+            gtk_sat_module_set_full(module,
+                                    SAT(g_slist_nth_data
+                                        (GTK_TWO_SAT(child)->sats,
+                                         GTK_TWO_SAT(child)->selected2)));
+        }
+    }
+}
+
+/**
+ * Update the views with new satellite data.
+ *
+ * @param prop The propagator of the module.
+ * @param data Pointer to the GtkSatModule widget.
+ *
+ * Called in the main loop when the propagator has published the satellite
+ * data requested by gtk_sat_module_timeout_cb(). The data is copied to the
+ * satellites in one go, so the views, the controllers and the autotracker
+ * all see the same time. The views use their own working copies for any
+ * other times and do not modify the satellites.
+ */
+static void gtk_sat_module_snapshot_ready(sat_propagator_t * prop,
+                                          gpointer data)
+{
+    GtkSatModule   *mod = GTK_SAT_MODULE(data);
+    GtkWidget      *child;
+    const sat_snapshot_t *snap;
+    gint64          start = g_get_monotonic_time();
+    gint64          pstart;
+    gdouble         t;
+    guint           i;
+
+    /* the satellites are being reloaded */
+    if (g_mutex_trylock(&mod->busy) == FALSE)
+        return;
+
+    snap = sat_propagator_snapshot(prop);
+    if (snap != NULL)
+        cycle_timing_add(mod->timing, CYCLE_PHASE_PROPAGATE, snap->usec);
+
+    t = sat_propagator_apply(prop);
+    cycle_timing_end(mod->timing, CYCLE_PHASE_APPLY, start);
+
+    /* update children */
+    for (i = 0; i < mod->nviews; i++)
+    {
+        child = GTK_WIDGET(g_slist_nth_data(mod->views, i));
+        update_child(child, t, mod->timing);
+    }
+
+    /* update target if autotracking is enabled */
+    if (mod->autotrack)
+    {
+        pstart = g_get_monotonic_time();
+        update_autotrack(mod);
+        update_autotrack_second_sat(mod);
+        cycle_timing_end(mod->timing, CYCLE_PHASE_AUTOTRACK, pstart);
+    }
+
+    /* send notice to radio and rotator controller */
+    if (mod->rigctrl || mod->rotctrl)
+    {
+        pstart = g_get_monotonic_time();
+        if (mod->rigctrl)
+            gtk_rig_ctrl_update(GTK_RIG_CTRL(mod->rigctrl), t);
+        if (mod->rotctrl)
+            gtk_rot_ctrl_update(GTK_ROT_CTRL(mod->rotctrl), t);
+        cycle_timing_end(mod->timing, CYCLE_PHASE_CTRL, pstart);
+    }
+
+    cycle_timing_end(mod->timing, CYCLE_PHASE_UPDATE, start);
+    cycle_timing_log(mod->timing, mod->name);
+
+    g_mutex_unlock(&mod->busy);
 }
 
 /** Module timeout callback. */
 static gboolean gtk_sat_module_timeout_cb(gpointer module)
 {
     GtkSatModule   *mod = GTK_SAT_MODULE(module);
-    GtkWidget      *child;
     gboolean        needupdate = FALSE;
     GdkWindowState  state;
     gdouble         delta;
-    guint           i;
+    gint64          start = g_get_monotonic_time();
+    gint64          pstart;
 
     /*update the qth position */
     qth_data_update(mod->qth, mod->tmgCdnum);
+    cycle_timing_end(mod->timing, CYCLE_PHASE_QTH, start);
 
     /* in docked state, update only if tab is visible */
     switch (mod->state)
@@ -861,13 +1074,17 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         {
             /* reset counter */
             mod->head_count = 0;
+            pstart = g_get_monotonic_time();
             update_header(mod);
+            cycle_timing_end(mod->timing, CYCLE_PHASE_HEADER, pstart);
         }
 
-        /* reset event update counter if is has expired or if we have moved
-           significantly */
+        /* reset event update counter if is has expired, if we have moved
+           significantly or if the time has been set back */
+        pstart = g_get_monotonic_time();
         if (mod->event_count == mod->event_timeout ||
-            qth_small_dist(mod->qth, mod->qth_event) > 1.0)
+            qth_small_dist(mod->qth, mod->qth_event) > 1.0 ||
+            mod->tmgCdnum < mod->events_dnum)
         {
             mod->event_count = 0;       // will trigger find_aos() and find_los()
         }
@@ -875,46 +1092,42 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         /* if the events are going to be recalculated store the position */
         if (mod->event_count == 0)
         {
+            /* the passes for the old position are of no further use */
+            if (qth_small_dist(mod->qth, mod->qth_event) > 1.0)
+                pass_cache_invalidate_qth(&(mod->qth_event));
+
             qth_small_save(mod->qth, &(mod->qth_event));
+            mod->events_dnum = mod->tmgCdnum;
+            gtk_sat_module_update_events(mod);
         }
-
-        /* update satellite data */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
-
-        /* update children */
-        for (i = 0; i < mod->nviews; i++)
+        else
         {
-            child = GTK_WIDGET(g_slist_nth_data(mod->views, i));
-            update_child(child, mod->tmgCdnum);
+            gtk_sat_module_update_expired(mod);
         }
+        cycle_timing_end(mod->timing, CYCLE_PHASE_EVENTS, pstart);
 
-        /* update satellite data (it may have got out of sync during child updates) */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
-
-        /* update target if autotracking is enabled */
-        if (mod->autotrack)
+        /* propagate the satellites on the worker; the views are updated
+           by gtk_sat_module_snapshot_ready() when the data is ready */
+        if (mod->prop != NULL)
         {
-            update_autotrack(mod);
-            update_autotrack_second_sat(mod);
+            gtk_sat_module_schedule(mod);
+            if (!sat_propagator_request(mod->prop, mod->qth, mod->tmgCdnum))
+                sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                            _("%s: Previous propagation is still running."),
+                            __func__);
         }
 
-        /* send notice to radio and rotator controller */
-        if (mod->rigctrl)
-            gtk_rig_ctrl_update(GTK_RIG_CTRL(mod->rigctrl), mod->tmgCdnum);
-        if (mod->rotctrl)
-            gtk_rot_ctrl_update(GTK_ROT_CTRL(mod->rotctrl), mod->tmgCdnum);
-
         /* check and update Sky at glance */
         /* FIXME: We should have some timeout counter to ensure that we don't
            update GtkSkyGlance too often when running with high throttle values;
            however, the update does not seem to add any significant load even
            when running at max throttle */
         if (mod->skg)
+        {
+            pstart = g_get_monotonic_time();
             update_skg(mod);
+            cycle_timing_end(mod->timing, CYCLE_PHASE_SKG, pstart);
+        }
 
         mod->event_count++;
 
@@ -930,6 +1143,8 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
                 tmg_update_widgets(mod);
         }
 
+        cycle_timing_end(mod->timing, CYCLE_PHASE_TIMEOUT, start);
+
         g_mutex_unlock(&mod->busy);
     }
 
@@ -1344,6 +1559,7 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
     gchar          *cfgfile;
     mod_cfg_status_t retcode;
     gtk_sat_mod_state_t laststate;
+    qth_small_t     lastqth;
     gint            w, h;
 
     (void)button;
@@ -1394,6 +1610,7 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
                 gtk_widget_get_allocation(GTK_WIDGET(module), &alloc);
                 w = alloc.width;
                 h = alloc.height;
+                qth_small_save(module->qth, &lastqth);
 
                 gtk_sat_module_close_cb(NULL, module);
 
@@ -1407,6 +1624,10 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
                 module = GTK_SAT_MODULE(gtk_sat_module_new(cfgfile));
                 module->state = laststate;
 
+                /* the module may have a new QTH */
+                if (qth_small_dist(module->qth, lastqth) > 0.0)
+                    pass_cache_invalidate_qth(&lastqth);
+
                 switch (laststate)
                 {
 
@@ -1493,11 +1714,11 @@ static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
     }
     else if (IS_GTK_POLAR_VIEW(widget))
     {
-        gtk_polar_view_reload_sats(widget, module->satellites);
+        gtk_polar_view_reload_sats(widget, module->sats);
     }
     else if (IS_GTK_SAT_MAP(widget))
     {
-        gtk_sat_map_reload_sats(widget, module->satellites);
+        gtk_sat_map_reload_sats(widget, module->sats);
     }
     else if (IS_GTK_SAT_LIST(widget))
     {
@@ -1534,7 +1755,7 @@ static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
  *   2. The module configuration has changed (i.e. which satellites to track).
  *
  * The function assumes that module->cfgdata has already been updated, and so
- * all it has to do is to free module->satellites and re-execute the satellite
+ * all it has to do is to clear module->sats and re-execute the satellite
  * loading sequence.
  */
 void gtk_sat_module_reload_sats(GtkSatModule * module)
@@ -1551,8 +1772,16 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
                 _("%s: Reloading satellites for module %s"),
                 __func__, module->name);
 
-    /* remove each element from the hash table, but keep the hash table */
-    g_hash_table_remove_all(module->satellites);
+    /* the pending events and snapshots refer to the old satellites */
+    gtk_sat_module_cancel_events(module);
+    if (module->prop)
+    {
+        sat_propagator_free(module->prop);
+        module->prop = NULL;
+    }
+
+    /* remove the satellites, but keep the array and its index */
+    sat_array_clear(module->sats);
 
     /* reset event counter so that next AOS/LOS gets re-calculated */
     module->event_count = 0;
@@ -1567,6 +1796,13 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
         reload_sats_in_child(child, module);
     }
 
+    /* the sky at a glance passes point to the old satellites as well */
+    if (module->skg)
+    {
+        replace_skg(module);
+        module->lastSkgUpd = module->tmgCdnum;
+    }
+
     /* FIXME: radio and rotator controller */
 
     /* unlock module */
@@ -6,7 +6,11 @@
 #include <gtk/gtk.h>
 
 #include "qth-data.h"
+#include "cycle-timing.h"
 #include "gtk-sat-data.h"
+#include "predict-jobs.h"
+#include "sat-array.h"
+#include "sat-propagator.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -79,7 +83,13 @@ struct _gtk_sat_module {
     GKeyFile       *cfgdata;    /*!< Configuration data. */
     qth_t          *qth;        /*!< QTH information. */
     qth_small_t     qth_event;  /*!< QTH information for last AOS/LOS update. */
-    GHashTable     *satellites; /*!< Satellites. */
+    sat_array_t    *sats;       /*!< Satellites. */
+    GHashTable     *satellites; /*!< Index of sats by catalog number. */
+    sat_propagator_t *prop;     /*!< Propagation worker for the satellites. */
+    pred_batch_t   *events;     /*!< AOS/LOS update in progress or NULL. */
+    gdouble         events_dnum;        /*!< Daynum of the last AOS/LOS update. */
+    gint64          events_start;       /*!< Monotonic time the AOS/LOS update was submitted. */
+    cycle_timing_t *timing;     /*!< Timing of the update cycle. */
 
     guint32         timeout;    /*!< Timeout value [msec] */
 
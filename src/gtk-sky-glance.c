@@ -52,6 +52,7 @@
 #include "gtk-sat-data.h"
 #include "gtk-sky-glance.h"
 #include "mod-cfg-get-param.h"
+#include "predict-jobs.h"
 #include "predict-tools.h"
 #include "sat-pass-dialogs.h"
 #include "sat-cfg.h"
@@ -87,6 +88,7 @@ static void gtk_sky_glance_init(GtkSkyGlance * skg,
     skg->satcnt = 0;
     skg->ts = 0.0;
     skg->te = 0.0;
+    skg->jobs = NULL;
 }
 
 /**
@@ -104,6 +106,13 @@ static void gtk_sky_glance_destroy(GtkWidget * widget)
     sky_pass_t     *skypass;
     guint           i, n;
 
+    /* the predictions may still be running */
+    if (GTK_SKY_GLANCE(widget)->jobs != NULL)
+    {
+        pred_batch_cancel(GTK_SKY_GLANCE(widget)->jobs);
+        GTK_SKY_GLANCE(widget)->jobs = NULL;
+    }
+
     /* free passes */
     /* FIXME: TBC whether this is enough */
     if (GTK_SKY_GLANCE(widget)->passes != NULL)
@@ -655,20 +664,15 @@ static void get_colors(guint i, guint * bcol, guint * fcol)
 /**
  * Create canvas items for a satellite
  *
- * @param key Pointer to the hash key (catnum of sat)
- * @param value Pointer to the current satellite.
- * @param data Pointer to the GtkSkyGlance object.
+ * @param skg Pointer to the GtkSkyGlance object.
+ * @param sat Pointer to the current satellite.
+ * @param passes The passes of the satellite.
  *
- * This function is called by g_hash_table_foreach with each satellite in
- * the satellite hash table. It gets the passes for the current satellite
- * and creates the corresponding canvas items.
+ * This function is called with the predicted passes of each satellite in
+ * the satellite hash table and creates the corresponding canvas items.
  */
-// Crashes from 2nd iter of create_sat
-static void create_sat(gpointer key, gpointer value, gpointer data)
+static void create_sat(GtkSkyGlance * skg, sat_t * sat, GSList * passes)
 {
-    sat_t          *sat = SAT(value);
-    GtkSkyGlance   *skg = GTK_SKY_GLANCE(data);
-    GSList         *passes = NULL;
     gdouble         maxdt;
     guint           i, n;
     pass_t         *tmppass = NULL;
@@ -679,8 +683,6 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s: Function called, sat is: %s", __func__, sat->nickname);
 
-    (void)key;
-
     /* tooltips vars */
     gchar          *tooltip;    /* the complete tooltips string */
     gchar           aosstr[100];        /* AOS time string */
@@ -692,11 +694,6 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
     get_colors(skg->satcnt++, &bcol, &fcol);
     maxdt = skg->te - skg->ts;
 
-    // Until here, no issues
-
-    /* get passes for satellite */
-    // get_passes causes problems on 2nd iter onwards
-    passes = get_passes(sat, skg->qth, skg->ts, maxdt, 10);
     n = g_slist_length(passes);
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s:%d: %s has %d passes within %.4f days\n"),
@@ -766,8 +763,6 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
                              (GCallback) on_button_release, skg);
         }
 
-        free_passes(passes);
-
         /* add satellite label */
         label = goo_canvas_text_new(root, sat->nickname,
                                     5, 0, -1, GOO_CANVAS_ANCHOR_W,
@@ -782,6 +777,49 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
     }
 }
 
+/**
+ * Create the pass items when the predictions are ready.
+ *
+ * @param jobs The prediction jobs, one for each satellite.
+ * @param data Pointer to the GtkSkyGlance object.
+ *
+ * This function is called in the main loop when the passes of all the
+ * satellites have been predicted by the worker threads.
+ */
+static void passes_ready(GPtrArray * jobs, gpointer data)
+{
+    GtkSkyGlance   *skg = GTK_SKY_GLANCE(data);
+    pred_job_t     *job;
+    GtkAllocation   aloc;
+    guint           i;
+
+    skg->jobs = NULL;
+
+    for (i = 0; i < jobs->len; i++)
+    {
+        job = g_ptr_array_index(jobs, i);
+        create_sat(skg, job->sat, job->passes);
+    }
+
+    /* the canvas may have been laid out already without the passes */
+    if (gtk_widget_get_realized(skg->canvas))
+    {
+        gtk_widget_get_allocation(skg->canvas, &aloc);
+        size_allocate_cb(skg->canvas, &aloc, skg);
+    }
+}
+
+/** Add a pass prediction job for a satellite to the batch. */
+static void add_sat_job(gpointer key, gpointer value, gpointer data)
+{
+    GtkSkyGlance   *skg = GTK_SKY_GLANCE(data);
+
+    (void)key;
+
+    pred_batch_add(skg->jobs, PRED_JOB_PASSES, SAT(value),
+                   skg->ts, skg->te - skg->ts, 10);
+}
+
 /**
  * Create a new GtkSkyGlance widget.
  *
@@ -836,11 +874,12 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
 
     /* Create the canvas items */
     create_canvas_items(skg);
-    // this works fine
-    //sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s: line %d breakpoint log", __FILE__, __LINE__);
-    // Below line crashes program with 100% CPU usage, possibly within create_sat
-    g_hash_table_foreach(skg->sats, create_sat, skg);
-    sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s: line %d breakpoint log", __FILE__, __LINE__);
+
+    /* predict the passes in the background; the pass items are created
+       by passes_ready() when all satellites are done */
+    skg->jobs = pred_batch_new(skg->qth, passes_ready, skg);
+    g_hash_table_foreach(skg->sats, add_sat_job, skg);
+    pred_batch_submit(skg->jobs);
 
     gtk_box_pack_start(GTK_BOX(skg), skg->canvas, TRUE, TRUE, 0);
 
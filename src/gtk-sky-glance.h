@@ -34,6 +34,7 @@
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
 
+#include "predict-jobs.h"
 #include "predict-tools.h"
 
 /* *INDENT-OFF* */
@@ -104,6 +105,8 @@ struct _GtkSkyGlance {
     GooCanvasItem  *cursor;     /* Vertical line tracking the cursor */
     GooCanvasItem  *timel;      /* Label showing time under cursor */
 
+    pred_batch_t   *jobs;       /* Pass predictions in progress or NULL */
+
 };
 
 struct _GtkSkyGlanceClass {
@@ -0,0 +1,400 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file hit-grid.c
+ * \brief Find satellites under the mouse pointer.
+ *
+ * The map and the polar view used to leave it to the canvas to find the
+ * item under the mouse pointer, which means testing every item of every
+ * satellite on each mouse event. Instead the views keep the screen
+ * position and a box around the marker and label of each satellite in a
+ * uniform grid of HIT_GRID_CELL sized cells. A box is only moved to other
+ * cells when it crosses a cell border, so keeping the grid up to date costs
+ * little more than a hash table lookup per moved satellite, and a query
+ * only needs to look at the entries of one cell or, for the nearest
+ * satellite, of a few rings of cells around the pointer.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <math.h>
+
+#include "hit-grid.h"
+
+static guint    cell_col(hit_grid_t * grid, gdouble x);
+static guint    cell_row(hit_grid_t * grid, gdouble y);
+static void     alloc_cells(hit_grid_t * grid);
+static void     free_cells(hit_grid_t * grid);
+static void     bin_entry(hit_grid_t * grid, hit_entry_t * entry);
+static void     unbin_entry(hit_grid_t * grid, hit_entry_t * entry);
+
+
+/**
+ * Create a new hit grid.
+ *
+ * @param cell The size of the cells in pixels, e.g. HIT_GRID_CELL.
+ * @return A new empty grid covering one cell. Use hit_grid_resize() to
+ *         set the size of the canvas.
+ */
+hit_grid_t     *hit_grid_new(gdouble cell)
+{
+    hit_grid_t     *grid = g_new0(hit_grid_t, 1);
+
+    grid->cell = cell;
+    grid->cols = 1;
+    grid->rows = 1;
+    grid->entries = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                          NULL, g_free);
+    alloc_cells(grid);
+
+    return grid;
+}
+
+/** Free a hit grid and all its entries. */
+void hit_grid_free(hit_grid_t * grid)
+{
+    if (grid == NULL)
+        return;
+
+    free_cells(grid);
+    g_hash_table_destroy(grid->entries);
+    g_free(grid);
+}
+
+/**
+ * Change the area covered by the grid.
+ *
+ * @param grid The hit grid.
+ * @param width The width of the canvas in pixels.
+ * @param height The height of the canvas in pixels.
+ *
+ * The entries are kept and sorted into the new cells. Points outside the
+ * area are assigned to the nearest border cell.
+ */
+void hit_grid_resize(hit_grid_t * grid, gdouble width, gdouble height)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    guint           cols = MAX(1, (guint) ceil(width / grid->cell));
+    guint           rows = MAX(1, (guint) ceil(height / grid->cell));
+
+    if (cols == grid->cols && rows == grid->rows)
+        return;
+
+    free_cells(grid);
+    grid->cols = cols;
+    grid->rows = rows;
+    alloc_cells(grid);
+
+    g_hash_table_iter_init(&iter, grid->entries);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+        bin_entry(grid, value);
+}
+
+/**
+ * Add a satellite or update its position.
+ *
+ * @param grid The hit grid.
+ * @param catnum The catalogue number of the satellite.
+ * @param x The X coordinate of the satellite.
+ * @param y The Y coordinate of the satellite.
+ * @param box The area that belongs to the satellite, e.g. marker and label,
+ *            or NULL if only the position should be used.
+ */
+void hit_grid_set(hit_grid_t * grid, gint catnum, gdouble x, gdouble y,
+                  const GooCanvasBounds * box)
+{
+    hit_entry_t    *entry = g_hash_table_lookup(grid->entries, &catnum);
+    gboolean        binned = (entry != NULL);
+
+    if (entry == NULL)
+    {
+        entry = g_new0(hit_entry_t, 1);
+        entry->catnum = catnum;
+        g_hash_table_insert(grid->entries, &entry->catnum, entry);
+    }
+
+    entry->x = x;
+    entry->y = y;
+    if (box != NULL)
+    {
+        entry->box = *box;
+    }
+    else
+    {
+        entry->box.x1 = entry->box.x2 = x;
+        entry->box.y1 = entry->box.y2 = y;
+    }
+
+    /* the position is always in the box, see hit_grid_nearest() */
+    entry->box.x1 = MIN(entry->box.x1, x);
+    entry->box.y1 = MIN(entry->box.y1, y);
+    entry->box.x2 = MAX(entry->box.x2, x);
+    entry->box.y2 = MAX(entry->box.y2, y);
+
+    /* most moves stay within the same cells */
+    if (binned &&
+        entry->col1 == cell_col(grid, entry->box.x1) &&
+        entry->row1 == cell_row(grid, entry->box.y1) &&
+        entry->col2 == cell_col(grid, entry->box.x2) &&
+        entry->row2 == cell_row(grid, entry->box.y2))
+        return;
+
+    if (binned)
+        unbin_entry(grid, entry);
+
+    bin_entry(grid, entry);
+}
+
+/** Remove a satellite from the grid. */
+void hit_grid_remove(hit_grid_t * grid, gint catnum)
+{
+    hit_entry_t    *entry = g_hash_table_lookup(grid->entries, &catnum);
+
+    if (entry == NULL)
+        return;
+
+    unbin_entry(grid, entry);
+    g_hash_table_remove(grid->entries, &catnum);
+}
+
+/**
+ * Find the satellite at a point.
+ *
+ * @param grid The hit grid.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param test Function doing an exact test for satellites whose box contains
+ *             the point, or NULL if the box is enough.
+ * @param data User data passed to test.
+ * @return The catalogue number of the satellite or 0 if there is none.
+ *
+ * If the point is in the box of several satellites the one closest to the
+ * point is returned.
+ */
+gint hit_grid_pick(hit_grid_t * grid, gdouble x, gdouble y,
+                   hit_test_func_t test, gpointer data)
+{
+    GPtrArray      *cell;
+    hit_entry_t    *entry;
+    gdouble         d2;
+    gdouble         best = G_MAXDOUBLE;
+    gint            catnum = 0;
+    guint           i;
+
+    cell = grid->cells[cell_row(grid, y) * grid->cols + cell_col(grid, x)];
+
+    for (i = 0; i < cell->len; i++)
+    {
+        entry = g_ptr_array_index(cell, i);
+
+        if (x < entry->box.x1 || x > entry->box.x2 ||
+            y < entry->box.y1 || y > entry->box.y2)
+            continue;
+
+        d2 = (x - entry->x) * (x - entry->x) + (y - entry->y) * (y - entry->y);
+        if (d2 >= best)
+            continue;
+
+        if (test != NULL && !test(entry->catnum, x, y, data))
+            continue;
+
+        best = d2;
+        catnum = entry->catnum;
+    }
+
+    return catnum;
+}
+
+/**
+ * Find the satellite closest to a point.
+ *
+ * @param grid The hit grid.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param maxdist The largest distance to look at in pixels.
+ * @return The catalogue number of the satellite or 0 if there is none
+ *         within maxdist.
+ *
+ * The cells are searched in rings around the cell of the point. Since every
+ * satellite is in the cell of its own position, a satellite found at
+ * distance d rules out all rings further away than d.
+ */
+gint hit_grid_nearest(hit_grid_t * grid, gdouble x, gdouble y,
+                      gdouble maxdist)
+{
+    GPtrArray      *cell;
+    hit_entry_t    *entry;
+    gdouble         d2;
+    gdouble         best = maxdist * maxdist;
+    gint            catnum = 0;
+    gint            col = cell_col(grid, x);
+    gint            row = cell_row(grid, y);
+    gint            c, r, k;
+    guint           i;
+
+    for (k = 0; k <= (gint) MAX(grid->cols, grid->rows); k++)
+    {
+        /* nothing in this ring can be closer than what we have */
+        if ((k - 1) * grid->cell > sqrt(best))
+            break;
+
+        for (r = row - k; r <= row + k; r++)
+        {
+            if (r < 0 || r >= (gint) grid->rows)
+                continue;
+
+            for (c = col - k; c <= col + k; c++)
+            {
+                if (c < 0 || c >= (gint) grid->cols)
+                    continue;
+
+                /* only the border of the ring */
+                if (r != row - k && r != row + k && c != col - k &&
+                    c != col + k)
+                    continue;
+
+                cell = grid->cells[r * grid->cols + c];
+                for (i = 0; i < cell->len; i++)
+                {
+                    entry = g_ptr_array_index(cell, i);
+                    d2 = (x - entry->x) * (x - entry->x) +
+                        (y - entry->y) * (y - entry->y);
+                    if (d2 <= best)
+                    {
+                        best = d2;
+                        catnum = entry->catnum;
+                    }
+                }
+            }
+        }
+    }
+
+    return catnum;
+}
+
+/**
+ * Check whether a point is inside a polygon.
+ *
+ * @param coords The (x,y) pairs of the polygon; it is closed implicitly.
+ * @param num The number of points.
+ * @param x The x coordinate of the point.
+ * @param y The y coordinate of the point.
+ *
+ * This is the even-odd rule: a ray from the point crosses the edges an odd
+ * number of times if the point is inside.
+ */
+gboolean hit_grid_in_polygon(const gdouble * coords, guint num,
+                             gdouble x, gdouble y)
+{
+    gboolean        inside = FALSE;
+    gdouble         xi, yi, xj, yj;
+    guint           i, j;
+
+    if (num < 3)
+        return FALSE;
+
+    for (i = 0, j = num - 1; i < num; j = i++)
+    {
+        xi = coords[2 * i];
+        yi = coords[2 * i + 1];
+        xj = coords[2 * j];
+        yj = coords[2 * j + 1];
+
+        if (((yi > y) != (yj > y)) &&
+            (x < (xj - xi) * (y - yi) / (yj - yi) + xi))
+            inside = !inside;
+    }
+
+    return inside;
+}
+
+/** Get the cell column of an X coordinate. */
+static guint cell_col(hit_grid_t * grid, gdouble x)
+{
+    if (x <= 0.0)
+        return 0;
+
+    return MIN((guint) (x / grid->cell), grid->cols - 1);
+}
+
+/** Get the cell row of a Y coordinate. */
+static guint cell_row(hit_grid_t * grid, gdouble y)
+{
+    if (y <= 0.0)
+        return 0;
+
+    return MIN((guint) (y / grid->cell), grid->rows - 1);
+}
+
+static void alloc_cells(hit_grid_t * grid)
+{
+    guint           i;
+
+    grid->cells = g_new(GPtrArray *, grid->cols * grid->rows);
+    for (i = 0; i < grid->cols * grid->rows; i++)
+        grid->cells[i] = g_ptr_array_new();
+}
+
+static void free_cells(hit_grid_t * grid)
+{
+    guint           i;
+
+    for (i = 0; i < grid->cols * grid->rows; i++)
+        g_ptr_array_free(grid->cells[i], TRUE);
+
+    g_free(grid->cells);
+    grid->cells = NULL;
+}
+
+/** Add an entry to the cells covered by its box. */
+static void bin_entry(hit_grid_t * grid, hit_entry_t * entry)
+{
+    guint           c, r;
+
+    entry->col1 = cell_col(grid, entry->box.x1);
+    entry->row1 = cell_row(grid, entry->box.y1);
+    entry->col2 = cell_col(grid, entry->box.x2);
+    entry->row2 = cell_row(grid, entry->box.y2);
+
+    for (r = entry->row1; r <= entry->row2; r++)
+        for (c = entry->col1; c <= entry->col2; c++)
+            g_ptr_array_add(grid->cells[r * grid->cols + c], entry);
+}
+
+/** Remove an entry from the cells it has been added to. */
+static void unbin_entry(hit_grid_t * grid, hit_entry_t * entry)
+{
+    guint           c, r;
+
+    for (r = entry->row1; r <= entry->row2; r++)
+        for (c = entry->col1; c <= entry->col2; c++)
+            g_ptr_array_remove_fast(grid->cells[r * grid->cols + c], entry);
+}
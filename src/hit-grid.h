@@ -0,0 +1,88 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef HIT_GRID_H
+#define HIT_GRID_H 1
+
+#include <glib.h>
+#include <goocanvas.h>
+
+/** Default size of the grid cells in pixels. */
+#define HIT_GRID_CELL 32
+
+/** A satellite in the hit grid. */
+typedef struct {
+    gint            catnum;     /*!< Catalogue number of the satellite. */
+    gdouble         x;          /*!< X coordinate of the satellite. */
+    gdouble         y;          /*!< Y coordinate of the satellite. */
+    GooCanvasBounds box;        /*!< Area that belongs to the satellite. */
+    guint           col1;       /*!< First cell column covered by box. */
+    guint           row1;       /*!< First cell row covered by box. */
+    guint           col2;       /*!< Last cell column covered by box. */
+    guint           row2;       /*!< Last cell row covered by box. */
+} hit_entry_t;
+
+/**
+ * Uniform grid of satellite positions on a canvas.
+ *
+ * Each cell lists the entries whose box overlaps the cell, so finding the
+ * satellite under the mouse pointer only needs to look at one cell.
+ */
+typedef struct {
+    gdouble         cell;       /*!< Size of the cells in pixels. */
+    guint           cols;       /*!< Number of cell columns. */
+    guint           rows;       /*!< Number of cell rows. */
+    GPtrArray     **cells;      /*!< Entries in each cell, row by row. */
+    GHashTable     *entries;    /*!< The hit_entry_t of each satellite by catnum. */
+} hit_grid_t;
+
+/**
+ * Check whether a point really hits a satellite.
+ *
+ * @param catnum The catalogue number of the satellite.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param data User data passed to hit_grid_pick().
+ * @return TRUE if the point hits the satellite.
+ */
+typedef gboolean (*hit_test_func_t) (gint catnum, gdouble x, gdouble y,
+                                     gpointer data);
+
+hit_grid_t     *hit_grid_new(gdouble cell);
+void            hit_grid_free(hit_grid_t * grid);
+void            hit_grid_resize(hit_grid_t * grid, gdouble width,
+                                gdouble height);
+void            hit_grid_set(hit_grid_t * grid, gint catnum, gdouble x,
+                             gdouble y, const GooCanvasBounds * box);
+void            hit_grid_remove(hit_grid_t * grid, gint catnum);
+gint            hit_grid_pick(hit_grid_t * grid, gdouble x, gdouble y,
+                              hit_test_func_t test, gpointer data);
+gint            hit_grid_nearest(hit_grid_t * grid, gdouble x, gdouble y,
+                                 gdouble maxdist);
+gboolean        hit_grid_in_polygon(const gdouble * coords, guint num,
+                                    gdouble x, gdouble y);
+
+#endif
@@ -35,6 +35,8 @@
 #include "first-time.h"
 #include "tle-update.h"
 #include "mod-mgr.h"
+#include "night-scan.h"
+#include "pass-cache.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 
@@ -51,6 +53,9 @@ static gboolean cleantrsp = FALSE;
 /* Start application in fullscreen mode */
 static gboolean fullscreen = FALSE;
 
+/* Print the visible passes of tonight and exit */
+static gboolean vistonight = FALSE;
+
 /* Command line options. */
 static GOptionEntry entries[] = {
     {"clean-tle", 0, 0, G_OPTION_ARG_NONE, &cleantle,
@@ -59,6 +64,9 @@ static GOptionEntry entries[] = {
      "Clean the transponder data in user's configuration directory", NULL},
     {"fullscreen", 0, 0, G_OPTION_ARG_NONE, &fullscreen,
      "Start gpredict in fullscreen mode.", NULL},
+    {"visible-tonight", 0, 0, G_OPTION_ARG_NONE, &vistonight,
+     "Print the passes that can be seen with the naked eye tonight and exit",
+     NULL},
     {NULL}
 };
 
@@ -98,6 +106,7 @@ int main(int argc, char *argv[])
     GError         *err = NULL;
     GOptionContext *context;
     guint           error = 0;
+    gboolean        gui;
 
 
 #ifdef ENABLE_NLS
@@ -105,7 +114,8 @@ int main(int argc, char *argv[])
     bind_textdomain_codeset(PACKAGE, "UTF-8");
     textdomain(PACKAGE);
 #endif
-    gtk_init(&argc, &argv);
+    /* the display is not needed for --visible-tonight */
+    gui = gtk_init_check(&argc, &argv);
 
     context = g_option_context_new("");
     g_option_context_add_main_entries(context, entries, GETTEXT_PACKAGE);
@@ -114,7 +124,7 @@ int main(int argc, char *argv[])
                                    "tracking and orbit prediction program.\n"
                                    "Gpredict does not require any command line "
                                    "options for nominal operation."));
-    g_option_context_add_group(context, gtk_get_option_group(TRUE));
+    g_option_context_add_group(context, gtk_get_option_group(gui));
     if (!g_option_context_parse(context, &argc, &argv, &err))
         g_print(_("Option parsing failed: %s\n"), err->message);
 
@@ -141,6 +151,24 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (vistonight)
+    {
+        error = night_scan_run();
+
+        g_option_context_free(context);
+        pass_cache_free();
+        sat_log_close();
+        sat_cfg_close();
+
+        return error;
+    }
+
+    if (!gui)
+    {
+        g_printerr(_("Cannot open display\n"));
+        return 1;
+    }
+
     /* create application */
     gpredict_app_create();
     gtk_widget_show_all(app);
@@ -161,6 +189,7 @@ int main(int argc, char *argv[])
 
     g_option_context_free(context);
 
+    pass_cache_free();
     sat_cfg_save();
     sat_log_close();
     sat_cfg_close();
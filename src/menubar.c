@@ -33,6 +33,7 @@
 #include "menubar.h"
 #include "mod-cfg.h"
 #include "mod-mgr.h"
+#include "night-scan-dialog.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sat-log-browser.h"
@@ -469,6 +470,14 @@ static void menubar_message_log(GtkWidget * widget, gpointer data)
     sat_log_browser_open();
 }
 
+static void menubar_night_scan_cb(GtkWidget * widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    night_scan_dialog_open();
+}
+
 static void menubar_app_exit_cb(GtkWidget * widget, gpointer data)
 {
     (void)widget;
@@ -870,6 +879,11 @@ static void create_file_menu_items(GtkMenuShell * menu,
                                GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
     gtk_menu_shell_append(menu, menu_item);
 
+    menu_item = gtk_menu_item_new_with_mnemonic(_("_Visible tonight"));
+    g_signal_connect(menu_item, "activate", G_CALLBACK(menubar_night_scan_cb),
+                     NULL);
+    gtk_menu_shell_append(menu, menu_item);
+
     menu_item = gtk_separator_menu_item_new();
     gtk_menu_shell_append(menu, menu_item);
 
@@ -597,6 +597,17 @@ void mod_mgr_reload_sats()
     }
 }
 
+/*
+ * Get the open modules, docked and undocked.
+ *
+ * The list is owned by the module manager and must not be modified or
+ * freed. It is only valid until a module is added or removed.
+ */
+GSList         *mod_mgr_get_modules()
+{
+    return modules;
+}
+
 static void create_module_window(GtkWidget * module)
 {
     gint            w, h;
@@ -9,5 +9,6 @@ gboolean        mod_mgr_mod_is_visible(GtkWidget * module);
 gint            mod_mgr_dock_module(GtkWidget * module);
 gint            mod_mgr_undock_module(GtkWidget * module);
 void            mod_mgr_reload_sats(void);
+GSList         *mod_mgr_get_modules(void);
 
 #endif
@@ -0,0 +1,238 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file night-scan-dialog.c
+ * \brief Dialog showing the visible passes of tonight, see night-scan.c.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+
+#include "night-scan.h"
+#include "night-scan-dialog.h"
+#include "sat-cfg.h"
+#include "time-tools.h"
+
+
+/* columns in the pass list */
+typedef enum {
+    NIGHT_LIST_COL_NAME = 0,
+    NIGHT_LIST_COL_CATNUM,
+    NIGHT_LIST_COL_AOS,
+    NIGHT_LIST_COL_VSTART,
+    NIGHT_LIST_COL_VEND,
+    NIGHT_LIST_COL_LOS,
+    NIGHT_LIST_COL_MAXEL,
+    NIGHT_LIST_COL_NUMBER
+} night_list_col_t;
+
+const gchar    *NIGHT_LIST_COL_TITLE[NIGHT_LIST_COL_NUMBER] = {
+    N_("Satellite"),
+    N_("Catnum"),
+    N_("AOS"),
+    N_("Visible from"),
+    N_("Visible to"),
+    N_("LOS"),
+    N_("Max El")
+};
+
+extern GtkWidget *app;
+
+/** \brief Data of an open dialog. */
+typedef struct {
+    GtkWidget      *label;      /*!< Summary above the list */
+    GtkListStore   *store;      /*!< The passes */
+    night_scan_t   *scan;       /*!< The running scan or NULL */
+} night_dialog_t;
+
+
+/** \brief Fill the list when the scan is done. */
+static void night_dialog_done(const night_scan_result_t * res, gpointer data)
+{
+    night_dialog_t *nd = data;
+    night_pass_t   *row;
+    GtkTreeIter     item;
+    gchar          *fmtstr, *text;
+    gchar           aos[TIME_FORMAT_MAX_LENGTH];
+    gchar           vstart[TIME_FORMAT_MAX_LENGTH];
+    gchar           vend[TIME_FORMAT_MAX_LENGTH];
+    gchar           los[TIME_FORMAT_MAX_LENGTH];
+    gchar           maxel[8];
+    guint           i;
+
+    nd->scan = NULL;
+
+    if (res->dark_start == 0.0)
+    {
+        gtk_label_set_text(GTK_LABEL(nd->label),
+                           _("No night in the next 24 hours"));
+        return;
+    }
+
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+
+    for (i = 0; i < res->passes->len; i++)
+    {
+        row = g_ptr_array_index(res->passes, i);
+
+        daynum_to_str(aos, TIME_FORMAT_MAX_LENGTH, fmtstr, row->pass->aos);
+        daynum_to_str(vstart, TIME_FORMAT_MAX_LENGTH, fmtstr, row->start);
+        daynum_to_str(vend, TIME_FORMAT_MAX_LENGTH, fmtstr, row->end);
+        daynum_to_str(los, TIME_FORMAT_MAX_LENGTH, fmtstr, row->pass->los);
+        g_snprintf(maxel, sizeof(maxel), "%.1f", row->pass->max_el);
+
+        gtk_list_store_append(nd->store, &item);
+        gtk_list_store_set(nd->store, &item,
+                           NIGHT_LIST_COL_NAME, row->pass->satname,
+                           NIGHT_LIST_COL_CATNUM, row->catnum,
+                           NIGHT_LIST_COL_AOS, aos,
+                           NIGHT_LIST_COL_VSTART, vstart,
+                           NIGHT_LIST_COL_VEND, vend,
+                           NIGHT_LIST_COL_LOS, los,
+                           NIGHT_LIST_COL_MAXEL, maxel, -1);
+    }
+
+    daynum_to_str(vstart, TIME_FORMAT_MAX_LENGTH, fmtstr, res->dark_start);
+    daynum_to_str(vend, TIME_FORMAT_MAX_LENGTH, fmtstr, res->dark_end);
+    text = g_strdup_printf(_("Night: %s - %s\n"
+                             "%d visible passes (%d of %d satellites "
+                             "searched)"),
+                           vstart, vend, res->passes->len,
+                           res->num_searched, res->num_sats);
+    gtk_label_set_text(GTK_LABEL(nd->label), text);
+
+    g_free(text);
+    g_free(fmtstr);
+}
+
+/** \brief Stop the scan if it is still running and free the data. */
+static void night_dialog_destroy(GtkWidget * widget, gpointer data)
+{
+    night_dialog_t *nd = data;
+
+    (void)widget;
+
+    if (nd->scan != NULL)
+        night_scan_cancel(nd->scan);
+
+    g_object_unref(nd->store);
+    g_free(nd);
+}
+
+/** \brief Create the list of passes. */
+static GtkWidget *night_dialog_create_list(night_dialog_t * nd)
+{
+    GtkWidget      *treeview;
+    GtkWidget      *swin;
+    GtkCellRenderer *renderer;
+    GtkTreeViewColumn *column;
+    guint           i;
+
+    nd->store = gtk_list_store_new(NIGHT_LIST_COL_NUMBER, G_TYPE_STRING,
+                                   G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
+                                   G_TYPE_STRING, G_TYPE_STRING,
+                                   G_TYPE_STRING);
+
+    treeview = gtk_tree_view_new_with_model(GTK_TREE_MODEL(nd->store));
+
+    for (i = 0; i < NIGHT_LIST_COL_NUMBER; i++)
+    {
+        renderer = gtk_cell_renderer_text_new();
+        column =
+            gtk_tree_view_column_new_with_attributes(_(NIGHT_LIST_COL_TITLE[i]),
+                                                     renderer, "text", i,
+                                                     NULL);
+        gtk_tree_view_insert_column(GTK_TREE_VIEW(treeview), column, -1);
+    }
+
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(swin), treeview);
+
+    return swin;
+}
+
+/**
+ * \brief Open a dialog with the visible passes of tonight.
+ *
+ * The whole catalog is scanned for the default QTH. The dialog is shown
+ * right away and the list is filled when the scan is done.
+ */
+void night_scan_dialog_open(void)
+{
+    night_dialog_t *nd = g_new0(night_dialog_t, 1);
+    GtkWidget      *dialog;
+    GtkWidget      *vbox;
+    GPtrArray      *sats;
+    qth_t          *qth;
+    gchar          *text;
+
+    vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 5);
+
+    nd->label = gtk_label_new(NULL);
+    g_object_set(nd->label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), nd->label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), night_dialog_create_list(nd),
+                       TRUE, TRUE, 0);
+
+    qth = night_scan_load_qth();
+    text = g_strdup_printf(_("Visible passes tonight: %s"), qth->name);
+    dialog = gtk_dialog_new_with_buttons(text,
+                                         GTK_WINDOW(app),
+                                         GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Close", GTK_RESPONSE_CLOSE,
+                                         NULL);
+    g_free(text);
+
+    gtk_window_set_default_size(GTK_WINDOW(dialog), 800, 400);
+    gtk_box_pack_start(GTK_BOX
+                       (gtk_dialog_get_content_area(GTK_DIALOG(dialog))),
+                       vbox, TRUE, TRUE, 0);
+
+    g_signal_connect_swapped(dialog, "response",
+                             G_CALLBACK(gtk_widget_destroy), dialog);
+    g_signal_connect(dialog, "destroy", G_CALLBACK(night_dialog_destroy),
+                     nd);
+
+    sats = night_scan_load_catalog(qth);
+    text = g_strdup_printf(_("Searching %d satellites..."), sats->len);
+    gtk_label_set_text(GTK_LABEL(nd->label), text);
+    g_free(text);
+
+    nd->scan = night_scan_start(sats, qth, get_current_daynum(),
+                                night_dialog_done, nd);
+    qth_data_free(qth);
+
+    gtk_widget_show_all(dialog);
+}
@@ -0,0 +1,531 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file night-scan.c
+ * \brief Find the passes that can be seen with the naked eye tonight.
+ *
+ * The scan covers the whole satellite catalog in the user's satdata
+ * directory, i.e. several thousand objects, so predicting all their
+ * passes is out of the question. It is done in three steps:
+ *
+ * 1. The night is found from the elevation of the sun at the QTH, i.e.
+ *    the next interval where the sun is below the twilight threshold.
+ *
+ * 2. Satellites that can never be seen during the night are dropped using
+ *    their orbits only: objects that never get above the minimum
+ *    elevation (less a small margin) at the latitude of the QTH, see
+ *    has_aos_above(), and objects too low to be in sunlight while the sky
+ *    is dark, see can_be_sunlit(). This takes no propagation at all.
+ *
+ * 3. The remaining satellites are predicted on the worker threads of
+ *    predict-jobs.c, searching only the night and keeping the passes with
+ *    a visible window.
+ *
+ * The result is a table sorted by the start of the visible part of each
+ * pass. It is shown by night-scan-dialog.c and printed by the
+ * --visible-tonight command line option, see night_scan_run().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compat.h"
+#include "gtk-sat-data.h"
+#include "night-scan.h"
+#include "orbit-tools.h"
+#include "predict-jobs.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "solar-cache.h"
+#include "time-tools.h"
+
+
+/** \brief How far ahead to look for the night [days]. */
+#define NIGHT_SCAN_MAXDT 1.0
+
+/** \brief Time step for the sun elevation [days]. */
+#define NIGHT_SCAN_STEP (10.0 / 1440.0)
+
+/** \brief Elevation margin for has_aos_above() [deg]. */
+#define NIGHT_SCAN_EL_MARGIN 2.0
+
+/** \brief Accuracy of the start and end of the night [days]. */
+#define NIGHT_SCAN_TOL (1.0 / 86400.0)
+
+struct _night_scan {
+    GPtrArray      *sats;       /*!< The catalog (sat_t) */
+    pred_batch_t   *batch;      /*!< Prediction jobs of the survivors */
+    night_scan_result_t res;    /*!< The result */
+    night_scan_done_fn done;    /*!< Called when the scan is done */
+    gpointer        data;       /*!< User data for done */
+};
+
+
+/** \brief Get the elevation of the sun above the twilight threshold. */
+static gdouble sun_margin(const obs_frame_t * frame, gdouble t,
+                          gdouble twilight)
+{
+    vector_t        sun;
+
+    solar_cache_pos(t, &sun);
+
+    return solar_cache_el(t, &sun, frame) - twilight;
+}
+
+/**
+ * \brief Find where the sun crosses the twilight threshold.
+ * \param t0 Time before the crossing.
+ * \param t1 Time after the crossing.
+ * \param dark TRUE if the sun is below the threshold at t0.
+ */
+static gdouble sun_crossing(const obs_frame_t * frame, gdouble t0,
+                            gdouble t1, gdouble twilight, gboolean dark)
+{
+    gdouble         t;
+
+    while (t1 - t0 > NIGHT_SCAN_TOL)
+    {
+        t = 0.5 * (t0 + t1);
+        if ((sun_margin(frame, t, twilight) < 0.0) == dark)
+            t0 = t;
+        else
+            t1 = t;
+    }
+
+    return 0.5 * (t0 + t1);
+}
+
+/**
+ * \brief Find the next night.
+ * \param qth The QTH.
+ * \param start The time to start looking (Julian date).
+ * \param maxdt How far to look ahead [days].
+ * \param twilight Sun elevation below which it is night [deg].
+ * \param dark_start The start of the night, start if it is night already.
+ * \param dark_end The end of the night, at most dark_start + maxdt.
+ * \return TRUE if the night starts before start + maxdt.
+ *
+ * The sun elevation is sampled every NIGHT_SCAN_STEP, so a night or day
+ * shorter than that, which only happens near the poles, may be missed.
+ */
+gboolean night_scan_find_dark(qth_t * qth, gdouble start, gdouble maxdt,
+                              gdouble twilight, gdouble * dark_start,
+                              gdouble * dark_end)
+{
+    obs_frame_t     frame;
+    gdouble         t, tend;
+
+    predict_obs_frame(&frame, qth);
+
+    /* the start of the night */
+    t = start;
+    tend = start + maxdt;
+    if (sun_margin(&frame, t, twilight) >= 0.0)
+    {
+        do
+        {
+            t += NIGHT_SCAN_STEP;
+            if (t > tend)
+                return FALSE;
+        }
+        while (sun_margin(&frame, t, twilight) >= 0.0);
+
+        t = sun_crossing(&frame, t - NIGHT_SCAN_STEP, t, twilight, FALSE);
+    }
+    *dark_start = t;
+
+    /* and its end */
+    tend = *dark_start + maxdt;
+    do
+    {
+        t += NIGHT_SCAN_STEP;
+        if (t >= tend)
+        {
+            *dark_end = tend;
+            return TRUE;
+        }
+    }
+    while (sun_margin(&frame, t, twilight) < 0.0);
+
+    *dark_end = sun_crossing(&frame, t - NIGHT_SCAN_STEP, t, twilight, TRUE);
+
+    return TRUE;
+}
+
+/**
+ * \brief Load the satellite catalog.
+ * \param qth The QTH used to initialise the satellites.
+ * \return The satellites (sat_t) in the user's satdata directory.
+ *
+ * Satellites with bad TLE data are left out. The array frees the
+ * satellites when it is freed.
+ */
+GPtrArray      *night_scan_load_catalog(qth_t * qth)
+{
+    GPtrArray      *sats;
+    GDir           *dir;
+    gchar          *dirname;
+    const gchar    *filename;
+    sat_t          *sat;
+    gint            catnum;
+
+    sats = g_ptr_array_new_with_free_func((GDestroyNotify)
+                                          gtk_sat_data_free_sat);
+
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to open %s"),
+                    __func__, dirname);
+        g_free(dirname);
+        return sats;
+    }
+
+    while ((filename = g_dir_read_name(dir)))
+    {
+        if (!g_str_has_suffix(filename, ".sat"))
+            continue;
+
+        catnum = atoi(filename);
+        sat = g_new0(sat_t, 1);
+        if (gtk_sat_data_read_sat(catnum, sat))
+        {
+            gtk_sat_data_free_sat(sat);
+            continue;
+        }
+
+        gtk_sat_data_init_sat(sat, qth);
+        g_ptr_array_add(sats, sat);
+    }
+
+    g_dir_close(dir);
+    g_free(dirname);
+
+    return sats;
+}
+
+/** \brief Free a row of the result. */
+static void night_pass_free(gpointer data)
+{
+    night_pass_t   *row = data;
+
+    free_pass(row->pass);
+    g_free(row);
+}
+
+/** \brief Compare two rows by the start of the visible part. */
+static gint night_pass_compare(gconstpointer a, gconstpointer b)
+{
+    const night_pass_t *pa = *(night_pass_t * const *)a;
+    const night_pass_t *pb = *(night_pass_t * const *)b;
+
+    if (pa->start < pb->start)
+        return -1;
+    if (pa->start > pb->start)
+        return 1;
+
+    return pa->catnum - pb->catnum;
+}
+
+/** \brief Add the visible passes of a job to the result. */
+static void night_scan_add_job(night_scan_t * scan, pred_job_t * job)
+{
+    night_pass_t   *row;
+    GSList         *node;
+    pass_t         *pass;
+    guint           i;
+
+    for (node = job->passes; node != NULL; node = node->next)
+    {
+        pass = node->data;
+
+        row = g_new0(night_pass_t, 1);
+        row->catnum = job->sat->tle.catnr;
+        row->pass = pass;
+        row->start = 0.0;
+        row->end = 0.0;
+
+        for (i = 0; i < pass->num_windows; i++)
+        {
+            if (pass->windows[i].vis != SAT_VIS_VISIBLE)
+                continue;
+
+            if (row->start == 0.0)
+                row->start = pass->windows[i].start;
+            row->end = pass->windows[i].end;
+        }
+
+        g_ptr_array_add(scan->res.passes, row);
+    }
+
+    /* the rows own the passes now */
+    g_slist_free(job->passes);
+    job->passes = NULL;
+}
+
+/** \brief Free a scan and the catalog. */
+static void night_scan_free(night_scan_t * scan)
+{
+    g_ptr_array_free(scan->res.passes, TRUE);
+    g_ptr_array_free(scan->sats, TRUE);
+    g_free(scan);
+}
+
+/** \brief Collect the results when all jobs are done. */
+static void night_scan_done(GPtrArray * jobs, gpointer data)
+{
+    night_scan_t   *scan = data;
+    guint           i;
+
+    for (i = 0; i < jobs->len; i++)
+        night_scan_add_job(scan, g_ptr_array_index(jobs, i));
+
+    g_ptr_array_sort(scan->res.passes, night_pass_compare);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Found %d visible passes of %d satellites"),
+                __func__, scan->res.passes->len, scan->res.num_searched);
+
+    if (scan->done != NULL)
+        scan->done(&scan->res, scan->data);
+
+    night_scan_free(scan);
+}
+
+/**
+ * \brief Start scanning for visible passes.
+ * \param sats The satellites, see night_scan_load_catalog(). The scan
+ *             takes ownership of the array.
+ * \param qth The QTH; only used during this call.
+ * \param start The time to start looking for the night (Julian date).
+ * \param done Function to call in the main loop with the result.
+ * \param data User data for done.
+ * \return The scan.
+ *
+ * The passes are predicted on worker threads. The scan is freed after
+ * done has returned; it can be stopped with night_scan_cancel() until
+ * then. If there is no night in the next 24 hours, done is called with
+ * no passes and dark_start set to 0.0.
+ */
+night_scan_t   *night_scan_start(GPtrArray * sats, qth_t * qth,
+                                 gdouble start, night_scan_done_fn done,
+                                 gpointer data)
+{
+    night_scan_t   *scan = g_new0(night_scan_t, 1);
+    pass_cfg_t      cfg;
+    sat_t          *sat;
+    guint           i;
+
+    scan->sats = sats;
+    scan->done = done;
+    scan->data = data;
+    scan->res.num_sats = sats->len;
+    scan->res.passes = g_ptr_array_new_with_free_func(night_pass_free);
+    scan->batch = pred_batch_new(qth, night_scan_done, scan);
+
+    pass_cfg_load(&cfg);
+    if (night_scan_find_dark(qth, start, NIGHT_SCAN_MAXDT, cfg.twilight,
+                             &scan->res.dark_start, &scan->res.dark_end))
+    {
+        for (i = 0; i < sats->len; i++)
+        {
+            sat = g_ptr_array_index(sats, i);
+
+            if (!has_aos_above(sat, qth, scan->res.dark_start,
+                               cfg.min_el - NIGHT_SCAN_EL_MARGIN) ||
+                !can_be_sunlit(sat, cfg.twilight))
+                continue;
+
+            pred_batch_add(scan->batch, PRED_JOB_VISIBLE, sat,
+                           scan->res.dark_start,
+                           scan->res.dark_end - scan->res.dark_start, 0);
+            scan->res.num_searched++;
+        }
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Searching %d of %d satellites between %f and %f"),
+                __func__, scan->res.num_searched, scan->res.num_sats,
+                scan->res.dark_start, scan->res.dark_end);
+
+    pred_batch_submit(scan->batch);
+
+    return scan;
+}
+
+/**
+ * \brief Stop a night scan.
+ * \param scan The scan; it must not be used after this call.
+ */
+void night_scan_cancel(night_scan_t * scan)
+{
+    pred_batch_cancel(scan->batch);
+    night_scan_free(scan);
+}
+
+/**
+ * \brief Format the result of a night scan as a text table.
+ * \param res The result.
+ * \return A newly allocated string.
+ */
+gchar          *night_scan_to_text(const night_scan_result_t * res)
+{
+    GString        *text;
+    gchar          *fmtstr;
+    gchar           aos[TIME_FORMAT_MAX_LENGTH];
+    gchar           vstart[TIME_FORMAT_MAX_LENGTH];
+    gchar           vend[TIME_FORMAT_MAX_LENGTH];
+    gchar           los[TIME_FORMAT_MAX_LENGTH];
+    night_pass_t   *row;
+    guint           i;
+
+    text = g_string_new(NULL);
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+
+    if (res->dark_start == 0.0)
+    {
+        g_string_append(text, _("No night in the next 24 hours\n"));
+        g_free(fmtstr);
+        return g_string_free(text, FALSE);
+    }
+
+    daynum_to_str(vstart, TIME_FORMAT_MAX_LENGTH, fmtstr, res->dark_start);
+    daynum_to_str(vend, TIME_FORMAT_MAX_LENGTH, fmtstr, res->dark_end);
+    g_string_append_printf(text, _("Night: %s - %s\n"), vstart, vend);
+    g_string_append_printf(text,
+                           _("Visible passes: %d (%d of %d satellites "
+                             "searched)\n\n"),
+                           res->passes->len, res->num_searched,
+                           res->num_sats);
+    g_string_append_printf(text, "%-6s %-24s %-20s %-20s %-20s %-20s %6s\n",
+                           _("Catnum"), _("Satellite"), _("AOS"),
+                           _("Visible from"), _("Visible to"), _("LOS"),
+                           _("Max El"));
+
+    for (i = 0; i < res->passes->len; i++)
+    {
+        row = g_ptr_array_index(res->passes, i);
+
+        daynum_to_str(aos, TIME_FORMAT_MAX_LENGTH, fmtstr, row->pass->aos);
+        daynum_to_str(vstart, TIME_FORMAT_MAX_LENGTH, fmtstr, row->start);
+        daynum_to_str(vend, TIME_FORMAT_MAX_LENGTH, fmtstr, row->end);
+        daynum_to_str(los, TIME_FORMAT_MAX_LENGTH, fmtstr, row->pass->los);
+
+        g_string_append_printf(text,
+                               "%-6d %-24s %-20s %-20s %-20s %-20s %6.1f\n",
+                               row->catnum, row->pass->satname, aos, vstart,
+                               vend, los, row->pass->max_el);
+    }
+
+    g_free(fmtstr);
+
+    return g_string_free(text, FALSE);
+}
+
+/**
+ * \brief Load the default QTH.
+ * \return The QTH, free it with qth_data_free().
+ */
+qth_t          *night_scan_load_qth(void)
+{
+    qth_t          *qth = g_new0(qth_t, 1);
+    gchar          *confdir, *buffer, *qthfile;
+
+    buffer = sat_cfg_get_str(SAT_CFG_STR_DEF_QTH);
+    confdir = get_user_conf_dir();
+    qthfile = g_strconcat(confdir, G_DIR_SEPARATOR_S, buffer, NULL);
+
+    if (!qth_data_read(qthfile, qth))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Can not load default QTH file %s; "
+                      "using built-in defaults"), __func__, buffer);
+        qth_safe(qth);
+    }
+
+    g_free(qthfile);
+    g_free(confdir);
+    g_free(buffer);
+
+    return qth;
+}
+
+/** \brief Print the result and stop the main loop of night_scan_run(). */
+static void night_scan_run_done(const night_scan_result_t * res,
+                                gpointer data)
+{
+    gchar          *text;
+
+    text = night_scan_to_text(res);
+    g_print("%s", text);
+    g_free(text);
+
+    g_main_loop_quit((GMainLoop *) data);
+}
+
+/**
+ * \brief Print the visible passes of tonight for the default QTH.
+ * \return The exit status for main().
+ *
+ * This is the --visible-tonight command line option; it needs neither a
+ * display nor a module. The configuration must have been loaded.
+ */
+gint night_scan_run(void)
+{
+    GMainLoop      *loop;
+    GPtrArray      *sats;
+    qth_t          *qth;
+
+    qth = night_scan_load_qth();
+    sats = night_scan_load_catalog(qth);
+    if (sats->len == 0)
+    {
+        g_printerr(_("No satellites found\n"));
+        g_ptr_array_free(sats, TRUE);
+        qth_data_free(qth);
+        return 1;
+    }
+
+    loop = g_main_loop_new(NULL, FALSE);
+    night_scan_start(sats, qth, get_current_daynum(),
+                     night_scan_run_done, loop);
+    qth_data_free(qth);
+
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef NIGHT_SCAN_H
+#define NIGHT_SCAN_H 1
+
+#include <glib.h>
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief A visible pass found by the night scan. */
+typedef struct {
+    gint        catnum;   /*!< Catalog number of the satellite */
+    pass_t     *pass;     /*!< The pass, owned by the row */
+    gdouble     start;    /*!< Start of the first visible window */
+    gdouble     end;      /*!< End of the last visible window */
+} night_pass_t;
+
+/** \brief Result of a night scan, see night_scan_start(). */
+typedef struct {
+    gdouble     dark_start;   /*!< Start of the night, 0.0 if none */
+    gdouble     dark_end;     /*!< End of the night, 0.0 if none */
+    guint       num_sats;     /*!< Satellites in the catalog */
+    guint       num_searched; /*!< Satellites left after the orbit checks */
+    GPtrArray  *passes;       /*!< Visible passes (night_pass_t) by start */
+} night_scan_result_t;
+
+/** \brief A running night scan. */
+typedef struct _night_scan night_scan_t;
+
+/**
+ * \brief Callback for a finished night scan.
+ * \param res The result; valid until the callback returns.
+ * \param data The user data given to night_scan_start().
+ */
+typedef void    (*night_scan_done_fn) (const night_scan_result_t * res,
+                                       gpointer data);
+
+qth_t          *night_scan_load_qth(void);
+GPtrArray      *night_scan_load_catalog(qth_t * qth);
+gboolean        night_scan_find_dark(qth_t * qth, gdouble start,
+                                     gdouble maxdt, gdouble twilight,
+                                     gdouble * dark_start,
+                                     gdouble * dark_end);
+night_scan_t   *night_scan_start(GPtrArray * sats, qth_t * qth,
+                                 gdouble start, night_scan_done_fn done,
+                                 gpointer data);
+void            night_scan_cancel(night_scan_t * scan);
+gchar          *night_scan_to_text(const night_scan_result_t * res);
+gint            night_scan_run(void);
+
+#endif
@@ -113,13 +113,56 @@ decayed        (sat_t *sat)
     /* tle.xndt2o/(twopi/xmnpda/xmnpda) is the value before converted the 
         value matches up with the value in predict 2.2.3 */
 
+     return decayed_at (sat, sat->jul_utc);
+}
+
+
+/** \brief Determine whether satellite has decayed at a given time.
+ *  \param sat Pointer to satellite data.
+ *  \param t The time (Julian date).
+ *  \return TRUE if the satellite appears to have decayed, FALSE otherwise.
+ *
+ * Same as decayed() but uses t instead of sat->jul_utc.
+ */
+gboolean
+decayed_at     (const sat_t *sat, gdouble t)
+{
      if (sat->jul_epoch + ((16.666666 - sat->meanmo) / 
-                           (10.0 * fabs (sat->tle.xndt2o/(twopi/xmnpda/xmnpda)))) < sat->jul_utc)
+                           (10.0 * fabs (sat->tle.xndt2o/(twopi/xmnpda/xmnpda)))) < t)
           return TRUE;
      else
           return FALSE;
+}
 
 
+/** \brief Find the time when an orbit starts.
+ *  \param sat Pointer to satellite data.
+ *  \param orbit The orbit number.
+ *  \return The time (Julian date) when the orbit number of the satellite
+ *          becomes orbit.
+ *
+ * The orbit number is counted from the epoch using the mean motion and the
+ * drag term of the element set, see predict_calc_detail(), so the start of
+ * an orbit is the root of a quadratic in the time since epoch. This gives
+ * the same orbit numbers as the SGP4/SDP4 driver without searching.
+ */
+gdouble
+orbit_start    (const sat_t *sat, long orbit)
+{
+     double revs, drag, orbit0, k, disc;
+
+     revs = sat->tle.xno * xmnpda / twopi;
+     drag = sat->tle.bstar * ae;
+     orbit0 = (sat->tle.xmo + sat->tle.omegao) / twopi;
+
+     /* solve (revs + drag * age) * age = k for the age */
+     k = (double) (orbit - sat->tle.revnum) + floor(orbit0) - orbit0;
+     disc = revs * revs + 4.0 * drag * k;
+
+     if (disc <= 0.0 || revs + sqrt(disc) <= 0.0)
+          return sat->jul_epoch + k / revs;
+
+     return sat->jul_epoch + 2.0 * k / (revs + sqrt(disc));
 }
 
 
@@ -132,6 +175,43 @@ decayed        (sat_t *sat)
  */
 gboolean
 has_aos        (sat_t *sat, qth_t *qth)
+{
+     return has_aos_at (sat, qth, sat->jul_utc);
+}
+
+
+/** \brief Determine whether satellite ever reaches AOS.
+ *  \param sat Pointer to satellite data.
+ *  \param qth Pointer to the QTH data.
+ *  \param t The time used for the decay check (Julian date).
+ *  \return TRUE if the satellite will reach AOS, FALSE otherwise.
+ *
+ * Same as has_aos() but uses t instead of sat->jul_utc.
+ */
+gboolean
+has_aos_at     (const sat_t *sat, qth_t *qth, gdouble t)
+{
+     return has_aos_above (sat, qth, t, 0.0);
+}
+
+
+/** \brief Determine whether satellite ever reaches a given elevation.
+ *  \param sat Pointer to satellite data.
+ *  \param qth Pointer to the QTH data.
+ *  \param t The time used for the decay check (Julian date).
+ *  \param el The elevation [deg], 0.0 for AOS.
+ *  \return TRUE if the satellite may reach el, FALSE if it never does.
+ *
+ * Same as has_aos_at() but the satellite must be seen at least el above
+ * the horizon. The test is done at apogee, where the area seen from the
+ * satellite is largest, so TRUE does not mean that the elevation is ever
+ * reached. The earth is taken as a sphere and the orbit as a fixed
+ * ellipse, which can make the result wrong when the highest elevation is
+ * within about a degree of el; callers that use this to skip satellites
+ * should lower el a bit.
+ */
+gboolean
+has_aos_above  (const sat_t *sat, qth_t *qth, gdouble t, gdouble el)
 {
      double lin, sma, apogee;
      gboolean retcode = FALSE;
@@ -143,7 +223,7 @@ has_aos        (sat_t *sat, qth_t *qth)
        station keeping that are tracing a figure 8.
      */
 
-     if ((sat->otype == ORBIT_TYPE_GEO) || (decayed(sat))) {
+     if ((sat->otype == ORBIT_TYPE_GEO) || (decayed_at(sat, t))) {
          retcode = FALSE;
      } else {
 
@@ -160,7 +240,11 @@ has_aos        (sat_t *sat, qth_t *qth)
              sma = 331.25 * exp(log(1440.0/sat->meanmo) * (2.0/3.0));
              apogee = sma * (1.0 + sat->tle.eo) - xkmper;
              
-             if ((acos(xkmper/(apogee+xkmper))+(lin)) > fabs(qth->lat*de2ra))
+             /* angle at the centre of the earth between the sub-satellite
+                point and the edge of the area seen above el */
+             el *= de2ra;
+             if ((acos(xkmper*cos(el)/(apogee+xkmper))-el+(lin)) >
+                 fabs(qth->lat*de2ra))
                  retcode = TRUE;
              else
                  retcode = FALSE;
@@ -169,3 +253,32 @@ has_aos        (sat_t *sat, qth_t *qth)
      }
      return retcode;
 }
+
+
+/** \brief Determine whether satellite can be in sunlight after dusk.
+ *  \param sat Pointer to satellite data.
+ *  \param sun_el The highest elevation of the sun at the QTH [deg].
+ *  \return TRUE if the satellite may be sunlit while it is above the
+ *          horizon, FALSE if it is always in the shadow of the earth.
+ *
+ * When the sun is d below the horizon, the lowest sunlit point above the
+ * horizon is in the direction of the sun, and it is in the shadow unless
+ * it is higher than R(1/cos(d/2)-1). A satellite whose apogee is below
+ * that can never be seen against a dark sky.
+ */
+gboolean
+can_be_sunlit  (const sat_t *sat, gdouble sun_el)
+{
+     double sma, apogee;
+
+     if (sun_el >= 0.0)
+          return TRUE;
+
+     if (sat->meanmo == 0.0)
+          return FALSE;
+
+     sma = 331.25 * exp(log(1440.0/sat->meanmo) * (2.0/3.0));
+     apogee = sma * (1.0 + sat->tle.eo) - xkmper;
+
+     return (apogee > xkmper * (1.0/cos(-0.5*sun_el*de2ra) - 1.0));
+}
@@ -35,7 +35,13 @@
 orbit_type_t get_orbit_type (sat_t *sat);
 gboolean     geostationary  (sat_t *sat);
 gboolean     decayed        (sat_t *sat);
+gboolean     decayed_at     (const sat_t *sat, gdouble t);
+gdouble      orbit_start    (const sat_t *sat, long orbit);
 gboolean     has_aos        (sat_t *sat, qth_t *qth);
+gboolean     has_aos_at     (const sat_t *sat, qth_t *qth, gdouble t);
+gboolean     has_aos_above  (const sat_t *sat, qth_t *qth, gdouble t,
+                             gdouble el);
+gboolean     can_be_sunlit  (const sat_t *sat, gdouble sun_el);
 
 
 #endif
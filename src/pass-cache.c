@@ -0,0 +1,369 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file pass-cache.c
+ * \brief Process-wide cache of predicted passes.
+ *
+ * The same passes are predicted over and over by the sky at a glance, the
+ * event list, the pass popups and the radio and rotator controllers. The
+ * pass predictors in predict-tools.c therefore keep the passes they have
+ * found here and look them up before predicting.
+ *
+ * A pass is stored together with everything it depends on: the catalog
+ * number, epoch and element set number of the TLE, the QTH position and
+ * the prediction settings, and the nickname, which is copied into it. New
+ * elements or a QTH that has moved will therefore never match the old
+ * passes. The passes of a satellite are also dropped when tle-update.c
+ * installs new elements for it, and the passes for a QTH position when a
+ * module moves away from it.
+ *
+ * The events found by the predictor do not depend on where the search
+ * started, so a pass predicted from time t is the answer for any start
+ * time between t and its LOS, with the usual AOS time limit. This is the
+ * interval that is checked on lookup, and the cached pass is identical to
+ * what a new prediction would give. Deep-space passes are not cached:
+ * SDP4 results depend slightly on the call history, so they would not be.
+ *
+ * The least recently used passes are dropped when the cache grows beyond
+ * PASS_CACHE_MAX_SIZE. The cache is locked, so it can be used from the
+ * prediction worker threads.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "orbit-tools.h"
+#include "pass-cache.h"
+#include "sat-log.h"
+
+
+/** \brief Approximate memory budget of the cache [bytes]. */
+#define PASS_CACHE_MAX_SIZE (4 * 1024 * 1024)
+
+/** \brief Cached pass and the data it was predicted from. */
+typedef struct {
+    gint            catnr;      /*!< Catalog number */
+    gdouble         epoch;      /*!< TLE epoch */
+    gint            elset;      /*!< Element set number */
+    qth_small_t     qth;        /*!< QTH position */
+    pass_cfg_t      cfg;        /*!< Prediction settings */
+    gdouble         from;       /*!< Earliest start time giving this pass */
+    pass_t         *pass;       /*!< The pass */
+    gsize           size;       /*!< Approximate memory used [bytes] */
+    GList           lru;        /*!< Link in the LRU queue */
+} pass_cache_entry_t;
+
+G_LOCK_DEFINE_STATIC(pass_cache);
+
+/* entries per catalog number (GList of pass_cache_entry_t) */
+static GHashTable *entries = NULL;
+
+/* all entries, most recently used first */
+static GQueue   lru = G_QUEUE_INIT;
+
+static gsize    size = 0;
+static guint    hits = 0;
+static guint    misses = 0;
+
+
+/** \brief Check whether an entry was predicted from the same data. */
+static gboolean entry_matches(const pass_cache_entry_t * entry,
+                              const sat_t * sat, qth_t * qth,
+                              const pass_cfg_t * cfg)
+{
+    return (entry->epoch == sat->tle.epoch &&
+            entry->elset == sat->tle.elset &&
+            g_strcmp0(entry->pass->satname, sat->nickname) == 0 &&
+            entry->qth.lat == qth->lat &&
+            entry->qth.lon == qth->lon &&
+            entry->qth.alt == qth->alt &&
+            entry->cfg.min_el == cfg->min_el &&
+            entry->cfg.tres == cfg->tres &&
+            entry->cfg.num_entries == cfg->num_entries &&
+            entry->cfg.twilight == cfg->twilight);
+}
+
+/** \brief Remove an entry from the cache and free it. Lock must be held. */
+static void entry_remove(pass_cache_entry_t * entry)
+{
+    GList          *list;
+
+    list = g_hash_table_lookup(entries, GINT_TO_POINTER(entry->catnr));
+    list = g_list_remove(list, entry);
+    if (list != NULL)
+        g_hash_table_insert(entries, GINT_TO_POINTER(entry->catnr), list);
+    else
+        g_hash_table_remove(entries, GINT_TO_POINTER(entry->catnr));
+
+    g_queue_unlink(&lru, &entry->lru);
+    size -= entry->size;
+
+    free_pass(entry->pass);
+    g_free(entry);
+}
+
+/** \brief Make an entry the most recently used. Lock must be held. */
+static void entry_touch(pass_cache_entry_t * entry)
+{
+    g_queue_unlink(&lru, &entry->lru);
+    g_queue_push_head_link(&lru, &entry->lru);
+}
+
+/**
+ * \brief Look up a pass in the cache.
+ * \param sat The satellite.
+ * \param qth The ground station.
+ * \param cfg The prediction settings.
+ * \param start The start time of the prediction.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param pass Set to a copy of the cached pass on success, which should
+ *             be freed with free_pass().
+ * \return TRUE if the pass was found, FALSE if it must be predicted.
+ *
+ * The pass is the one get_pass() would return for the same arguments.
+ */
+gboolean pass_cache_lookup(const sat_t * sat, qth_t * qth,
+                           const pass_cfg_t * cfg, gdouble start,
+                           gdouble maxdt, pass_t ** pass)
+{
+    pass_cache_entry_t *entry;
+    GList          *node;
+    gboolean        found = FALSE;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        return FALSE;
+
+    /* the predictor gives up on decayed satellites */
+    if (!has_aos_at(sat, qth, start))
+        return FALSE;
+
+    G_LOCK(pass_cache);
+
+    if (entries != NULL)
+    {
+        node = g_hash_table_lookup(entries, GINT_TO_POINTER(sat->tle.catnr));
+        for (; node != NULL; node = node->next)
+        {
+            entry = node->data;
+            if (entry_matches(entry, sat, qth, cfg) &&
+                start >= entry->from && start < entry->pass->los &&
+                (maxdt <= 0.0 || entry->pass->aos <= start + maxdt))
+            {
+                *pass = copy_pass(entry->pass);
+                found = (*pass != NULL);
+                if (found)
+                    entry_touch(entry);
+                break;
+            }
+        }
+    }
+
+    if (found)
+        hits++;
+    else
+        misses++;
+
+    G_UNLOCK(pass_cache);
+
+    return found;
+}
+
+/**
+ * \brief Store a predicted pass in the cache.
+ * \param sat The satellite.
+ * \param qth The ground station.
+ * \param cfg The prediction settings.
+ * \param start The start time the pass was predicted from.
+ * \param pass The pass; the cache keeps a copy.
+ */
+void pass_cache_insert(const sat_t * sat, qth_t * qth,
+                       const pass_cfg_t * cfg, gdouble start, pass_t * pass)
+{
+    pass_cache_entry_t *entry;
+    GList          *list, *node;
+    pass_t         *copy;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        return;
+
+    G_LOCK(pass_cache);
+
+    if (entries == NULL)
+        entries = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    list = g_hash_table_lookup(entries, GINT_TO_POINTER(sat->tle.catnr));
+
+    /* same pass predicted from an earlier time? */
+    for (node = list; node != NULL; node = node->next)
+    {
+        entry = node->data;
+        if (entry_matches(entry, sat, qth, cfg) &&
+            entry->pass->aos == pass->aos)
+        {
+            entry->from = MIN(entry->from, start);
+            entry_touch(entry);
+            G_UNLOCK(pass_cache);
+            return;
+        }
+    }
+
+    copy = copy_pass(pass);
+    if (copy == NULL)
+    {
+        G_UNLOCK(pass_cache);
+        return;
+    }
+
+    entry = g_new0(pass_cache_entry_t, 1);
+    entry->catnr = sat->tle.catnr;
+    entry->epoch = sat->tle.epoch;
+    entry->elset = sat->tle.elset;
+    qth_small_save(qth, &entry->qth);
+    entry->cfg = *cfg;
+    entry->from = MIN(start, pass->aos);
+    entry->pass = copy;
+    entry->size = sizeof(pass_cache_entry_t) + sizeof(pass_t) +
+        copy->num_details * sizeof(pass_detail_t) +
+        copy->num_windows * sizeof(vis_window_t);
+    if (copy->satname != NULL)
+        entry->size += strlen(copy->satname) + 1;
+    entry->lru.data = entry;
+
+    list = g_list_prepend(list, entry);
+    g_hash_table_insert(entries, GINT_TO_POINTER(entry->catnr), list);
+    g_queue_push_head_link(&lru, &entry->lru);
+    size += entry->size;
+
+    /* keep within the budget, but always keep the new pass */
+    while (size > PASS_CACHE_MAX_SIZE && lru.tail != &entry->lru)
+        entry_remove(lru.tail->data);
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Drop the cached passes of a satellite.
+ * \param catnr The catalog number of the satellite.
+ *
+ * This should be called when the satellite gets new elements. It is not
+ * needed for correctness, since the passes are tied to the old elements,
+ * but it frees the memory right away.
+ */
+void pass_cache_invalidate(gint catnr)
+{
+    GList          *list;
+
+    G_LOCK(pass_cache);
+
+    if (entries != NULL)
+    {
+        while ((list = g_hash_table_lookup(entries,
+                                           GINT_TO_POINTER(catnr))) != NULL)
+            entry_remove(list->data);
+    }
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Drop the cached passes predicted for a QTH position.
+ * \param qth The position the passes were predicted for.
+ *
+ * This should be called when a module QTH moves or is replaced. As with
+ * pass_cache_invalidate(), the passes would never match the new position,
+ * but this frees the memory right away.
+ */
+void pass_cache_invalidate_qth(const qth_small_t * qth)
+{
+    pass_cache_entry_t *entry;
+    GList          *node, *next;
+
+    G_LOCK(pass_cache);
+
+    for (node = lru.head; node != NULL; node = next)
+    {
+        next = node->next;
+        entry = node->data;
+        if (entry->qth.lat == qth->lat && entry->qth.lon == qth->lon &&
+            entry->qth.alt == qth->alt)
+            entry_remove(entry);
+    }
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Get the cache statistics.
+ * \param stats The statistics to fill in.
+ *
+ * The hits and misses are counted from the start of gpredict. They are
+ * shown on the Module Timing page of the preferences.
+ */
+void pass_cache_get_stats(pass_cache_stats_t * stats)
+{
+    G_LOCK(pass_cache);
+
+    stats->hits = hits;
+    stats->misses = misses;
+    stats->entries = lru.length;
+    stats->size = size;
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Free the cache.
+ *
+ * The statistics are logged before the passes are dropped. This should
+ * be called when gpredict exits.
+ */
+void pass_cache_free(void)
+{
+    pass_cache_stats_t stats;
+
+    pass_cache_get_stats(&stats);
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %u hits, %u misses, %u passes (%u kB) in cache"),
+                __func__, stats.hits, stats.misses, stats.entries,
+                (guint) (stats.size / 1024));
+
+    G_LOCK(pass_cache);
+    while (lru.tail != NULL)
+        entry_remove(lru.tail->data);
+    if (entries != NULL)
+    {
+        g_hash_table_destroy(entries);
+        entries = NULL;
+    }
+    G_UNLOCK(pass_cache);
+}
@@ -0,0 +1,55 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PASS_CACHE_H
+#define PASS_CACHE_H 1
+
+#include <glib.h>
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Pass cache statistics, see pass_cache_get_stats(). */
+typedef struct {
+    guint       hits;       /*!< Lookups answered from the cache */
+    guint       misses;     /*!< Lookups that needed a prediction */
+    guint       entries;    /*!< Number of cached passes */
+    gsize       size;       /*!< Approximate memory used [bytes] */
+} pass_cache_stats_t;
+
+gboolean        pass_cache_lookup(const sat_t * sat, qth_t * qth,
+                                  const pass_cfg_t * cfg, gdouble start,
+                                  gdouble maxdt, pass_t ** pass);
+void            pass_cache_insert(const sat_t * sat, qth_t * qth,
+                                  const pass_cfg_t * cfg, gdouble start,
+                                  pass_t * pass);
+void            pass_cache_invalidate(gint catnr);
+void            pass_cache_invalidate_qth(const qth_small_t * qth);
+void            pass_cache_get_stats(pass_cache_stats_t * stats);
+void            pass_cache_free(void);
+
+#endif
@@ -251,13 +251,13 @@ gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
     daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
 
     /* get number of rows */
-    num = g_slist_length(pass->details);
+    num = pass->num_details;
 
     for (i = 0; i < num; i++)
     {
 
         /* get detail */
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+        detail = &pass->details[i];
 
         /* time */
         daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, detail->time);
@@ -0,0 +1,402 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file predict-jobs.c
+ * \brief Pass predictions on worker threads.
+ *
+ * Views that need predictions for many satellites at once, e.g. the sky at
+ * a glance, the event refresh of a module or the ground tracks of the
+ * map, collect the work in a batch
+ * of jobs. The jobs are run in parallel by a thread pool with one thread
+ * per processor and the results are delivered to the main loop in an idle
+ * callback once the whole batch is done.
+ *
+ * The workers never touch the satellites, the QTH or the configuration of
+ * the caller: each job gets a copy of the satellite and the batch gets a
+ * copy of the QTH position and the prediction settings when it is created.
+ * A batch can therefore be cancelled at any time, e.g. when the view is
+ * destroyed, and the caller does not need to wait for the workers. After
+ * pred_batch_cancel() the done callback is not called and the batch is
+ * freed as soon as the running jobs have finished.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "orbit-tools.h"
+#include "predict-jobs.h"
+#include "predict-tools.h"
+#include "sat-log.h"
+
+
+/** \brief Job with the data only used by the workers. */
+typedef struct {
+    pred_job_t      job;        /*!< Public part, must be first */
+    pred_batch_t   *batch;      /*!< The batch the job belongs to */
+    sat_t           sat;        /*!< Copy of the satellite */
+} pred_job_priv_t;
+
+struct _pred_batch {
+    GPtrArray      *jobs;       /*!< The jobs (pred_job_priv_t) */
+    qth_t           qth;        /*!< Copy of the QTH position */
+    pass_cfg_t      cfg;        /*!< Prediction settings */
+    pred_batch_done_fn done;    /*!< Called when all jobs are done */
+    gpointer        data;       /*!< User data for done */
+    gboolean        submitted;  /*!< Set by pred_batch_submit() */
+    gint            pending;    /*!< Number of jobs not yet done */
+    gint            cancelled;  /*!< Set by pred_batch_cancel() */
+};
+
+static GThreadPool *pool = NULL;
+
+
+/** \brief Free a job and its results. */
+static void pred_job_free(gpointer data)
+{
+    pred_job_priv_t *priv = data;
+
+    if (priv->job.passes != NULL)
+        free_passes(priv->job.passes);
+
+    g_free(priv->job.track);
+
+    g_free(priv->sat.nickname);
+    g_free(priv);
+}
+
+/** \brief Free a batch and its jobs. */
+static void pred_batch_free(pred_batch_t * batch)
+{
+    g_ptr_array_free(batch->jobs, TRUE);
+    g_free(batch);
+}
+
+/**
+ * \brief Deliver the results of a batch in the main loop.
+ *
+ * This is an idle callback added by the worker which finished the last job
+ * of the batch.
+ */
+static gboolean pred_batch_done_idle(gpointer data)
+{
+    pred_batch_t   *batch = data;
+
+    if (!g_atomic_int_get(&batch->cancelled) && batch->done != NULL)
+        batch->done(batch->jobs, batch->data);
+
+    pred_batch_free(batch);
+
+    return FALSE;
+}
+
+/** \brief Calculate the next AOS and LOS like find_aos() and find_los(). */
+static void pred_job_events(pred_job_priv_t * priv, qth_t * qth)
+{
+    pred_job_t     *job = &priv->job;
+    pass_events_t   ev;
+
+    if (!find_events(&priv->sat, qth, job->start, job->maxdt, &ev))
+    {
+        job->aos = 0.0;
+        job->los = 0.0;
+        return;
+    }
+
+    job->los = ev.los;
+
+    /* pass in progress; we want the AOS of the next one */
+    if (ev.aos > job->start)
+        job->aos = ev.aos;
+    else
+        job->aos = find_aos(&priv->sat, qth, job->start, job->maxdt);
+}
+
+/**
+ * \brief Calculate the passes that can be seen with the naked eye.
+ *
+ * Same as PRED_JOB_PASSES, but passes without a visible window are
+ * dropped. The number of passes applies before the filtering.
+ */
+static void pred_job_visible(pred_job_priv_t * priv, qth_t * qth,
+                             const pass_cfg_t * cfg)
+{
+    pred_job_t     *job = &priv->job;
+    GSList         *passes, *node, *next;
+    pass_t         *pass;
+
+    passes = get_passes_cfg(&priv->sat, qth, job->start, job->maxdt,
+                            job->num, cfg);
+
+    for (node = passes; node != NULL; node = next)
+    {
+        next = node->next;
+        pass = node->data;
+
+        if (pass->vis[0] != 'V')
+        {
+            free_pass(pass);
+            passes = g_slist_delete_link(passes, node);
+        }
+    }
+
+    job->passes = passes;
+}
+
+/**
+ * \brief Calculate the sub-satellite points of a ground track.
+ *
+ * Each orbit runs from orbit_start() of the orbit to that of the next one
+ * with a point every PRED_TRACK_STEP. The track ends where the satellite
+ * decays, and no more orbits are calculated once the batch is cancelled.
+ */
+static void pred_job_track(pred_job_priv_t * priv, qth_t * qth)
+{
+    pred_job_t     *job = &priv->job;
+    sat_work_t      work;
+    sat_series_t    out = { 0 };
+    sat_series_t   *track;
+    gdouble         t0, t1;
+    guint           total = 0;
+    guint           i, j, n;
+    long            orbit;
+
+    for (i = 0; i < job->num; i++)
+    {
+        t0 = orbit_start(&priv->sat, job->orbit + i);
+        t1 = orbit_start(&priv->sat, job->orbit + i + 1);
+        if (t1 > t0)
+            total += (guint) ceil((t1 - t0) / PRED_TRACK_STEP);
+    }
+
+    /* one block; the arrays follow the structure */
+    track = g_malloc0(sizeof(sat_series_t) +
+                      total * (2 * sizeof(gdouble) + sizeof(gint)));
+    track->lat = (gdouble *) (track + 1);
+    track->lon = track->lat + total;
+    track->orbit = (gint *) (track->lon + total);
+    job->track = track;
+    job->track_len = 0;
+
+    predict_work_init(&work, &priv->sat);
+
+    for (i = 0; i < job->num; i++)
+    {
+        if (g_atomic_int_get(&priv->batch->cancelled))
+            return;
+
+        orbit = job->orbit + i;
+        t0 = orbit_start(&priv->sat, orbit);
+        t1 = orbit_start(&priv->sat, orbit + 1);
+        if (t1 <= t0)
+            return;
+
+        n = MIN((guint) ceil((t1 - t0) / PRED_TRACK_STEP),
+                total - job->track_len);
+        out.lat = track->lat + job->track_len;
+        out.lon = track->lon + job->track_len;
+        predict_calc_series(&work, qth, t0, PRED_TRACK_STEP, n, &out);
+
+        for (j = 0; j < n; j++)
+        {
+            if (decayed_at(&priv->sat, t0 + j * PRED_TRACK_STEP))
+                return;
+
+            track->orbit[job->track_len++] = orbit;
+        }
+    }
+}
+
+/** \brief Run a job; this is the thread pool function. */
+static void pred_job_run(gpointer data, gpointer user_data)
+{
+    pred_job_priv_t *priv = data;
+    pred_batch_t   *batch = priv->batch;
+
+    (void)user_data;
+
+    if (!g_atomic_int_get(&batch->cancelled))
+    {
+        switch (priv->job.type)
+        {
+        case PRED_JOB_PASSES:
+            priv->job.passes = get_passes_cfg(&priv->sat, &batch->qth,
+                                              priv->job.start,
+                                              priv->job.maxdt,
+                                              priv->job.num, &batch->cfg);
+            break;
+
+        case PRED_JOB_EVENTS:
+            pred_job_events(priv, &batch->qth);
+            break;
+
+        case PRED_JOB_VISIBLE:
+            pred_job_visible(priv, &batch->qth, &batch->cfg);
+            break;
+
+        case PRED_JOB_TRACK:
+            pred_job_track(priv, &batch->qth);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (g_atomic_int_dec_and_test(&batch->pending))
+        g_idle_add(pred_batch_done_idle, batch);
+}
+
+/**
+ * \brief Create a new batch of prediction jobs.
+ * \param qth The ground station; only the position is used.
+ * \param done Function to call in the main loop when all jobs are done.
+ * \param data User data for done.
+ * \return The new batch.
+ *
+ * The prediction settings are read from the configuration here. Add jobs
+ * with pred_batch_add() and start them with pred_batch_submit(). The batch
+ * is freed after done has returned or after it has been cancelled.
+ */
+pred_batch_t   *pred_batch_new(qth_t * qth, pred_batch_done_fn done,
+                               gpointer data)
+{
+    pred_batch_t   *batch = g_new0(pred_batch_t, 1);
+
+    batch->jobs = g_ptr_array_new_with_free_func(pred_job_free);
+    batch->qth.lat = qth->lat;
+    batch->qth.lon = qth->lon;
+    batch->qth.alt = qth->alt;
+    pass_cfg_load(&batch->cfg);
+    batch->done = done;
+    batch->data = data;
+
+    return batch;
+}
+
+/**
+ * \brief Add a job to a batch.
+ * \param batch The batch, must not have been submitted yet.
+ * \param type The kind of prediction.
+ * \param sat The satellite.
+ * \param start The time where the prediction should start.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param num The number of passes for PRED_JOB_PASSES and PRED_JOB_VISIBLE
+ *            (0 = up to 100) or the number of orbits for PRED_JOB_TRACK.
+ * \return The job.
+ *
+ * The satellite is copied, so it may change or go away while the job
+ * runs. It must have been initialized with gtk_sat_data_init_sat().
+ */
+pred_job_t     *pred_batch_add(pred_batch_t * batch, pred_job_type_t type,
+                               sat_t * sat, gdouble start, gdouble maxdt,
+                               guint num)
+{
+    pred_job_priv_t *priv = g_new0(pred_job_priv_t, 1);
+
+    priv->batch = batch;
+    priv->job.type = type;
+    priv->job.sat = sat;
+    priv->job.start = start;
+    priv->job.maxdt = maxdt;
+    priv->job.num = num;
+
+    /* the strings are owned by the original; we only need the nickname */
+    priv->sat = *sat;
+    priv->sat.name = NULL;
+    priv->sat.website = NULL;
+    priv->sat.nickname = g_strdup(sat->nickname);
+
+    g_ptr_array_add(batch->jobs, priv);
+
+    return &priv->job;
+}
+
+/**
+ * \brief Start the jobs of a batch.
+ * \param batch The batch.
+ *
+ * The jobs are queued to the thread pool, which is created on first use.
+ * No jobs can be added after this.
+ */
+void pred_batch_submit(pred_batch_t * batch)
+{
+    GError         *err = NULL;
+    guint           i;
+
+    if (pool == NULL)
+    {
+        pool = g_thread_pool_new(pred_job_run, NULL,
+                                 MAX(g_get_num_processors(), 1), FALSE, &err);
+        if (pool == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create thread pool: %s"),
+                        __func__, err->message);
+            g_clear_error(&err);
+        }
+    }
+
+    batch->submitted = TRUE;
+    batch->pending = batch->jobs->len;
+
+    if (batch->jobs->len == 0)
+    {
+        g_idle_add(pred_batch_done_idle, batch);
+        return;
+    }
+
+    for (i = 0; i < batch->jobs->len; i++)
+    {
+        /* without a pool we can still do the work, just not in parallel */
+        if (pool == NULL ||
+            !g_thread_pool_push(pool, g_ptr_array_index(batch->jobs, i),
+                                NULL))
+            pred_job_run(g_ptr_array_index(batch->jobs, i), NULL);
+    }
+}
+
+/**
+ * \brief Cancel a batch.
+ * \param batch The batch.
+ *
+ * Jobs that have not started yet are skipped and the done callback is not
+ * called. The batch is freed when the running jobs have finished, or
+ * right away if it has not been submitted; the caller must not use it
+ * after this call.
+ */
+void pred_batch_cancel(pred_batch_t * batch)
+{
+    if (!batch->submitted)
+        pred_batch_free(batch);
+    else
+        g_atomic_int_set(&batch->cancelled, 1);
+}
@@ -0,0 +1,92 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PREDICT_JOBS_H
+#define PREDICT_JOBS_H 1
+
+#include <glib.h>
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Prediction job types. */
+typedef enum {
+    PRED_JOB_PASSES = 0,        /*!< Passes, see get_passes() */
+    PRED_JOB_EVENTS,            /*!< Next AOS and LOS, see find_aos() and find_los() */
+    PRED_JOB_VISIBLE,           /*!< Passes with a visible part, see get_passes() */
+    PRED_JOB_TRACK              /*!< Sub-satellite points of whole orbits, see orbit_start() */
+} pred_job_type_t;
+
+/** \brief Time between the points of PRED_JOB_TRACK [days], 30 sec. */
+#define PRED_TRACK_STEP 0.00035
+
+/**
+ * \brief Prediction job.
+ *
+ * The job is created by pred_batch_add() and is owned by the batch. The
+ * results are valid in the pred_batch_done_fn callback; the callback can
+ * take the passes or the track by setting passes or track to NULL.
+ */
+typedef struct {
+    pred_job_type_t type;
+    sat_t          *sat;        /*!< Satellite the job was added for; not used
+                                     by the workers, which use a copy */
+    gdouble         start;      /*!< Start time in "jul_utc" */
+    gdouble         maxdt;      /*!< Time limit in days (0.0 = no limit) */
+    guint           num;        /*!< Number of passes (PRED_JOB_PASSES and
+                                     PRED_JOB_VISIBLE) or orbits
+                                     (PRED_JOB_TRACK) */
+    long            orbit;      /*!< First orbit (PRED_JOB_TRACK), set by
+                                     the caller after pred_batch_add() */
+    GSList         *passes;     /*!< Result of PRED_JOB_PASSES and
+                                     PRED_JOB_VISIBLE */
+    gdouble         aos;        /*!< Next AOS (PRED_JOB_EVENTS), 0.0 = none */
+    gdouble         los;        /*!< Next LOS (PRED_JOB_EVENTS), 0.0 = none */
+    sat_series_t   *track;      /*!< Result of PRED_JOB_TRACK; only lat, lon
+                                     and orbit are set */
+    guint           track_len;  /*!< Number of points in track */
+} pred_job_t;
+
+/** \brief Batch of prediction jobs, see pred_batch_new(). */
+typedef struct _pred_batch pred_batch_t;
+
+/**
+ * \brief Callback for a finished batch.
+ * \param jobs The jobs (pred_job_t) in the order they were added.
+ * \param data The user data given to pred_batch_new().
+ */
+typedef void    (*pred_batch_done_fn) (GPtrArray * jobs, gpointer data);
+
+pred_batch_t   *pred_batch_new(qth_t * qth, pred_batch_done_fn done,
+                               gpointer data);
+pred_job_t     *pred_batch_add(pred_batch_t * batch, pred_job_type_t type,
+                               sat_t * sat, gdouble start, gdouble maxdt,
+                               guint num);
+void            pred_batch_submit(pred_batch_t * batch);
+void            pred_batch_cancel(pred_batch_t * batch);
+
+#endif
@@ -35,52 +35,184 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <string.h>
 
 #include "gtk-sat-data.h"
 #include "orbit-tools.h"
+#include "pass-cache.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
+#include "solar-cache.h"
 #include "time-tools.h"
 
-static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el);
+/* Accuracy of the AOS, TCA and LOS times [days] */
+#define EVENT_TIME_TOL        (0.01 / 86400.0)
+
+/* Number of coarse steps per orbit when bracketing events */
+#define EVENT_STEPS_PER_ORBIT 24
+
+/* Longest coarse step [days] */
+#define EVENT_MAX_STEP        (1.0 / 24.0)
+
+/* How far to search for events when there is no time limit [days] */
+#define EVENT_SCAN_LIMIT      30.0
+
+/* Where to start searching for the next pass after a LOS [days]. SDP4
+   results depend slightly on the call history, so we stay clear of the
+   LOS to be sure that the satellite is below the horizon. */
+#define EVENT_NEXT_PASS       (1.0 / xmnpda)
+
+/* Safety limit for the refinement iterations */
+#define EVENT_MAX_ITER        100
+
+/* Width of the fixed grid cells the events are finally refined in [days] */
+#define EVENT_GRID            (1.0 / 86400.0)
+
+/* Safety factor for the largest orbit radius and the largest angular rate
+   in event_bound_init(); covers the perturbations of the orbit */
+#define EVENT_BOUND_SLACK     1.1
+
+/* Drift of the satellite relative to the observer that is always
+   allowed for in event_bound_init(), as a fraction of its angular rate */
+#define EVENT_BOUND_DRIFT     0.02
+
+/* Safety margin for the largest angle between the satellite and the
+   observer at AOS; covers the flattening of the earth [rad] */
+#define EVENT_BOUND_MARGIN    (1.0 * de2ra)
+
+/** \brief Elevation and elevation rate at a given time. */
+typedef struct {
+    gdouble         t;          /*!< Time in "jul_utc" */
+    gdouble         el;         /*!< Elevation [rad] */
+    gdouble         rate;       /*!< Elevation rate [rad/day] */
+    gdouble         theta;      /*!< Angle between the satellite and the
+                                     observer seen from the centre of the
+                                     earth [rad] */
+} event_point_t;
+
+/** \brief How soon a satellite can rise, see event_bound_init(). */
+typedef struct {
+    gdouble         lambda;     /*!< Largest event_point_t::theta with the
+                                     satellite above the horizon [rad] */
+    gdouble         rate;       /*!< Largest rate of change of theta
+                                     [rad/day] */
+} event_bound_t;
+
+/** \brief Illumination of the satellite at a given time. */
+typedef struct {
+    gdouble         t;          /*!< Time in "jul_utc" */
+    gboolean        eclipsed;   /*!< Result of Sat_Eclipsed() */
+    gdouble         depth;      /*!< Eclipse depth [rad], > 0 in eclipse */
+    gdouble         sun;        /*!< Sun elevation above twilight [deg] */
+} vis_point_t;
+
+/** \brief State of the visibility window search. */
+typedef struct {
+    sat_work_t     *work;       /*!< The satellite */
+    obs_frame_t     frame;      /*!< Observer frame of the QTH */
+    gdouble         twilight;   /*!< Twilight threshold [deg] */
+    vis_window_t    cur;        /*!< The current window, end not yet set */
+    GArray         *windows;    /*!< The completed windows */
+} vis_search_t;
+
+static void     predict_calc_el_theta(sat_work_t * work,
+                                      const obs_frame_t * frame, gdouble t,
+                                      gdouble * el, gdouble * rate,
+                                      gdouble * theta);
+static gboolean find_events_work(sat_work_t * work, qth_t * qth,
+                                 gdouble start, gdouble tend, gboolean back,
+                                 pass_events_t * ev);
+static gdouble  find_aos_work(sat_work_t * work, qth_t * qth, gdouble start,
+                              gdouble maxdt);
+static gdouble  find_los_work(sat_work_t * work, qth_t * qth, gdouble start,
+                              gdouble maxdt);
+static gdouble  find_prev_aos_work(sat_work_t * work, qth_t * qth,
+                                   gdouble start);
+static pass_t  *get_pass_engine(sat_work_t * work, qth_t * qth, gdouble start,
+                                gdouble maxdt, const pass_cfg_t * cfg);
+static pass_t  *get_pass_cached(sat_work_t * work, qth_t * qth, gdouble start,
+                                gdouble maxdt, const pass_cfg_t * cfg);
+static pass_t  *pass_new(guint num_details, guint num_windows,
+                         const gchar * satname);
 
 /**
- * \brief SGP4SDP4 driver for doing AOS/LOS calculations.
- * \param sat Pointer to the satellite data.
+ * \brief Set up the observer frame for a QTH.
+ * \param frame The frame to initialize.
  * \param qth Pointer to the QTH data.
- * \param t The time for calculation (Julian Date)
+ *
+ * The frame holds the time independent part of the observer position and
+ * is used by predict_calc_el() and predict_obs_context().
  */
-void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
+void predict_obs_frame(obs_frame_t * frame, qth_t * qth)
 {
-    obs_set_t       obs_set;
-    geodetic_t      sat_geodetic;
     geodetic_t      obs_geodetic;
-    double          age;
 
     obs_geodetic.lon = qth->lon * de2ra;
     obs_geodetic.lat = qth->lat * de2ra;
     obs_geodetic.alt = qth->alt / 1000.0;
     obs_geodetic.theta = 0;
 
-    sat->jul_utc = t;
-    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+    Obs_Frame_Init(&obs_geodetic, frame);
+}
 
-    /* call the norad routines according to the deep-space flag */
-    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
-        SDP4(sat, sat->tsince);
-    else
-        SGP4(sat, sat->tsince);
+/**
+ * \brief Set up the observation context for a given time.
+ * \param ctx The context to initialize.
+ * \param qth Pointer to the QTH data.
+ * \param t The time (Julian Date)
+ *
+ * The context holds the sidereal time, the observer position and the
+ * topocentric rotation at t. It is calculated once and then used for all
+ * satellites calculated for that time, see predict_calc_ctx().
+ */
+void predict_obs_context(obs_ctx_t * ctx, qth_t * qth, gdouble t)
+{
+    obs_frame_t     frame;
+
+    predict_obs_frame(&frame, qth);
+    Obs_Context_Init(t, &frame, ctx);
+}
+
+/**
+ * \brief Calculate observer dependent data from raw SGP4/SDP4 output.
+ * \param sat Pointer to the satellite data, only the elements are used.
+ * \param ctx The observation context for d->time.
+ * \param d Pointer to the satellite data to update.
+ *
+ * d->time, d->pos, d->vel and d->phase must have been set from the
+ * SGP4/SDP4 output before calling this function. The other fields of d
+ * except the visibility are calculated here.
+ */
+static void predict_calc_detail(const sat_t * sat, const obs_ctx_t * ctx,
+                                pass_detail_t * d)
+{
+    Convert_Sat_State(&d->pos, &d->vel);
+    predict_calc_state(sat, ctx, d);
+}
 
-    Convert_Sat_State(&sat->pos, &sat->vel);
+/**
+ * \brief Calculate observer dependent data from a satellite state.
+ * \param sat Pointer to the satellite data, only the elements are used.
+ * \param ctx The observation context for d->time.
+ * \param d Pointer to the satellite data to update.
+ *
+ * Like predict_calc_detail() but d->pos and d->vel are in km and km/s,
+ * e.g. from an earlier calculation. d->phase is still in radians.
+ */
+void predict_calc_state(const sat_t * sat, const obs_ctx_t * ctx,
+                        pass_detail_t * d)
+{
+    obs_set_t       obs_set;
+    geodetic_t      sat_geodetic;
+    double          age;
 
     /* get the velocity of the satellite */
-    Magnitude(&sat->vel);
-    sat->velo = sat->vel.w;
-    Calculate_Obs(sat->jul_utc, &sat->pos, &sat->vel, &obs_geodetic, &obs_set);
-    Calculate_LatLonAlt(sat->jul_utc, &sat->pos, &sat_geodetic);
+    Magnitude(&d->vel);
+    d->velo = d->vel.w;
+    Calculate_Obs_Context(ctx, &d->pos, &d->vel, &obs_set);
+    Calculate_LatLonAlt_Context(ctx, &d->pos, &sat_geodetic);
 
     while (sat_geodetic.lon < -pi)
         sat_geodetic.lon += twopi;
@@ -88,28 +220,871 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
     while (sat_geodetic.lon > (pi))
         sat_geodetic.lon -= twopi;
 
-    sat->az = Degrees(obs_set.az);
-    sat->el = Degrees(obs_set.el);
-    sat->range = obs_set.range;
-    sat->range_rate = obs_set.range_rate;
-    sat->ssplat = Degrees(sat_geodetic.lat);
-    sat->ssplon = Degrees(sat_geodetic.lon);
-    sat->alt = sat_geodetic.alt;
-    sat->ma = Degrees(sat->phase);
-    sat->ma *= 256.0 / 360.0;
-    sat->phase = Degrees(sat->phase);
+    d->az = Degrees(obs_set.az);
+    d->el = Degrees(obs_set.el);
+    d->range = obs_set.range;
+    d->range_rate = obs_set.range_rate;
+    d->lat = Degrees(sat_geodetic.lat);
+    d->lon = Degrees(sat_geodetic.lon);
+    d->alt = sat_geodetic.alt;
+    d->ma = Degrees(d->phase);
+    d->ma *= 256.0 / 360.0;
+    d->phase = Degrees(d->phase);
 
     /* same formulas, but the one from predict is nicer */
-    //sat->footprint = 2.0 * xkmper * acos (xkmper/sat->pos.w);
-    sat->footprint = 12756.33 * acos(xkmper / (xkmper + sat->alt));
-    age = sat->jul_utc - sat->jul_epoch;
-    sat->orbit = (long)floor((sat->tle.xno * xmnpda / twopi +
-                              age * sat->tle.bstar * ae) * age +
-                             (sat->tle.xmo + sat->tle.omegao) / twopi)
+    //d->footprint = 2.0 * xkmper * acos (xkmper/d->pos.w);
+    d->footprint = 12756.33 * acos(xkmper / (xkmper + d->alt));
+    age = d->time - sat->jul_epoch;
+    d->orbit = (long)floor((sat->tle.xno * xmnpda / twopi +
+                            age * sat->tle.bstar * ae) * age +
+                           (sat->tle.xmo + sat->tle.omegao) / twopi)
       - (long)floor((sat->tle.xmo + sat->tle.omegao) / twopi)
       + sat->tle.revnum ;
 }
 
+/**
+ * \brief Calculate observer dependent data from raw SGP4/SDP4 output.
+ * \param sat Pointer to the satellite data.
+ * \param ctx The observation context for sat->jul_utc.
+ *
+ * sat->jul_utc, sat->pos, sat->vel and sat->phase must have been set by
+ * SGP4/SDP4 before calling this function.
+ */
+void predict_calc_obs(sat_t * sat, const obs_ctx_t * ctx)
+{
+    pass_detail_t   d;
+
+    d.time = sat->jul_utc;
+    d.pos = sat->pos;
+    d.vel = sat->vel;
+    d.phase = sat->phase;
+
+    predict_calc_detail(sat, ctx, &d);
+
+    sat->pos = d.pos;
+    sat->vel = d.vel;
+    sat->velo = d.velo;
+    sat->az = d.az;
+    sat->el = d.el;
+    sat->range = d.range;
+    sat->range_rate = d.range_rate;
+    sat->ssplat = d.lat;
+    sat->ssplon = d.lon;
+    sat->alt = d.alt;
+    sat->ma = d.ma;
+    sat->phase = d.phase;
+    sat->footprint = d.footprint;
+    sat->orbit = d.orbit;
+}
+
+/**
+ * \brief SGP4SDP4 driver for doing AOS/LOS calculations.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param t The time for calculation (Julian Date)
+ */
+void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
+{
+    obs_ctx_t       ctx;
+
+    predict_obs_context(&ctx, qth, t);
+    predict_calc_ctx(sat, &ctx);
+}
+
+/**
+ * \brief SGP4SDP4 driver using a shared observation context.
+ * \param sat Pointer to the satellite data.
+ * \param ctx The observation context, see predict_obs_context(). The
+ *            satellite is calculated for the time of the context.
+ *
+ * Same as predict_calc(). Use this when many satellites are calculated
+ * for the same QTH and time.
+ */
+void predict_calc_ctx(sat_t * sat, const obs_ctx_t * ctx)
+{
+    sat->jul_utc = ctx->time;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+
+    /* call the norad routines according to the deep-space flag */
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4(sat, sat->tsince);
+    else
+        SGP4(sat, sat->tsince);
+
+    predict_calc_obs(sat, ctx);
+}
+
+/**
+ * \brief SGP4SDP4 driver using an ephemeris cache.
+ * \param sat Pointer to the satellite data.
+ * \param cache The ephemeris cache of the satellite or NULL.
+ * \param ctx The observation context, see predict_obs_context(). The
+ *            satellite is calculated for the time of the context.
+ *
+ * Same as predict_calc_ctx() but the raw position and velocity are taken
+ * from the ephemeris cache when possible, see sgpsdp/sgp_cheb.c. The
+ * result is within the tolerance of the cache. If cache is NULL this
+ * function is the same as predict_calc_ctx().
+ */
+void predict_calc_cached(sat_t * sat, ephem_cache_t * cache,
+                         const obs_ctx_t * ctx)
+{
+    if (cache == NULL)
+    {
+        predict_calc_ctx(sat, ctx);
+        return;
+    }
+
+    sat->jul_utc = ctx->time;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+
+    Ephem_Cache_Propagate(sat, cache, sat->tsince);
+
+    predict_calc_obs(sat, ctx);
+}
+
+/**
+ * \brief Initialize a working copy of a satellite.
+ * \param work The working copy to initialize.
+ * \param sat The satellite. It must have been initialized and is not
+ *            modified by any of the functions using the working copy.
+ *
+ * The propagator state is copied from sat so the working copy continues
+ * where the satellite is.
+ */
+void predict_work_init(sat_work_t * work, const sat_t * sat)
+{
+    work->sat = sat;
+    work->state = sat->state;
+    memset(&work->data, 0, sizeof(pass_detail_t));
+}
+
+/**
+ * \brief SGP4SDP4 driver for a working copy of a satellite.
+ * \param work The working copy of the satellite.
+ * \param qth Pointer to the QTH data.
+ * \param t The time for calculation (Julian Date)
+ *
+ * Same as predict_calc() but the result is stored in work->data and
+ * the satellite itself is not touched.
+ */
+void predict_calc_work(sat_work_t * work, qth_t * qth, gdouble t)
+{
+    const sat_t    *sat = work->sat;
+    obs_ctx_t       ctx;
+    gdouble         tsince;
+
+    tsince = (t - sat->jul_epoch) * xmnpda;
+
+    /* call the norad routines according to the deep-space flag */
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4_Eval(sat, &work->state, tsince);
+    else
+        SGP4_Eval(sat, &work->state, tsince);
+
+    work->data.time = t;
+    work->data.pos = work->state.pos;
+    work->data.vel = work->state.vel;
+    work->data.phase = work->state.phase;
+
+    predict_obs_context(&ctx, qth, t);
+    predict_calc_detail(sat, &ctx, &work->data);
+}
+
+/**
+ * \brief SGP4SDP4 driver for one satellite over a series of times.
+ * \param work The working copy of the satellite.
+ * \param qth Pointer to the QTH data.
+ * \param t0 The time of the first point (Julian Date)
+ * \param dt The time step in days.
+ * \param n The number of points to calculate.
+ * \param out The arrays where the results are stored.
+ *
+ * This function gives the same results as calling predict_calc_work() at
+ * t0, t0+dt, t0+2dt, ... with the time accumulated the same way as a
+ * "t += dt" loop would. The per satellite and per observer constants
+ * are only calculated once, and the data for the arrays in out that are
+ * NULL is skipped.
+ *
+ * work->state is left at the last point, work->data is not updated.
+ */
+void predict_calc_series(sat_work_t * work, qth_t * qth, gdouble t0,
+                         gdouble dt, guint n, sat_series_t * out)
+{
+    const sat_t    *sat = work->sat;
+    obs_set_t       obs_set;
+    geodetic_t      sat_geodetic;
+    obs_frame_t     frame;
+    obs_ctx_t       ctx;
+    vector_t        pos, vel;
+    gboolean        deep;
+    gboolean        need_obs;
+    gboolean        need_geo;
+    gdouble         revs, orbit0;
+    gdouble         t, age, alt;
+    guint           i;
+
+    predict_obs_frame(&frame, qth);
+
+    deep = (sat->flags & DEEP_SPACE_EPHEM_FLAG) ? TRUE : FALSE;
+    need_obs = out->az || out->el || out->range || out->range_rate;
+    need_geo = out->lat || out->lon || out->alt || out->footprint;
+
+    /* orbit number terms, see predict_calc_detail() */
+    revs = sat->tle.xno * xmnpda / twopi;
+    orbit0 = (sat->tle.xmo + sat->tle.omegao) / twopi;
+
+    for (i = 0, t = t0; i < n; i++, t += dt)
+    {
+        if (deep)
+            SDP4_Eval(sat, &work->state, (t - sat->jul_epoch) * xmnpda);
+        else
+            SGP4_Eval(sat, &work->state, (t - sat->jul_epoch) * xmnpda);
+
+        pos = work->state.pos;
+        vel = work->state.vel;
+        Convert_Sat_State(&pos, &vel);
+        Magnitude(&vel);
+
+        if (out->time)
+            out->time[i] = t;
+        if (out->pos)
+            out->pos[i] = pos;
+        if (out->vel)
+            out->vel[i] = vel;
+        if (out->velo)
+            out->velo[i] = vel.w;
+
+        if (need_obs || need_geo)
+            Obs_Context_Init(t, &frame, &ctx);
+
+        if (need_obs)
+        {
+            Calculate_Obs_Context(&ctx, &pos, &vel, &obs_set);
+            if (out->az)
+                out->az[i] = Degrees(obs_set.az);
+            if (out->el)
+                out->el[i] = Degrees(obs_set.el);
+            if (out->range)
+                out->range[i] = obs_set.range;
+            if (out->range_rate)
+                out->range_rate[i] = obs_set.range_rate;
+        }
+
+        if (need_geo)
+        {
+            Calculate_LatLonAlt_Context(&ctx, &pos, &sat_geodetic);
+
+            while (sat_geodetic.lon < -pi)
+                sat_geodetic.lon += twopi;
+
+            while (sat_geodetic.lon > (pi))
+                sat_geodetic.lon -= twopi;
+
+            alt = sat_geodetic.alt;
+            if (out->lat)
+                out->lat[i] = Degrees(sat_geodetic.lat);
+            if (out->lon)
+                out->lon[i] = Degrees(sat_geodetic.lon);
+            if (out->alt)
+                out->alt[i] = alt;
+            if (out->footprint)
+                out->footprint[i] = 12756.33 * acos(xkmper / (xkmper + alt));
+        }
+
+        if (out->ma)
+            out->ma[i] = Degrees(work->state.phase) * (256.0 / 360.0);
+        if (out->phase)
+            out->phase[i] = Degrees(work->state.phase);
+        if (out->orbit)
+        {
+            age = t - sat->jul_epoch;
+            out->orbit[i] = (long)floor((revs + age * sat->tle.bstar * ae) *
+                                        age + orbit0)
+                - (long)floor(orbit0) + sat->tle.revnum;
+        }
+    }
+}
+
+/**
+ * \brief Allocate a series with all arrays.
+ * \param n The number of points in each array.
+ * \return A newly allocated series that must be freed with
+ *         predict_series_free().
+ *
+ * Callers that only need a few of the arrays can also set up a
+ * sat_series_t of their own.
+ */
+sat_series_t   *predict_series_new(guint n)
+{
+    sat_series_t   *series;
+    gdouble        *d;
+
+    /* one block for everything; the arrays follow the structure */
+    series = g_malloc(sizeof(sat_series_t) + 2 * n * sizeof(vector_t) +
+                      12 * n * sizeof(gdouble) + n * sizeof(gint));
+
+    series->pos = (vector_t *) (series + 1);
+    series->vel = series->pos + n;
+    d = (gdouble *) (series->vel + n);
+    series->time = d;
+    series->velo = d + n;
+    series->az = d + 2 * n;
+    series->el = d + 3 * n;
+    series->range = d + 4 * n;
+    series->range_rate = d + 5 * n;
+    series->lat = d + 6 * n;
+    series->lon = d + 7 * n;
+    series->alt = d + 8 * n;
+    series->ma = d + 9 * n;
+    series->phase = d + 10 * n;
+    series->footprint = d + 11 * n;
+    series->orbit = (gint *) (d + 12 * n);
+
+    return series;
+}
+
+/** Free a series allocated with predict_series_new(). */
+void predict_series_free(sat_series_t * series)
+{
+    g_free(series);
+}
+
+/**
+ * \brief Calculate the elevation and the elevation rate.
+ * \param work The working copy of the satellite.
+ * \param frame The observer frame, see predict_obs_frame().
+ * \param t The time (Julian date).
+ * \param el The elevation [rad].
+ * \param rate The elevation rate [rad/day] or NULL.
+ *
+ * This is the minimum needed for searching passes: only the topocentric
+ * elevation and its time derivative are calculated, and none of the
+ * ground track, footprint, orbit or azimuth data of predict_calc_work().
+ * The elevation is the same as in predict_calc_work(); the rate is
+ * obtained analytically from the range and range velocity, taking into
+ * account that the local vertical turns with the earth.
+ *
+ * work->state is updated, work->data is not.
+ */
+void predict_calc_el(sat_work_t * work, const obs_frame_t * frame,
+                     gdouble t, gdouble * el, gdouble * rate)
+{
+    predict_calc_el_theta(work, frame, t, el, rate, NULL);
+}
+
+/**
+ * \brief predict_calc_el() that also gets the angle to the observer.
+ *
+ * theta is the angle between the satellite and the observer seen from the
+ * centre of the earth [rad], see event_bound_init(); it may be NULL.
+ */
+static void predict_calc_el_theta(sat_work_t * work, const obs_frame_t * frame,
+                                  gdouble t, gdouble * el, gdouble * rate,
+                                  gdouble * theta)
+{
+    const sat_t    *sat = work->sat;
+    vector_t        pos, vel, obs_pos, obs_vel, range, rgvel, up;
+    gdouble         tsince, sin_el, cos_el, zdot, rdot;
+
+    tsince = (t - sat->jul_epoch) * xmnpda;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4_Eval(sat, &work->state, tsince);
+    else
+        SGP4_Eval(sat, &work->state, tsince);
+
+    pos = work->state.pos;
+    vel = work->state.vel;
+    Convert_Sat_State(&pos, &vel);
+    Calculate_User_Frame(t, frame, &obs_pos, &obs_vel, &up);
+
+    Vec_Sub(&pos, &obs_pos, &range);
+
+    sin_el = Dot(&up, &range) / range.w;
+    *el = ArcSin(sin_el);
+
+    if (theta != NULL)
+    {
+        Magnitude(&obs_pos);
+        *theta = Angle(&pos, &obs_pos);
+    }
+
+    if (rate == NULL)
+        return;
+
+    rgvel.x = vel.x - obs_vel.x;
+    rgvel.y = vel.y - obs_vel.y;
+    rgvel.z = vel.z - obs_vel.z;
+    zdot = Dot(&up, &rgvel) + mfactor * (up.x * range.y - up.y * range.x);
+    rdot = Dot(&range, &rgvel) / range.w;
+    cos_el = sqrt(1.0 - sin_el * sin_el);
+
+    if (cos_el > 1.0e-9)
+        *rate = (zdot - sin_el * rdot) / (range.w * cos_el) * secday;
+    else
+        *rate = 0.0;
+}
+
+/** \brief Evaluate an event_point_t with predict_calc_el(). */
+static void event_eval(sat_work_t * work, const obs_frame_t * obs, gdouble t,
+                       event_point_t * p)
+{
+    p->t = t;
+    predict_calc_el_theta(work, obs, t, &p->el, &p->rate, &p->theta);
+}
+
+/**
+ * \brief Get a bound on how soon a satellite can rise.
+ * \param sat The satellite.
+ * \param obs The observer location.
+ * \param b The bound.
+ *
+ * The satellite can only be above the horizon when the angle theta
+ * between it and the observer, seen from the centre of the earth, is
+ * below the half-width of the largest footprint, which is reached at
+ * apogee. Seen from the earth, the direction to the satellite turns about
+ * the orbit normal with the rate of the true anomaly, while the observer
+ * turns with the earth; theta can not change faster than the difference
+ * of these two rotations, which is largest at perigee or apogee. A
+ * satellite at theta can therefore not rise for at least
+ * (theta - lambda) / rate days, see event_skip().
+ *
+ * The orbit is taken as a fixed ellipse and the earth as a sphere, which
+ * is made up for by EVENT_BOUND_SLACK, EVENT_BOUND_DRIFT and
+ * EVENT_BOUND_MARGIN.
+ */
+static void event_bound_init(const sat_t * sat, const obs_frame_t * obs,
+                             event_bound_t * b)
+{
+    gdouble         n, e, a, r, robs, we, ci, k, nup, nua, w;
+
+    /* mean motion [rad/day], eccentricity and semi-major axis [km] */
+    n = sat->tle.xno * xmnpda;
+    e = MIN(sat->tle.eo, 0.999);
+    a = pow(xke / sat->tle.xno, 2.0 / 3.0) * xkmper;
+
+    r = a * (1.0 + e) * EVENT_BOUND_SLACK;
+    robs = sqrt(obs->achcp * obs->achcp + obs->z * obs->z);
+    if (r > robs)
+        b->lambda = acos(robs / r) + EVENT_BOUND_MARGIN;
+    else
+        b->lambda = pi;
+
+    /* the rate of the true anomaly is n(1+e)^2/(1-e^2)^1.5 at perigee
+       and n(1-e)^2/(1-e^2)^1.5 at apogee */
+    we = twopi * omega_E;
+    ci = cos(sat->tle.xincl);
+    k = n / pow(1.0 - e * e, 1.5);
+    nup = k * (1.0 + e) * (1.0 + e);
+    nua = k * (1.0 - e) * (1.0 - e);
+
+    w = MAX(sqrt(nup * nup + we * we - 2.0 * nup * we * ci),
+            sqrt(nua * nua + we * we - 2.0 * nua * we * ci));
+
+    /* the secular perturbations make the satellite drift a little even
+       when the two rotations cancel, e.g. for a geostationary orbit */
+    b->rate = w * EVENT_BOUND_SLACK + nup * EVENT_BOUND_DRIFT;
+}
+
+/**
+ * \brief Get the time the satellite is sure to stay below the horizon.
+ * \param b The bound, see event_bound_init().
+ * \param p A point with the satellite below the horizon.
+ * \return The time after p->t before which there can be no AOS [days].
+ */
+static gdouble event_skip(const event_bound_t * b, const event_point_t * p)
+{
+    if (p->theta <= b->lambda || b->rate <= 0.0)
+        return 0.0;
+
+    return (p->theta - b->lambda) / b->rate;
+}
+
+/**
+ * \brief Refine a bracketed root of the elevation or the elevation rate.
+ * \param work The working copy of the satellite.
+ * \param obs The observer location.
+ * \param a The earlier end of the bracket.
+ * \param b The later end of the bracket.
+ * \param rate Find a root of the rate (TCA) instead of the elevation.
+ * \param root The result.
+ *
+ * The function must have opposite signs at a and b (zero counts as
+ * positive). Elevation roots are refined with Newton's method using the
+ * analytic rate and rate roots with the secant through the bracket. The
+ * bracket is maintained throughout and a bisection is done whenever the
+ * bracket does not shrink fast enough, so the iteration always converges.
+ * The returned point is the later end of the final bracket, which is no
+ * more than EVENT_TIME_TOL after the root; for an AOS this means that the
+ * satellite is above the horizon at root->t and for a LOS that it is
+ * below.
+ *
+ * The result depends a little on the initial bracket; see event_refine()
+ * for a version that does not.
+ */
+static void event_refine_bracket(sat_work_t * work, const obs_frame_t * obs,
+                                 const event_point_t * a,
+                                 const event_point_t * b, gboolean rate,
+                                 event_point_t * root)
+{
+    event_point_t   lo = *a;
+    event_point_t   hi = *b;
+    event_point_t   p;
+    gdouble         flo, fhi, f, x, xn;
+    gdouble         w1, w2;     /* bracket width in the previous iterations */
+    guint           i;
+
+    flo = rate ? lo.rate : lo.el;
+    fhi = rate ? hi.rate : hi.el;
+    w1 = w2 = hi.t - lo.t;
+
+    if (fhi != flo)
+        x = lo.t - flo * (hi.t - lo.t) / (fhi - flo);
+    else
+        x = 0.5 * (lo.t + hi.t);
+
+    for (i = 0; (i < EVENT_MAX_ITER) && (hi.t - lo.t > EVENT_TIME_TOL); i++)
+    {
+        event_eval(work, obs, x, &p);
+        f = rate ? p.rate : p.el;
+
+        if ((f < 0.0) == (flo < 0.0))
+        {
+            lo = p;
+            flo = f;
+        }
+        else
+        {
+            hi = p;
+            fhi = f;
+        }
+
+        if (!rate && p.rate != 0.0)
+            xn = x - p.el / p.rate;
+        else
+            xn = lo.t - flo * (hi.t - lo.t) / (fhi - flo);
+
+        /* make sure that the next point falls on the other side of
+           the root when we are close to it so that the bracket collapses */
+        if (fabs(xn - x) < 0.5 * EVENT_TIME_TOL)
+            xn = x + (xn < x ? -0.5 : 0.5) * EVENT_TIME_TOL;
+
+        if (!(xn > lo.t && xn < hi.t) || (hi.t - lo.t > 0.5 * w2))
+            xn = 0.5 * (lo.t + hi.t);
+
+        w2 = w1;
+        w1 = hi.t - lo.t;
+        x = xn;
+    }
+
+    *root = hi;
+}
+
+/**
+ * \brief Refine a bracketed root independently of the bracket.
+ * \param work The working copy of the satellite.
+ * \param obs The observer location.
+ * \param a The earlier end of the bracket.
+ * \param b The later end of the bracket.
+ * \param rate Find a root of the rate (TCA) instead of the elevation.
+ * \param root The result.
+ *
+ * Same as event_refine_bracket(), but the root is refined once more in
+ * the cell of a fixed EVENT_GRID grid, anchored at the epoch, that
+ * contains it. The event times therefore do not depend on the bracket,
+ * i.e. on where the search started, and a pass is the same whichever
+ * time it was predicted from. This costs a few more propagations per
+ * event. If the cell contains no sign change, which can only happen for
+ * a pass that just grazes the horizon, the first result is kept.
+ */
+static void event_refine(sat_work_t * work, const obs_frame_t * obs,
+                         const event_point_t * a, const event_point_t * b,
+                         gboolean rate, event_point_t * root)
+{
+    event_point_t   lo, hi, r;
+    gdouble         epoch = work->sat->jul_epoch;
+    gdouble         k;
+    gboolean        after;
+
+    event_refine_bracket(work, obs, a, b, rate, &r);
+    *root = r;
+
+    /* the sign after the root, i.e. at the later end of the bracket */
+    after = ((rate ? r.rate : r.el) < 0.0);
+
+    k = floor((r.t - epoch) / EVENT_GRID);
+    event_eval(work, obs, epoch + k * EVENT_GRID, &lo);
+
+    /* the root estimate is within EVENT_TIME_TOL of the root, so the
+       root is at most one cell away */
+    if (((rate ? lo.rate : lo.el) < 0.0) == after)
+    {
+        hi = lo;
+        k -= 1.0;
+        event_eval(work, obs, epoch + k * EVENT_GRID, &lo);
+    }
+    else
+    {
+        event_eval(work, obs, epoch + (k + 1.0) * EVENT_GRID, &hi);
+        if (((rate ? hi.rate : hi.el) < 0.0) != after)
+        {
+            lo = hi;
+            k += 1.0;
+            event_eval(work, obs, epoch + (k + 1.0) * EVENT_GRID, &hi);
+        }
+    }
+
+    if (((rate ? lo.rate : lo.el) < 0.0) != after &&
+        ((rate ? hi.rate : hi.el) < 0.0) == after)
+        event_refine_bracket(work, obs, &lo, &hi, rate, root);
+}
+
+/**
+ * \brief Find the AOS of a pass in progress.
+ * \param work The working copy of the satellite.
+ * \param obs The observer location.
+ * \param p The starting point, the satellite must be above the horizon.
+ * \param step The coarse time step.
+ * \param limit Don't search before this time.
+ * \param aos Set to the AOS.
+ * \return TRUE if the AOS was found, FALSE otherwise.
+ */
+static gboolean event_find_prev_aos(sat_work_t * work,
+                                    const obs_frame_t * obs,
+                                    const event_point_t * p, gdouble step,
+                                    gdouble limit, event_point_t * aos)
+{
+    event_point_t   a, b = *p;
+
+    while (b.t > limit)
+    {
+        event_eval(work, obs, b.t - step, &a);
+        if (a.el < 0.0)
+        {
+            event_refine(work, obs, &a, &b, FALSE, aos);
+            return TRUE;
+        }
+        b = a;
+    }
+
+    return FALSE;
+}
+
+/**
+ * \brief Track the maximum elevation between two points of a pass.
+ * \param work The working copy of the satellite.
+ * \param obs The observer location.
+ * \param a The earlier point, the satellite must be above the horizon.
+ * \param b The later point.
+ * \param ev The pass events; tca and max_el are updated.
+ */
+static void event_update_tca(sat_work_t * work, const obs_frame_t * obs,
+                             const event_point_t * a, const event_point_t * b,
+                             pass_events_t * ev)
+{
+    event_point_t   m;
+
+    if (a->el > ev->max_el)
+    {
+        ev->max_el = a->el;
+        ev->tca = a->t;
+    }
+
+    if (b->el > ev->max_el)
+    {
+        ev->max_el = b->el;
+        ev->tca = b->t;
+    }
+
+    if (a->rate > 0.0 && b->rate < 0.0)
+    {
+        event_refine(work, obs, a, b, TRUE, &m);
+        if (m.el > ev->max_el)
+        {
+            ev->max_el = m.el;
+            ev->tca = m.t;
+        }
+    }
+}
+
+/**
+ * \brief Get the coarse time step for bracketing the events of a satellite.
+ * \param sat The satellite.
+ * \return The time step in days.
+ *
+ * The step is a fraction of the orbital period. A pass shorter than the
+ * step is not missed because the elevation rate changes sign across its
+ * maximum.
+ */
+static gdouble event_step(const sat_t * sat)
+{
+    gdouble         step;
+
+    step = twopi / (sat->tle.xno * xmnpda * EVENT_STEPS_PER_ORBIT);
+
+    return MIN(step, EVENT_MAX_STEP);
+}
+
+/** \brief find_events() for a working copy of a satellite.
+ *
+ * tend is the latest time of AOS (0.0 = no limit). If the satellite is
+ * above the horizon at start, the AOS of the pass in progress is searched
+ * for backwards if back is TRUE; otherwise ev->aos is set to 0.0 and the
+ * TCA is searched for between start and the LOS only.
+ */
+static gboolean find_events_work(sat_work_t * work, qth_t * qth,
+                                 gdouble start, gdouble tend, gboolean back,
+                                 pass_events_t * ev)
+{
+    obs_frame_t     obs;
+    event_bound_t   bound;
+    event_point_t   a, b, m, c;
+    gdouble         step;
+    gdouble         skip;
+    gdouble         limit;
+    gboolean        up;
+
+    ev->aos = 0.0;
+    ev->tca = 0.0;
+    ev->los = 0.0;
+    ev->max_el = 0.0;
+
+    if (!has_aos_at(work->sat, qth, start))
+        return FALSE;
+
+    predict_obs_frame(&obs, qth);
+    event_bound_init(work->sat, &obs, &bound);
+
+    step = event_step(work->sat);
+    if (tend <= 0.0)
+        tend = start + EVENT_SCAN_LIMIT;
+    limit = start + EVENT_SCAN_LIMIT;
+
+    /* work in radians until the end */
+    ev->max_el = -pio2;
+
+    event_eval(work, &obs, start, &a);
+    up = (a.el >= 0.0);
+
+    if (up && back)
+    {
+        if (!event_find_prev_aos(work, &obs, &a, step,
+                                 start - EVENT_SCAN_LIMIT, &m))
+            return FALSE;
+        ev->aos = m.t;
+        a = m;
+    }
+
+    while (a.t < limit)
+    {
+        /* no AOS within the time limit */
+        if (!up && a.t > tend)
+            return FALSE;
+
+        /* far from the observer; go straight to where it could rise */
+        if (!up && (skip = event_skip(&bound, &a)) > step)
+        {
+            event_eval(work, &obs, a.t + skip, &b);
+            if (b.el < 0.0)
+            {
+                a = b;
+                continue;
+            }
+        }
+
+        event_eval(work, &obs, a.t + step, &b);
+
+        if (!up)
+        {
+            if (b.el >= 0.0)
+            {
+                /* AOS */
+                event_refine(work, &obs, &a, &b, FALSE, &m);
+                if (m.t > tend)
+                    return FALSE;
+                ev->aos = m.t;
+                up = TRUE;
+                a = m;
+            }
+            else if (a.rate > 0.0 && b.rate < 0.0)
+            {
+                /* a maximum below the horizon may hide a short pass */
+                event_refine(work, &obs, &a, &b, TRUE, &m);
+                if (m.el >= 0.0)
+                {
+                    event_refine(work, &obs, &a, &m, FALSE, &c);
+                    if (c.t > tend)
+                        return FALSE;
+                    ev->aos = c.t;
+                    ev->tca = m.t;
+                    ev->max_el = m.el;
+                    event_refine(work, &obs, &m, &b, FALSE, &c);
+                    ev->los = c.t;
+                    up = TRUE;
+                    break;
+                }
+            }
+        }
+
+        if (up)
+        {
+            if (b.el < 0.0)
+            {
+                /* LOS */
+                event_refine(work, &obs, &a, &b, FALSE, &m);
+                event_update_tca(work, &obs, &a, &m, ev);
+                ev->los = m.t;
+                break;
+            }
+
+            event_update_tca(work, &obs, &a, &b, ev);
+        }
+
+        a = b;
+    }
+
+    ev->max_el = Degrees(ev->max_el);
+
+    return up;
+}
+
+/**
+ * \brief Find the events of a pass.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit for the AOS in days (0.0 = no limit)
+ * \param ev The events of the pass.
+ * \return TRUE if a pass was found, FALSE otherwise.
+ *
+ * This function finds the AOS, TCA and LOS of the pass in progress at
+ * start or, if the satellite is below the horizon, of the first pass
+ * with AOS between start and start+maxdt.
+ *
+ * The horizon crossings are bracketed by stepping through time with a
+ * step size derived from the orbital period. They are then refined using
+ * the analytic elevation rate so that all times are within
+ * EVENT_TIME_TOL of the true event. This needs only a few propagations
+ * per event. The final refinement is done on a fixed grid, so for
+ * near-earth satellites the times do not depend on start.
+ *
+ * If the LOS can not be found within EVENT_SCAN_LIMIT days, ev->los is
+ * set to 0.0 and the TCA is the highest point found.
+ *
+ * \note The calculations are done on a working copy and sat is not modified.
+ */
+gboolean find_events(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt,
+                     pass_events_t * ev)
+{
+    sat_work_t      work;
+
+    predict_work_init(&work, sat);
+
+    return find_events_work(&work, qth, start,
+                            maxdt > 0.0 ? start + maxdt : 0.0, TRUE, ev);
+}
+
 /**
  * \brief Find the AOS time of the next pass.
  * \author Alexandru Csete, OZ9AEC
@@ -122,227 +1097,314 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
  *
  * This function finds the time of AOS for the first coming pass taking place
  * no earlier that start.
- * If the satellite is currently within range, the function first calls
- * find_los to get the next LOS time. Then the calculations are done using
- * the new start time.
+ * If the satellite is currently within range, the search starts at the
+ * LOS of the current pass.
+ *
+ * \note The calculations are done on a working copy and sat is not modified.
  */
 gdouble find_aos(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
 {
-    gdouble         t = start;
-    gdouble         aostime = 0.0;
+    sat_work_t      work;
+
+    predict_work_init(&work, sat);
+
+    return find_aos_work(&work, qth, start, maxdt);
+}
+
+/** \brief find_aos() for a working copy of a satellite. */
+static gdouble find_aos_work(sat_work_t * work, qth_t * qth, gdouble start,
+                             gdouble maxdt)
+{
+    pass_events_t   ev;
+    gdouble         tend = (maxdt > 0.0) ? start + maxdt : 0.0;
+
+    if (!find_events_work(work, qth, start, tend, FALSE, &ev))
+        return 0.0;
 
-    /* make sure current sat values are in sync with the time */
-    predict_calc(sat, qth, start);
+    /* pass in progress; continue after LOS */
+    if (ev.aos == 0.0 &&
+        (ev.los == 0.0 ||
+         !find_events_work(work, qth, ev.los + EVENT_NEXT_PASS, tend,
+                           FALSE, &ev)))
+        return 0.0;
+
+    return ev.aos;
+}
+
+/**
+ * \brief Find the LOS time of the next pass.
+ * \author Alexandru Csete, OZ9AEC
+ * \author John A. Magliacane, KD2BD
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \return The time of the next LOS or 0.0 if the satellite has no LOS.
+ *
+ * This function finds the time of LOS for the first coming pass taking place
+ * no earlier that start.
+ * If the satellite is currently out of range, this is the LOS of the
+ * next pass with AOS before start+maxdt.
+ *
+ * \note The calculations are done on a working copy and sat is not modified.
+ */
+gdouble find_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
+{
+    sat_work_t      work;
+
+    predict_work_init(&work, sat);
+
+    return find_los_work(&work, qth, start, maxdt);
+}
+
+/** \brief find_los() for a working copy of a satellite. */
+static gdouble find_los_work(sat_work_t * work, qth_t * qth, gdouble start,
+                             gdouble maxdt)
+{
+    pass_events_t   ev;
+
+    if (!find_events_work(work, qth, start,
+                          (maxdt > 0.0) ? start + maxdt : 0.0, FALSE, &ev))
+        return 0.0;
+
+    return ev.los;
+}
+
+/**
+ * \brief Find AOS time of current pass.
+ * \param sat The satellite to find AOS for.
+ * \param qth The ground station.
+ * \param start Start time, prefereably now.
+ * \return The time of the previous AOS or 0.0 if the satellite has no AOS.
+ *
+ * This function can be used to find the AOS time in the past of the
+ * current pass. If the satellite is below the horizon, start is returned.
+ *
+ * \note The calculations are done on a working copy and sat is not modified.
+ */
+gdouble find_prev_aos(sat_t * sat, qth_t * qth, gdouble start)
+{
+    sat_work_t      work;
+
+    predict_work_init(&work, sat);
+
+    return find_prev_aos_work(&work, qth, start);
+}
+
+/** \brief find_prev_aos() for a working copy of a satellite. */
+static gdouble find_prev_aos_work(sat_work_t * work, qth_t * qth,
+                                  gdouble start)
+{
+    obs_frame_t     obs;
+    event_point_t   p, aos;
 
     /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
+    if (!has_aos_at(work->sat, qth, start))
         return 0.0;
 
-    if (sat->el > 0.0)
-        t = find_los(sat, qth, start, maxdt) + 0.014;   // +20 min
+    predict_obs_frame(&obs, qth);
+
+    event_eval(work, &obs, start, &p);
+    if (p.el < 0.0)
+        return start;
 
-    /* invalid time (potentially returned by find_los) */
-    if (t < 0.1)
+    if (!event_find_prev_aos(work, &obs, &p, event_step(work->sat),
+                             start - EVENT_SCAN_LIMIT, &aos))
         return 0.0;
 
-    /* update satellite data */
-    predict_calc(sat, qth, t);
+    return aos.t;
+}
 
-    /* use upper time limit */
-    if (maxdt > 0.0)
-    {
+/**
+ * \brief Get the illumination of the satellite from its position.
+ * \param vs The search.
+ * \param t The time (Julian date).
+ * \param pos The ECI position of the satellite [km] including magnitude.
+ * \param p The result.
+ */
+static void vis_eval_pos(vis_search_t * vs, gdouble t, vector_t * pos,
+                         vis_point_t * p)
+{
+    vector_t        sun;
 
-        /* coarse time steps */
-        while ((sat->el < -1.0) && (t <= (start + maxdt)))
-        {
-            t -= 0.00035 * (sat->el * ((sat->alt / 8400.0) + 0.46) - 2.0);
-            predict_calc(sat, qth, t);
-        }
+    solar_cache_pos(t, &sun);
 
-        /* fine steps */
-        while ((aostime == 0.0) && (t <= (start + maxdt)))
-        {
+    p->t = t;
+    p->eclipsed = Sat_Eclipsed(pos, &sun, &p->depth);
+    p->sun = solar_cache_el(t, &sun, &vs->frame) - vs->twilight;
+}
 
-            if (fabs(sat->el) < 0.005)
-            {
-                aostime = t;
-            }
-            else
-            {
-                t -= sat->el * sqrt(sat->alt) / 530000.0;
-                predict_calc(sat, qth, t);
-            }
+/** \brief Propagate the satellite and get its illumination. */
+static void vis_eval(vis_search_t * vs, gdouble t, vis_point_t * p)
+{
+    const sat_t    *sat = vs->work->sat;
+    vector_t        pos, vel;
+    gdouble         tsince;
 
-        }
+    tsince = (t - sat->jul_epoch) * xmnpda;
 
-    }
-    /* don't use upper time limit */
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4_Eval(sat, &vs->work->state, tsince);
     else
-    {
-        /* coarse time steps */
-        while (sat->el < -1.0)
-        {
-            t -= 0.00035 * (sat->el * ((sat->alt / 8400.0) + 0.46) - 2.0);
-            predict_calc(sat, qth, t);
-        }
+        SGP4_Eval(sat, &vs->work->state, tsince);
 
-        /* fine steps */
-        while (aostime == 0.0)
-        {
+    pos = vs->work->state.pos;
+    vel = vs->work->state.vel;
+    Convert_Sat_State(&pos, &vel);
 
-            if (fabs(sat->el) < 0.005)
-            {
-                aostime = t;
-            }
-            else
-            {
-                t -= sat->el * sqrt(sat->alt) / 530000.0;
-                predict_calc(sat, qth, t);
-            }
-        }
-    }
+    vis_eval_pos(vs, t, &pos, p);
+}
+
+/**
+ * \brief Get the visibility of a satellite that is above the horizon.
+ *
+ * This is what get_sat_vis_thld() returns for the same data.
+ */
+static sat_vis_t vis_state(gboolean eclipsed, gboolean sun_up)
+{
+    if (eclipsed)
+        return SAT_VIS_ECLIPSED;
 
-    return aostime;
+    return sun_up ? SAT_VIS_DAYLIGHT : SAT_VIS_VISIBLE;
 }
 
 /**
- * \brief Find the LOS time of the next pass.
- * \author Alexandru Csete, OZ9AEC
- * \author John A. Magliacane, KD2BD
- * \param sat Pointer to the satellite data.
- * \param qth Pointer to the QTH data.
- * \param start The time where calculation should start.
- * \param maxdt The upper time limit in days (0.0 = no limit)
- * \return The time of the next LOS or 0.0 if the satellite has no LOS.
+ * \brief Refine an eclipse or twilight crossing.
+ * \param vs The search.
+ * \param a The point before the crossing.
+ * \param b The point after the crossing.
+ * \param sun Refine the twilight crossing instead of the eclipse.
+ * \return The time of the crossing, no more than EVENT_TIME_TOL after it.
  *
- * This function finds the time of LOS for the first coming pass taking place
- * no earlier that start.
- * If the satellite is currently out of range, the function first calls
- * find_aos to get the next AOS time. Then the calculations are done using
- * the new start time.
- * The function has a built-in watchdog to ensure that we don't end up in
- * lengthy loops.
+ * The bracket is kept on the state (eclipsed or sun up) while the next
+ * point is estimated by regula falsi on the eclipse depth or the sun
+ * elevation, with the Illinois modification and bisection as a fall back.
  */
-gdouble find_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
+static gdouble vis_refine(vis_search_t * vs, const vis_point_t * a,
+                          const vis_point_t * b, gboolean sun)
 {
-    gdouble         t = start;
-    gdouble         lostime = 0.0;
-    gdouble         eltemp;
+    vis_point_t     lo = *a;
+    vis_point_t     hi = *b;
+    vis_point_t     p;
+    gdouble         flo, fhi, f, x;
+    gboolean        slo;
+    gint            side = 0;
+    guint           i;
 
-    predict_calc(sat, qth, start);
+    flo = sun ? lo.sun : lo.depth;
+    fhi = sun ? hi.sun : hi.depth;
+    slo = sun ? (lo.sun > 0.0) : lo.eclipsed;
 
-    /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
+    for (i = 0; (i < EVENT_MAX_ITER) && (hi.t - lo.t > EVENT_TIME_TOL); i++)
     {
-        return 0.0;
-    }
-
-    if (sat->el < 0.0)
-        t = find_aos(sat, qth, start, maxdt) + 0.001;   // +1.5 min
+        if (fhi != flo)
+            x = lo.t - flo * (hi.t - lo.t) / (fhi - flo);
+        else
+            x = 0.5 * (lo.t + hi.t);
 
-    /* invalid time (potentially returned by find_aos) */
-    if (t < 0.01)
-        return 0.0;
+        /* never let the bracket stall at one end */
+        if (!(x > lo.t + 0.25 * EVENT_TIME_TOL &&
+              x < hi.t - 0.25 * EVENT_TIME_TOL))
+            x = 0.5 * (lo.t + hi.t);
 
-    /* update satellite data */
-    predict_calc(sat, qth, t);
+        vis_eval(vs, x, &p);
+        f = sun ? p.sun : p.depth;
 
-    /* use upper time limit */
-    if (maxdt > 0.0)
-    {
-        /* coarse steps */
-        while ((sat->el >= 1.0) && (t <= (start + maxdt)))
+        if ((sun ? (p.sun > 0.0) : p.eclipsed) == slo)
         {
-            t += cos((sat->el - 1.0) * de2ra) * sqrt(sat->alt) / 25000.0;
-            predict_calc(sat, qth, t);
+            lo = p;
+            flo = f;
+            if (side == -1)
+                fhi *= 0.5;
+            side = -1;
         }
-
-        /* fine steps */
-        while ((lostime == 0.0) && (t <= (start + maxdt)))
+        else
         {
-            t += sat->el * sqrt(sat->alt) / 502500.0;
-            predict_calc(sat, qth, t);
-
-            if (fabs(sat->el) < 0.005)
-            {
-                /* Two things are true at LOS time, the elevation is a zero and
-                   sat is descending. This checks that those two are true. */
-                eltemp = sat->el;
-
-                /* check elevation 1 second earlier */
-                predict_calc(sat, qth, t - 1.0 / 86400.0);
-
-                if (sat->el > eltemp)
-                    lostime = t;
-            }
+            hi = p;
+            fhi = f;
+            if (side == 1)
+                flo *= 0.5;
+            side = 1;
         }
     }
-    /* don't use upper limit */
-    else
-    {
-        /* coarse steps */
-        while (sat->el >= 1.0)
-        {
-            t += cos((sat->el - 1.0) * de2ra) * sqrt(sat->alt) / 25000.0;
-            predict_calc(sat, qth, t);
-        }
-
-        /* fine steps */
-        while (lostime == 0.0)
-        {
-            t += sat->el * sqrt(sat->alt) / 502500.0;
-            predict_calc(sat, qth, t);
 
-            if (fabs(sat->el) < 0.005)
-            {
-                /* two things are true at LOS time
-                   The elevation is a zero and descending.
-                   This checks that those two are true.
-                 */
-                eltemp = sat->el;
-
-                /*check elevation 1 second earlier */
-                predict_calc(sat, qth, t - 1.0 / 86400.0);
+    return hi.t;
+}
 
-                if (sat->el > eltemp)
-                    lostime = t;
-            }
-        }
-    }
+/** \brief Start a new window at t unless the visibility is the same. */
+static void vis_change(vis_search_t * vs, gdouble t, sat_vis_t vis)
+{
+    if (vis == vs->cur.vis)
+        return;
 
-    return lostime;
+    vs->cur.end = t;
+    g_array_append_val(vs->windows, vs->cur);
+    vs->cur.start = t;
+    vs->cur.vis = vis;
 }
 
 /**
- * \brief Find AOS time of current pass.
- * \param sat The satellite to find AOS for.
- * \param qth The ground station.
- * \param start Start time, prefereably now.
- * \return The time of the previous AOS or 0.0 if the satellite has no AOS.
+ * \brief Find the visibility changes between two points.
+ * \param vs The search.
+ * \param a The earlier point, whose visibility is vs->cur.vis.
+ * \param b The later point.
  *
- * This function can be used to find the AOS time in the past of the
- * current pass.
+ * Both the eclipse and the twilight may change between a and b; the
+ * crossings are refined separately and applied in time order.
  */
-gdouble find_prev_aos(sat_t * sat, qth_t * qth, gdouble start)
+static void vis_scan(vis_search_t * vs, const vis_point_t * a,
+                     const vis_point_t * b)
 {
-    gdouble         aostime = start;
+    gboolean        ecl = (a->eclipsed != b->eclipsed);
+    gboolean        twl = ((a->sun > 0.0) != (b->sun > 0.0));
+    gdouble         t_ecl = 0.0, t_twl = 0.0;
 
-    /* make sure current sat values are in sync with the time */
-    predict_calc(sat, qth, start);
+    if (ecl)
+        t_ecl = vis_refine(vs, a, b, FALSE);
+    if (twl)
+        t_twl = vis_refine(vs, a, b, TRUE);
 
-    /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
+    if (ecl && twl)
     {
-        return 0.0;
+        if (t_ecl <= t_twl)
+        {
+            vis_change(vs, t_ecl, vis_state(b->eclipsed, a->sun > 0.0));
+            vis_change(vs, t_twl, vis_state(b->eclipsed, b->sun > 0.0));
+        }
+        else
+        {
+            vis_change(vs, t_twl, vis_state(a->eclipsed, b->sun > 0.0));
+            vis_change(vs, t_ecl, vis_state(b->eclipsed, b->sun > 0.0));
+        }
     }
+    else if (ecl)
+        vis_change(vs, t_ecl, vis_state(b->eclipsed, b->sun > 0.0));
+    else if (twl)
+        vis_change(vs, t_twl, vis_state(b->eclipsed, b->sun > 0.0));
+}
 
-    while (sat->el >= 0.0)
-    {
-        aostime -= 0.0005;      // 0.75 min
-        predict_calc(sat, qth, aostime);
-    }
+/** \brief Set up a visibility window search. */
+static void vis_search_init(vis_search_t * vs, sat_work_t * work,
+                            qth_t * qth, gdouble twilight)
+{
+    vs->work = work;
+    predict_obs_frame(&vs->frame, qth);
+    vs->twilight = twilight;
+    vs->windows = g_array_new(FALSE, FALSE, sizeof(vis_window_t));
+}
+
+/** \brief Start the first window of a search at p. */
+static void vis_search_start(vis_search_t * vs, const vis_point_t * p)
+{
+    vs->cur.start = p->t;
+    vs->cur.vis = vis_state(p->eclipsed, p->sun > 0.0);
+}
 
-    return aostime;
+/** \brief Close the last window of a search at t. */
+static void vis_search_end(vis_search_t * vs, gdouble t)
+{
+    vs->cur.end = t;
+    g_array_append_val(vs->windows, vs->cur);
 }
 
 /**
@@ -412,12 +1474,13 @@ GSList         *get_next_passes(sat_t * sat, qth_t * qth, gdouble maxdt,
  */
 pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 {
-    int      min_ele = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    pass_cfg_t cfg;
+    sat_work_t work;
 
-    if (min_ele == 0)
-        min_ele = 1;
+    pass_cfg_load(&cfg);
+    predict_work_init(&work, sat_in);
 
-    return get_pass_engine(sat_in, qth, start, maxdt, min_ele);
+    return get_pass_cached(&work, qth, start, maxdt, &cfg);
 }
 
 /**
@@ -434,15 +1497,23 @@ pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
                                    gdouble maxdt)
 {
-    return get_pass_engine(sat_in, qth, start, maxdt, 0.0);
+    pass_cfg_t      cfg;
+    sat_work_t      work;
+
+    pass_cfg_load(&cfg);
+    cfg.min_el = 0.0;
+    predict_work_init(&work, sat_in);
+
+    return get_pass_cached(&work, qth, start, maxdt, &cfg);
 }
 
 /**
  * \brief Predict first pass after a certain time.
- * \param sat Pointer to the satellite data.
+ * \param work Working copy of the satellite.
  * \param qth Pointer to the location data.
  * \param start Starting time.
  * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param cfg The prediction settings.
  * \return Pointer to a newly allocated pass_t structure or NULL if
  *         there was an error.
  *
@@ -450,196 +1521,168 @@ pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
  * t = start and no later than t = (start+maxdt).
  *
  * \note For no time limit use maxdt = 0.0
- *
- * \note the data in sat will be corrupt (future) and must be refreshed
- *       by the caller, if the caller will need it later on (eg. if the caller
- *       is GtkSatList).
- *
- * \note Prepending to a singly linked list is much faster than appending.
- *       Therefore, the elements are prepended whereafter the GSList is
- *       reversed
  */
-static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el)
+static pass_t  *get_pass_engine(sat_work_t * work, qth_t * qth, gdouble start,
+                                gdouble maxdt, const pass_cfg_t * cfg)
 {
-    gdouble         aos = 0.0;  /* time of AOS */
-    gdouble         tca = 0.0;  /* time of TCA */
-    gdouble         los = 0.0;  /* time of LOS */
+    pass_events_t   ev;         /* AOS, TCA and LOS */
     gdouble         dt = 0.0;   /* time diff */
     gdouble         step = 0.0; /* time step */
     gdouble         t0 = start;
     gdouble         t;          /* current time counter */
-    gdouble         tres = 0.0; /* required time resolution */
-    gdouble         max_el = 0.0;       /* maximum elevation */
+    gdouble         tend;       /* latest AOS, 0.0 = no limit */
     pass_t         *pass = NULL;
     pass_detail_t  *detail = NULL;
-    gboolean        done = FALSE;
-    guint           iter = 0;   /* number of iterations */
-    sat_t          *sat, sat_working;
+    sat_series_t   *series;
+    sat_work_t      vis_work;
+    vis_search_t    vs;
+    vis_point_t    *vis;
+    guint           i, n;
 
-    /* FIXME: watchdog */
+    tend = (maxdt > 0.0) ? start + maxdt : 0.0;
 
-    /*copy sat_in to a working structure */
-    sat = memcpy(&sat_working, sat_in, sizeof(sat_t));
+    /* find the first pass with elevation >= min_el, starting with the
+       pass in progress if any */
+    do
+    {
+        if (!find_events_work(work, qth, t0, tend, TRUE, &ev) ||
+            ev.los == 0.0)
+            return NULL;
 
-    /* get time resolution; sat-cfg stores it in seconds */
-    tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
+        t0 = ev.los + EVENT_NEXT_PASS;
+    }
+    while (ev.max_el < cfg->min_el);
 
-    /* loop until we find a pass with elevation > SAT_CFG_INT_PRED_MIN_EL
-       or we run out of time
-       FIXME: we should have a safety break
-     */
-    while (!done)
-    {
-        /* Find los of next pass or of current pass */
-        los = find_los(sat, qth, t0, maxdt);    // See if a pass is ongoing
-        aos = find_aos(sat, qth, t0, start + maxdt - t0);
+    dt = ev.los - ev.aos;
 
-        if (aos > los)
-            // los is from an currently happening pass, find previous aos
-            aos = find_prev_aos(sat, qth, t0);
+    /* get time step, which will give us the max number of entries */
+    step = dt / cfg->num_entries;
 
-        /* aos = 0.0 means no aos */
-        if (aos == 0.0)
-            done = TRUE;
+    /* but if this is smaller than the required resolution
+       we go with the resolution
+     */
+    if (step < cfg->tres)
+        step = cfg->tres;
+
+    /* calculate the details for each time step in one go */
+    for (n = 0, t = ev.aos; t <= ev.los; t += step)
+        n++;
+    series = predict_series_new(n);
+    predict_calc_series(work, qth, ev.aos, step, n, series);
+
+    /* find the visibility windows, using the details to bracket the
+       changes; the last detail is at or before the LOS. This is done on
+       a copy so that SDP4 sees the same call history as before. */
+    vis_work = *work;
+    vis_search_init(&vs, &vis_work, qth, cfg->twilight);
+    vis = g_new(vis_point_t, n + 1);
+    for (i = 0; i < n; i++)
+        vis_eval_pos(&vs, series->time[i], &series->pos[i], &vis[i]);
+    vis_eval(&vs, ev.los, &vis[n]);
 
-        /* check whether we are within time limits;
-           maxdt = 0 mean no time limit.
-         */
-        else if ((maxdt > 0.0) && (aos > (start + maxdt)))
-        {
-            done = TRUE;
-        }
-        else
-        {
-            //los = find_los (sat, qth, aos + 0.001, maxdt); // +1.5 min later
-            dt = los - aos;
-
-            /* get time step, which will give us the max number of entries */
-            step = dt / sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
-
-            /* but if this is smaller than the required resolution
-               we go with the resolution
-             */
-            if (step < tres)
-                step = tres;
-
-            /* create a pass_t entry; FIXME: g_try_new in 2.8 */
-            pass = g_new(pass_t, 1);
-
-            pass->aos = aos;
-            pass->los = los;
-            pass->max_el = 0.0;
-            pass->aos_az = 0.0;
-            pass->los_az = 0.0;
-            pass->maxel_az = 0.0;
-            pass->vis[0] = '-';
-            pass->vis[1] = '-';
-            pass->vis[2] = '-';
-            pass->vis[3] = 0;
-            pass->satname = g_strdup(sat->nickname);
-            pass->details = NULL;
-            /*copy qth data into the pass for later comparisons */
-            qth_small_save(qth, &(pass->qth_comp));
-
-            /* iterate over each time step */
-            for (t = pass->aos; t <= pass->los; t += step)
-            {
+    vis_search_start(&vs, &vis[0]);
+    for (i = 0; i < n; i++)
+        vis_scan(&vs, &vis[i], &vis[i + 1]);
+    vis_search_end(&vs, ev.los);
 
-                /* calculate satellite data */
-                predict_calc(sat, qth, t);
+    /* the pass, its details and windows are one block of memory */
+    pass = pass_new(n, vs.windows->len, work->sat->nickname);
+    if (pass == NULL)
+    {
+        g_array_unref(vs.windows);
+        g_free(vis);
+        predict_series_free(series);
+        return NULL;
+    }
 
-                /* in the first iter we want to store
-                   pass->aos_az
-                 */
-                if (t == pass->aos)
-                {
-                    pass->aos_az = sat->az;
-                    pass->orbit = sat->orbit;
-                }
+    pass->aos = ev.aos;
+    pass->tca = ev.tca;
+    pass->los = ev.los;
+    pass->max_el = ev.max_el;
+    pass->aos_az = series->az[0];
+    pass->los_az = 0.0;
+    pass->orbit = series->orbit[0];
+    pass->maxel_az = 0.0;
+    pass->vis[0] = '-';
+    pass->vis[1] = '-';
+    pass->vis[2] = '-';
+    pass->vis[3] = 0;
+    /*copy qth data into the pass for later comparisons */
+    qth_small_save(qth, &(pass->qth_comp));
 
-                /* append details to sat->details */
-                detail = g_new(pass_detail_t, 1);
-                detail->time = t;
-                detail->pos.x = sat->pos.x;
-                detail->pos.y = sat->pos.y;
-                detail->pos.z = sat->pos.z;
-                detail->pos.w = sat->pos.w;
-                detail->vel.x = sat->vel.x;
-                detail->vel.y = sat->vel.y;
-                detail->vel.z = sat->vel.z;
-                detail->vel.w = sat->vel.w;
-                detail->velo = sat->velo;
-                detail->az = sat->az;
-                detail->el = sat->el;
-                detail->range = sat->range;
-                detail->range_rate = sat->range_rate;
-                detail->lat = sat->ssplat;
-                detail->lon = sat->ssplon;
-                detail->alt = sat->alt;
-                detail->ma = sat->ma;
-                detail->phase = sat->phase;
-                detail->footprint = sat->footprint;
-                detail->orbit = sat->orbit;
-                detail->vis = get_sat_vis(sat, qth, t);
-
-                /* also store visibility "bit" */
-                switch (detail->vis)
-                {
-                case SAT_VIS_VISIBLE:
-                    pass->vis[0] = 'V';
-                    break;
-                case SAT_VIS_DAYLIGHT:
-                    pass->vis[1] = 'D';
-                    break;
-                case SAT_VIS_ECLIPSED:
-                    pass->vis[2] = 'E';
-                    break;
-                default:
-                    break;
-                }
+    for (i = 0; i < n; i++)
+    {
+        detail = &pass->details[i];
+        detail->time = series->time[i];
+        detail->pos = series->pos[i];
+        detail->vel = series->vel[i];
+        detail->velo = series->velo[i];
+        detail->az = series->az[i];
+        detail->el = series->el[i];
+        detail->range = series->range[i];
+        detail->range_rate = series->range_rate[i];
+        detail->lat = series->lat[i];
+        detail->lon = series->lon[i];
+        detail->alt = series->alt[i];
+        detail->ma = series->ma[i];
+        detail->phase = series->phase[i];
+        detail->footprint = series->footprint[i];
+        detail->orbit = series->orbit[i];
+        detail->vis = vis_state(vis[i].eclipsed, vis[i].sun > 0.0);
+        if (detail->vis == SAT_VIS_VISIBLE && detail->el < 0.0)
+            detail->vis = SAT_VIS_DAYLIGHT;
+    }
 
-                pass->details = g_slist_prepend(pass->details, detail);
+    /* the visibility "bits" are exact, not just from the details */
+    for (i = 0; i < vs.windows->len; i++)
+    {
+        pass->windows[i] = g_array_index(vs.windows, vis_window_t, i);
 
-                /* store elevation if greater than the
-                   previously stored one
-                 */
-                if (sat->el > max_el)
-                {
-                    max_el = sat->el;
-                    tca = t;
-                    pass->maxel_az = sat->az;
-                }
+        switch (pass->windows[i].vis)
+        {
+        case SAT_VIS_VISIBLE:
+            pass->vis[0] = 'V';
+            break;
+        case SAT_VIS_DAYLIGHT:
+            pass->vis[1] = 'D';
+            break;
+        case SAT_VIS_ECLIPSED:
+            pass->vis[2] = 'E';
+            break;
+        default:
+            break;
+        }
+    }
 
-                /*     g_print ("TIME: %f\tAZ: %f\tEL: %f (MAX: %f)\n", */
-                /*           t, sat->az, sat->el, max_el); */
-            }
+    g_array_unref(vs.windows);
+    g_free(vis);
+    predict_series_free(series);
 
-            pass->details = g_slist_reverse(pass->details);
+    /* calculate satellite data */
+    predict_calc_work(work, qth, pass->tca);
+    pass->maxel_az = work->data.az;
+    predict_calc_work(work, qth, pass->los);
+    pass->los_az = work->data.az;
 
-            /* calculate satellite data */
-            predict_calc(sat, qth, pass->los);
-            /* store los_az, max_el and tca */
-            pass->los_az = sat->az;
-            pass->max_el = max_el;
-            pass->tca = tca;
+    return pass;
+}
 
-            /* check whether this pass is good */
-            if (max_el >= min_el)
-            {
-                done = TRUE;
-            }
-            else
-            {
-                done = FALSE;
-                t0 = los + 0.014;       // +20 min
-                free_pass(pass);
-                pass = NULL;
-            }
+/**
+ * \brief get_pass_engine() with the pass cache in front.
+ *
+ * The result is the same as that of get_pass_engine(), see pass-cache.c.
+ */
+static pass_t  *get_pass_cached(sat_work_t * work, qth_t * qth, gdouble start,
+                                gdouble maxdt, const pass_cfg_t * cfg)
+{
+    pass_t         *pass;
 
-            iter++;
-        }
-    }
+    if (pass_cache_lookup(work->sat, qth, cfg, start, maxdt, &pass))
+        return pass;
+
+    pass = get_pass_engine(work, qth, start, maxdt, cfg);
+    if (pass != NULL)
+        pass_cache_insert(work->sat, qth, cfg, start, pass);
 
     return pass;
 }
@@ -657,18 +1700,49 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
  * \note the data in sat will be corrupt (future) and must be refreshed
  *       by the caller, if the caller will need it later on (eg. if the caller
  *       is GtkSatList).
+ */
+GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
+                           gdouble maxdt, guint num)
+{
+    GSList         *passes;
+    pass_cfg_t      cfg;
+
+    pass_cfg_load(&cfg);
+    passes = get_passes_cfg(sat, qth, start, maxdt, num, &cfg);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Found %d passes for %s in time window [%f;%f]"),
+                __func__, g_slist_length(passes), sat->nickname, start,
+                start + maxdt);
+
+    return passes;
+}
+
+/**
+ * \brief Predict passes after a certain time using the given settings.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the location data.
+ * \param start Starting time.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param num The number of passes to predict (0 = up to 100).
+ * \param cfg The prediction settings, see pass_cfg_load().
+ * \return A singly linked list of pass_t structures or NULL if there
+ *         are no passes.
+ *
+ * Same as get_passes() but neither reads the configuration nor logs, so
+ * it can be called from a worker thread. sat and qth are only read.
  *
  * \note Prepending to a singly linked list is much faster than appending.
  *       Therefore, the elements are prepended whereafter the GSList is
  *       reversed
  */
-// causes issues on 2nd iter onwards
-// check for memory leak
-GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
-                           gdouble maxdt, guint num)
+GSList         *get_passes_cfg(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, guint num,
+                               const pass_cfg_t * cfg)
 {
     GSList         *passes = NULL;
-    pass_t         *pass = NULL;
+    pass_t         *pass;
+    sat_work_t      work;
     guint           i;
     gdouble         t;
 
@@ -677,202 +1751,145 @@ GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
     if (num == 0)
         num = 100;
 
+    predict_work_init(&work, sat);
     t = start;
 
     for (i = 0; i < num; i++)
     {
-        pass = get_pass(sat, qth, t, maxdt);
+        pass = get_pass_cached(&work, qth, t, maxdt, cfg);
 
-        if (pass != NULL)
-        {
-            passes = g_slist_prepend(passes, pass);
-            t = pass->los + 0.014;      // +20 min
+        /* we can't get any more passes */
+        if (pass == NULL)
+            break;
 
-            /* if maxdt > 0.0 check whether we have reached t = start+maxdt
-               if yes finish predictions
-             */
-            if ((maxdt > 0.0) && (t >= (start + maxdt)))
-            {
-                i = num;
-            }
-        }
-        else
-        {
-            if (pass != NULL)
-            {
-                sat_log_log(SAT_LOG_LEVEL_DEBUG, "%s %d: Pass is not NULL", __FILE__, __LINE__);
-                free_pass(pass);
-            }
-            /* we can't get any more passes */
-            i = num;
-        }
+        passes = g_slist_prepend(passes, pass);
+        t = pass->los + EVENT_NEXT_PASS;
 
+        /* if maxdt > 0.0 check whether we have reached t = start+maxdt
+           if yes finish predictions
+         */
+        if ((maxdt > 0.0) && (t >= (start + maxdt)))
+            break;
     }
 
-    if (passes != NULL)
-        passes = g_slist_reverse(passes);
-
-    sat_log_log(SAT_LOG_LEVEL_INFO,
-                _("%s: Found %d passes for %s in time window [%f;%f]"),
-                __func__, g_slist_length(passes), sat->nickname, start,
-                start + maxdt);
-
-    return passes;
+    return g_slist_reverse(passes);
 }
 
-pass_t         *copy_pass(pass_t * pass)
+/**
+ * \brief Read the pass prediction settings from the configuration.
+ * \param cfg The settings to fill in.
+ */
+void pass_cfg_load(pass_cfg_t * cfg)
 {
-    pass_t         *new;
-
-    new = g_try_new(pass_t, 1);
-
-    if (new != NULL)
-    {
-        new->aos = pass->aos;
-        new->los = pass->los;
-        new->tca = pass->tca;
-        new->max_el = pass->max_el;
-        new->aos_az = pass->aos_az;
-        new->los_az = pass->los_az;
-        new->orbit = pass->orbit;
-        new->maxel_az = pass->maxel_az;
-        new->vis[0] = pass->vis[0];
-        new->vis[1] = pass->vis[1];
-        new->vis[2] = pass->vis[2];
-        new->vis[3] = pass->vis[3];
-        new->details = copy_pass_details(pass->details);
-
-        if (pass->satname != NULL)
-            new->satname = g_strdup(pass->satname);
-        else
-            new->satname = NULL;
-    }
-
-    return new;
+    cfg->min_el = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    if (cfg->min_el == 0.0)
+        cfg->min_el = 1.0;
+
+    /* sat-cfg stores the resolution in seconds */
+    cfg->tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
+    cfg->num_entries = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+    cfg->twilight = sat_cfg_get_int(SAT_CFG_INT_PRED_TWILIGHT_THLD);
 }
 
-GSList         *copy_pass_details(GSList * details)
+/**
+ * \brief Get the size of the memory block holding a pass.
+ * \param num_details The number of details.
+ * \param num_windows The number of visibility windows.
+ * \param satname The satellite name or NULL.
+ */
+static gsize pass_size(guint num_details, guint num_windows,
+                       const gchar * satname)
 {
-    GSList         *new = NULL;
-    guint           i, n;
-
-    n = g_slist_length(details);
-    for (i = 0; i < n; i++)
-    {
-        new = g_slist_prepend(new,
-                              copy_pass_detail(PASS_DETAIL
-                                               (g_slist_nth_data
-                                                (details, i))));
-    }
-
-    new = g_slist_reverse(new);
-
-    return new;
-}
+    gsize           size;
 
-pass_detail_t  *copy_pass_detail(pass_detail_t * detail)
-{
-    pass_detail_t  *new;
-
-    /* create a pass_t entry; FIXME: g_try_new in 2.8 */
-    new = g_new(pass_detail_t, 1);
-
-    new->time = detail->time;
-    new->pos.x = detail->pos.x;
-    new->pos.y = detail->pos.y;
-    new->pos.z = detail->pos.z;
-    new->pos.w = detail->pos.w;
-    new->vel.x = detail->vel.x;
-    new->vel.y = detail->vel.y;
-    new->vel.z = detail->vel.z;
-    new->vel.w = detail->vel.w;
-    new->velo = detail->velo;
-    new->az = detail->az;
-    new->el = detail->el;
-    new->range = detail->range;
-    new->range_rate = detail->range_rate;
-    new->lat = detail->lat;
-    new->lon = detail->lon;
-    new->alt = detail->alt;
-    new->ma = detail->ma;
-    new->phase = detail->phase;
-    new->footprint = detail->footprint;
-    new->orbit = detail->orbit;
-    new->vis = detail->vis;
+    size = sizeof(pass_t) + num_details * sizeof(pass_detail_t) +
+        num_windows * sizeof(vis_window_t);
+    if (satname != NULL)
+        size += strlen(satname) + 1;
 
-    return new;
+    return size;
 }
 
-void free_pass(pass_t * pass)
+/**
+ * \brief Point the arrays of a pass into its memory block.
+ * \param pass The pass; num_details and num_windows must be set.
+ * \param named Whether the block has room for the name.
+ */
+static void pass_set_pointers(pass_t * pass, gboolean named)
 {
-    if (pass != NULL)
-    {
-        free_pass_details(pass->details);
+    pass->details = (pass_detail_t *) (pass + 1);
+    pass->windows = (vis_window_t *) (pass->details + pass->num_details);
 
-        if (pass->satname != NULL)
-        {
-            g_free(pass->satname);
-            pass->satname = NULL;
-        }
-
-        g_free(pass);
-        pass = NULL;
-    }
+    if (named)
+        pass->satname = (gchar *) (pass->windows + pass->num_windows);
+    else
+        pass->satname = NULL;
 }
 
-/** \brief Free a list of passes. */
-void free_passes(GSList * passes)
+/**
+ * \brief Allocate a pass with room for the details, windows and name.
+ * \param num_details The number of details.
+ * \param num_windows The number of visibility windows.
+ * \param satname The satellite name, which is copied, or NULL.
+ * \return The new pass or NULL if the memory could not be allocated. Only
+ *         satname, num_details, details, num_windows and windows are set.
+ *
+ * The pass, its details, windows and the name are allocated as one block,
+ * so that a pass can be copied or freed in one operation.
+ */
+static pass_t  *pass_new(guint num_details, guint num_windows,
+                         const gchar * satname)
 {
-    guint           n, i;
-    gpointer        pass;
+    pass_t         *pass;
 
-    n = g_slist_length(passes);
+    pass = g_try_malloc(pass_size(num_details, num_windows, satname));
+    if (pass == NULL)
+        return NULL;
 
-    for (i = 0; i < n; i++)
-    {
-        pass = g_slist_nth_data(passes, i);
+    pass->num_details = num_details;
+    pass->num_windows = num_windows;
+    pass_set_pointers(pass, satname != NULL);
 
-        /* free element data */
-        free_pass(PASS(pass));
-    }
+    if (satname != NULL)
+        strcpy(pass->satname, satname);
 
-    /* now free the list elements */
-    g_slist_free(passes);
-    passes = NULL;
+    return pass;
 }
 
 /**
- * \brief Free a pass detail structure.
- *
- * This function is not rarely useful except for the
- * free_pass function.
+ * \brief Copy a pass.
+ * \param pass The pass to copy.
+ * \return The copy, which should be freed with free_pass(), or NULL if the
+ *         memory could not be allocated.
  */
-void free_pass_detail(pass_detail_t * detail)
+pass_t         *copy_pass(pass_t * pass)
 {
-    g_free(detail);
-    detail = NULL;
-}
+    pass_t         *new;
+    gsize           size;
 
-/** Free the whole list of details. */
-void free_pass_details(GSList * details)
-{
-    guint           n, i;
-    gpointer        detail;
+    size = pass_size(pass->num_details, pass->num_windows, pass->satname);
+    new = g_try_malloc(size);
+    if (new == NULL)
+        return NULL;
 
-    n = g_slist_length(details);
+    memcpy(new, pass, size);
 
-    for (i = 0; i < n; i++)
-    {
+    /* the pointers must point into the new block */
+    pass_set_pointers(new, pass->satname != NULL);
 
-        detail = g_slist_nth_data(details, i);
+    return new;
+}
 
-        /* free element data */
-        free_pass_detail(PASS_DETAIL(detail));
-    }
+/** \brief Free a pass including its details. */
+void free_pass(pass_t * pass)
+{
+    g_free(pass);
+}
 
-    /* free list elements */
-    g_slist_free(details);
-    details = NULL;
+/** \brief Free a list of passes. */
+void free_passes(GSList * passes)
+{
+    g_slist_free_full(passes, (GDestroyNotify) free_pass);
 }
 
 /**
@@ -884,10 +1901,8 @@ void free_pass_details(GSList * details)
  *         there was an error.
  *
  * Assuming that sat->el > 0.0 this function calculates the details of the
- * current pass from AOS time to LOS time.
- * First the function goes back in time to before the AOS, then it calls
- * the get_pass_no_min_el function to get the details of the current pass
- * disregarding any minimum elevation requirements.
+ * current pass from AOS time to LOS time disregarding any minimum
+ * elevation requirements.
  *
  * \note The start parameter has been introduced to allow correct use of this
  *       function in non-realtime cases.
@@ -896,34 +1911,30 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
 {
     gdouble         t, t0;
     gdouble         el0;
-    sat_t          *sat, sat_working;
+    sat_work_t      work;
+    pass_cfg_t      cfg;
     pass_t         *pass;
 
-    /*copy sat_in to a working structure */
-    sat = memcpy(&sat_working, sat_in, sizeof(sat_t));
+    predict_work_init(&work, sat_in);
 
     if (start > 0.0)
         t = start;
     else
         t = get_current_daynum();
-    predict_calc(sat, qth, t);
+    predict_calc_work(&work, qth, t);
 
     /*save initial conditions for later comparison */
     t0 = t;
-    el0 = sat->el;
+    el0 = work.data.el;
 
     /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
+    if (!has_aos_at(sat_in, qth, t))
         return NULL;
 
-    /* find a time before AOS */
-    while (sat->el > 0.0)
-    {
-        predict_calc(sat, qth, t);
-        t -= 0.007;             // +10 min
-    }
-
-    pass = get_pass_no_min_el(sat, qth, t, 0.0);
+    /* the engine finds the AOS of the pass in progress */
+    pass_cfg_load(&cfg);
+    cfg.min_el = 0.0;
+    pass = get_pass_cached(&work, qth, t, 0.0, &cfg);
     if (el0 > 0.0)
     {
         /* this function is only specified if the elevation 
@@ -934,13 +1945,13 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
                 sat_log_log(SAT_LOG_LEVEL_ERROR,
                             _
                             ("%s: Returning a pass for %s that starts after the seeded time."),
-                            __func__, sat->nickname);
+                            __func__, sat_in->nickname);
 
             if (pass->los < t0)
                 sat_log_log(SAT_LOG_LEVEL_ERROR,
                             _
                             ("%s: Returning a pass for %s that ends before the seeded time."),
-                            __func__, sat->nickname);
+                            __func__, sat_in->nickname);
         }
     }
 
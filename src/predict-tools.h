@@ -34,22 +34,6 @@
 #include "sgpsdp/sgp4sdp4.h"
 
 
-/** \brief Brief satellite pass info. */
-typedef struct {
-    gchar      *satname;  /*!< satellite name */
-    gdouble     aos;      /*!< AOS time in "jul_utc" */
-    gdouble     tca;      /*!< TCA time in "jul_utc" */
-    gdouble     los;      /*!< LOS time in "jul_utc" */
-    gdouble     max_el;   /*!< Maximum elevation during pass */
-    gdouble     aos_az;   /*!< Azimuth at AOS */
-    gdouble     los_az;   /*!< Azimuth at LOS */
-    gint        orbit;    /*!< Orbit number */
-    gdouble     maxel_az; /*!< Azimuth at maximum elevation */
-    gchar       vis[4];   /*!< Visibility string, e.g. VSE, -S-, V-- */
-    GSList     *details;  /*!< List of pass_detail_t entries */
-    qth_small_t qth_comp; /*!< Short version of qth at time computed */
-} pass_t;
-
 /**
  * \brief Pass detail entry.
  *
@@ -78,14 +62,130 @@ typedef struct {
     gint      orbit;
 } pass_detail_t;
 
+/** \brief Time interval with the same visibility, see pass_t. */
+typedef struct {
+    gdouble     start;    /*!< Start time in "jul_utc" */
+    gdouble     end;      /*!< End time in "jul_utc" */
+    sat_vis_t   vis;      /*!< Visibility during the interval */
+} vis_window_t;
+
+/**
+ * \brief Brief satellite pass info.
+ *
+ * The details and the visibility windows are stored in arrays after the
+ * pass_t itself and the satellite name after that, so a pass is a single
+ * block of memory. It must be created by the pass predictors or
+ * copy_pass() and freed with free_pass().
+ */
+typedef struct {
+    gchar      *satname;  /*!< satellite name */
+    gdouble     aos;      /*!< AOS time in "jul_utc" */
+    gdouble     tca;      /*!< TCA time in "jul_utc" */
+    gdouble     los;      /*!< LOS time in "jul_utc" */
+    gdouble     max_el;   /*!< Maximum elevation during pass */
+    gdouble     aos_az;   /*!< Azimuth at AOS */
+    gdouble     los_az;   /*!< Azimuth at LOS */
+    gint        orbit;    /*!< Orbit number */
+    gdouble     maxel_az; /*!< Azimuth at maximum elevation */
+    gchar       vis[4];   /*!< Visibility string, e.g. VSE, -S-, V-- */
+    qth_small_t qth_comp; /*!< Short version of qth at time computed */
+    guint       num_details; /*!< Number of entries in details */
+    pass_detail_t *details; /*!< Pass details, details[0] is at AOS */
+    guint       num_windows; /*!< Number of entries in windows */
+    vis_window_t *windows; /*!< Visibility from AOS to LOS, in time order */
+} pass_t;
+
+/** \brief AOS, TCA and LOS of a pass, see find_events(). */
+typedef struct {
+    gdouble     aos;      /*!< AOS time in "jul_utc" */
+    gdouble     tca;      /*!< TCA time in "jul_utc" */
+    gdouble     los;      /*!< LOS time in "jul_utc", 0.0 if not found */
+    gdouble     max_el;   /*!< Elevation at TCA */
+} pass_events_t;
+
+/** \brief Pass prediction settings, see pass_cfg_load(). */
+typedef struct {
+    gdouble     min_el;      /*!< Minimum elevation of a pass [deg] */
+    gdouble     tres;        /*!< Minimum time step of the details [days] */
+    guint       num_entries; /*!< Number of entries in the details */
+    gdouble     twilight;    /*!< Twilight threshold [deg] */
+} pass_cfg_t;
+
+/**
+ * \brief Lightweight working copy of a satellite.
+ *
+ * The pass predictors need to propagate a satellite to arbitrary times
+ * without disturbing the real one. Instead of copying the whole sat_t,
+ * which includes all the SGP4/SDP4 initialization constants, they use
+ * the sat_t read-only as the element set and only carry the propagator
+ * state and the computed satellite data.
+ *
+ * The sat_t must have been initialized with gtk_sat_data_init_sat() and
+ * must stay valid for the lifetime of the working copy.
+ */
+typedef struct {
+    const sat_t    *sat;    /*!< Element set, not modified */
+    sgpsdp_state_t  state;  /*!< Propagator state */
+    pass_detail_t   data;   /*!< Satellite data at data.time (no vis) */
+} sat_work_t;
+
+/**
+ * \brief Satellite data for a series of times.
+ *
+ * Structure of arrays filled by predict_calc_series(). The arrays are
+ * owned by the caller and must have room for the requested number of
+ * points. Arrays that are not needed can be NULL, in which case the
+ * corresponding data is not calculated, e.g. a ground track only needs
+ * lat, lon and orbit. The units are the same as in pass_detail_t.
+ */
+typedef struct {
+    gdouble    *time;       /*!< time in "jul_utc" */
+    vector_t   *pos;        /*!< Position in ECI [km] */
+    vector_t   *vel;        /*!< Velocity in ECI [km/s] */
+    gdouble    *velo;
+    gdouble    *az;
+    gdouble    *el;
+    gdouble    *range;
+    gdouble    *range_rate;
+    gdouble    *lat;
+    gdouble    *lon;
+    gdouble    *alt;
+    gdouble    *ma;
+    gdouble    *phase;
+    gdouble    *footprint;
+    gint       *orbit;
+} sat_series_t;
+
 /* type casting macros */
 #define PASS(x) ((pass_t *) x)
 #define PASS_DETAIL(x) ((pass_detail_t *) x)
 
 /* SGP4/SDP4 driver */
-void predict_calc (sat_t *sat, qth_t *qth, gdouble t);
+void predict_calc       (sat_t *sat, qth_t *qth, gdouble t);
+void predict_obs_context (obs_ctx_t *ctx, qth_t *qth, gdouble t);
+void predict_calc_ctx   (sat_t *sat, const obs_ctx_t *ctx);
+void predict_calc_cached (sat_t *sat, ephem_cache_t *cache,
+                          const obs_ctx_t *ctx);
+void predict_calc_obs   (sat_t *sat, const obs_ctx_t *ctx);
+void predict_calc_state (const sat_t *sat, const obs_ctx_t *ctx,
+                         pass_detail_t *d);
+void predict_work_init  (sat_work_t *work, const sat_t *sat);
+void predict_calc_work  (sat_work_t *work, qth_t *qth, gdouble t);
+void predict_calc_series (sat_work_t *work, qth_t *qth, gdouble t0,
+                          gdouble dt, guint n, sat_series_t *out);
+
+/* elevation only, for pass searches */
+void predict_obs_frame  (obs_frame_t *frame, qth_t *qth);
+void predict_calc_el    (sat_work_t *work, const obs_frame_t *frame,
+                         gdouble t, gdouble *el, gdouble *rate);
+
+/* series storage */
+sat_series_t *predict_series_new  (guint n);
+void          predict_series_free (sat_series_t *series);
 
 /* AOS/LOS time calculators */
+gboolean find_events       (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt,
+                            pass_events_t *ev);
 gdouble find_aos           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_los           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_prev_aos      (sat_t *sat, qth_t *qth, gdouble start);
@@ -97,18 +197,17 @@ GSList *get_next_passes    (sat_t *sat, qth_t *qth, gdouble maxdt, guint num);
 /* future events */
 pass_t *get_pass           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 GSList *get_passes         (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt, guint num);
+GSList *get_passes_cfg     (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt,
+                            guint num, const pass_cfg_t *cfg);
+void    pass_cfg_load      (pass_cfg_t *cfg);
 pass_t *get_current_pass   (sat_t *sat, qth_t *qth, gdouble start);
 pass_t *get_pass_no_min_el (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 
 /* copying */
 pass_t        *copy_pass         (pass_t *pass);
-GSList        *copy_pass_details (GSList *details);
-pass_detail_t *copy_pass_detail  (pass_detail_t *detail);
 
 /* memory cleaning */
 void free_pass         (pass_t *pass);
 void free_passes       (GSList *passes);
-void free_pass_detail  (pass_detail_t *detail);
-void free_pass_details (GSList *details);
 
 #endif
@@ -0,0 +1,189 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file sat-array.c
+ * \brief Satellites of a module stored in one block.
+ *
+ * The views and the module go through all satellites on every cycle. A
+ * hash table spreads them over the heap and visits them through
+ * callbacks, which does not scale well to thousands of satellites. The
+ * satellites are therefore kept in one array in the order they are
+ * listed in the module configuration. The hash table remains as an index
+ * from catalog number to satellite; its keys and values point into the
+ * array, so it needs no allocations of its own.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "gtk-sat-data.h"
+#include "sat-array.h"
+#include "sat-log.h"
+
+
+/** \brief Free the strings of a satellite, but not the satellite itself. */
+static void sat_array_free_strings(sat_t * sat)
+{
+    g_free(sat->name);
+    g_free(sat->nickname);
+    g_free(sat->website);
+    sat->name = NULL;
+    sat->nickname = NULL;
+    sat->website = NULL;
+}
+
+/**
+ * \brief Create an empty satellite array.
+ * \return The new array, free it with sat_array_free().
+ */
+sat_array_t    *sat_array_new(void)
+{
+    sat_array_t    *arr = g_new0(sat_array_t, 1);
+
+    arr->index = g_hash_table_new(g_int_hash, g_int_equal);
+
+    return arr;
+}
+
+/**
+ * \brief Free a satellite array and its satellites.
+ * \param arr The array.
+ */
+void sat_array_free(sat_array_t * arr)
+{
+    if (arr == NULL)
+        return;
+
+    sat_array_clear(arr);
+    g_hash_table_destroy(arr->index);
+    g_free(arr);
+}
+
+/**
+ * \brief Remove all satellites.
+ * \param arr The array.
+ *
+ * The index is kept, so pointers to it stay valid.
+ */
+void sat_array_clear(sat_array_t * arr)
+{
+    guint           i;
+
+    g_hash_table_remove_all(arr->index);
+
+    for (i = 0; i < arr->num; i++)
+        sat_array_free_strings(&arr->sats[i]);
+
+    g_free(arr->sats);
+    arr->sats = NULL;
+    arr->num = 0;
+}
+
+/**
+ * \brief Read satellites into the array.
+ * \param arr The array; any satellites in it are removed first.
+ * \param catnums The catalog numbers of the satellites.
+ * \param num The number of entries in catnums.
+ * \param qth The QTH used to initialize the satellites.
+ * \return The number of satellites read.
+ *
+ * Satellites that can not be read and duplicates are skipped. The
+ * satellites are stored in the order of catnums.
+ */
+guint sat_array_load(sat_array_t * arr, const gint * catnums, guint num,
+                     qth_t * qth)
+{
+    sat_t          *sat;
+    guint           i;
+
+    sat_array_clear(arr);
+
+    arr->sats = g_new0(sat_t, MAX(num, 1));
+
+    for (i = 0; i < num; i++)
+    {
+        if (g_hash_table_lookup(arr->index, &catnums[i]) != NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Sat #%d already in list"),
+                        __func__, catnums[i]);
+            continue;
+        }
+
+        sat = &arr->sats[arr->num];
+        if (gtk_sat_data_read_sat(catnums[i], sat))
+        {
+            /* the satellite could not be read */
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error reading data for #%d"),
+                        __func__, catnums[i]);
+            sat_array_free_strings(sat);
+            memset(sat, 0, sizeof(sat_t));
+            continue;
+        }
+
+        gtk_sat_data_init_sat(sat, qth);
+
+        /* the block is allocated for all records, so they do not move */
+        g_hash_table_insert(arr->index, &sat->tle.catnr, sat);
+        arr->num++;
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Read data for #%d"), __func__, catnums[i]);
+    }
+
+    return arr->num;
+}
+
+/**
+ * \brief Find a satellite by catalog number.
+ * \param arr The array.
+ * \param catnum The catalog number.
+ * \return The satellite or NULL if it is not in the array.
+ */
+sat_t          *sat_array_lookup(const sat_array_t * arr, gint catnum)
+{
+    return SAT(g_hash_table_lookup(arr->index, &catnum));
+}
+
+/**
+ * \brief Find the index of a satellite by catalog number.
+ * \param arr The array.
+ * \param catnum The catalog number.
+ * \return The index in arr->sats or -1 if it is not in the array.
+ */
+gint sat_array_index(const sat_array_t * arr, gint catnum)
+{
+    sat_t          *sat = sat_array_lookup(arr, catnum);
+
+    return sat != NULL ? (gint) (sat - arr->sats) : -1;
+}
@@ -0,0 +1,57 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_ARRAY_H
+#define SAT_ARRAY_H 1
+
+#include <glib.h>
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/**
+ * \brief Satellites stored in one block with an index by catalog number.
+ *
+ * Iterate over the satellites with a plain loop over sats[0..num-1] and
+ * use sat_array_lookup() or sat_array_index() to find one. The records
+ * do not move until the array is cleared or loaded again, so pointers to
+ * them and their indices are stable in between.
+ */
+typedef struct {
+    sat_t          *sats;       /*!< The satellites */
+    guint           num;        /*!< Number of satellites */
+    GHashTable     *index;      /*!< Catalog number -> satellite in sats */
+} sat_array_t;
+
+sat_array_t    *sat_array_new(void);
+void            sat_array_free(sat_array_t * arr);
+void            sat_array_clear(sat_array_t * arr);
+guint           sat_array_load(sat_array_t * arr, const gint * catnums,
+                               guint num, qth_t * qth);
+sat_t          *sat_array_lookup(const sat_array_t * arr, gint catnum);
+gint            sat_array_index(const sat_array_t * arr, gint catnum);
+
+#endif
@@ -163,6 +163,7 @@ sat_cfg_bool_t  sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     {"MODULES", "MAP_SHOW_GRID", TRUE},
     {"MODULES", "MAP_SHOW_TERMINATOR", TRUE},
     {"MODULES", "MAP_KEEP_RATIO", FALSE},
+    {"MODULES", "MAP_SAT_LAYER", FALSE},
     {"MODULES", "POLAR_QTH_INFO", TRUE},
     {"MODULES", "POLAR_NEXT_EVENT", TRUE},
     {"MODULES", "POLAR_CURSOR_TRACK", TRUE},
@@ -172,7 +173,8 @@ sat_cfg_bool_t  sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     {"TLE", "PROXY_AUTH", FALSE},
     {"TLE", "ADD_NEW_SATS", TRUE},
     {"LOG", "KEEP_LOG_FILES", FALSE},
-    {"PREDICT", "USE_REAL_T0", FALSE}
+    {"PREDICT", "USE_REAL_T0", FALSE},
+    {"LOG", "TIMING_SUMMARY", FALSE}
 };
 
 /** Array containing the integer configuration parameters */
@@ -256,7 +258,9 @@ sat_cfg_int_t   sat_cfg_int[SAT_CFG_INT_NUM] = {
     {"TLE", "AUTO_UPDATE_ACTION", 1},   /* notify, see tle_auto_upd_action_t */
     {"TLE", "LAST_UPDATE", 0},
     {"LOG", "CLEAN_AGE", 0},    /* 0 = Never clean */
-    {"LOG", "LEVEL", 2}
+    {"LOG", "LEVEL", 2},
+    {"PREDICT", "EPHEM_CACHE_TOLERANCE", 0},    /* off, see sat-propagator.c */
+    {"PREDICT", "SLOW_REFRESH", 10}
 };
 
 /** Array containing the string configuration values */
@@ -44,6 +44,7 @@ typedef enum {
     SAT_CFG_BOOL_MAP_SHOW_GRID, /*!< Show grid on map. */
     SAT_CFG_BOOL_MAP_SHOW_TERMINATOR,   /*!< Show solar terminator on map. */
     SAT_CFG_BOOL_MAP_KEEP_RATIO,        /*!< Keep original aspect ratio */
+    SAT_CFG_BOOL_MAP_SAT_LAYER, /*!< Draw satellites in one layer */
     SAT_CFG_BOOL_POL_SHOW_QTH_INFO,     /*!< Show QTH info on polar plot */
     SAT_CFG_BOOL_POL_SHOW_NEXT_EV,      /*!< Show next event on polar plot */
     SAT_CFG_BOOL_POL_SHOW_CURS_TRACK,   /*!< Track mouse cursor on polar plot. */
@@ -54,6 +55,7 @@ typedef enum {
     SAT_CFG_BOOL_TLE_ADD_NEW,   /*!< Add new satellites to database. */
     SAT_CFG_BOOL_KEEP_LOG_FILES,        /*!< Whether to keep old log files */
     SAT_CFG_BOOL_PRED_USE_REAL_T0,      /*!< Whether to use current time as T0 fro predictions */
+    SAT_CFG_BOOL_LOG_TIMING,    /*!< Log module timing summaries */
     SAT_CFG_BOOL_NUM            /*!< Number of boolean parameters */
 } sat_cfg_bool_e;
 
@@ -137,6 +139,8 @@ typedef enum {
     SAT_CFG_INT_TWO_SAT_FIELDS,         /*<! Two-sat fields. */
     SAT_CFG_INT_TWO_SAT_SELECT_FIRST,   /*<! Two-sat first selected satellite. */
     SAT_CFG_INT_TWO_SAT_SELECT_SECOND,  /*<! Two-sat second selected satellite. */
+    SAT_CFG_INT_PRED_EPHEM_TOL, /*!< Ephemeris cache tolerance in meters, 0 = off */
+    SAT_CFG_INT_PRED_SLOW_REFRESH,      /*!< Refresh period of satellites far from AOS [s], 0 = off */
     SAT_CFG_INT_NUM,             /*!< Number of integer parameters. */
 } sat_cfg_int_e;
 
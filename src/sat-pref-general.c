@@ -32,6 +32,7 @@
 #include "sat-pref-formats.h"
 #include "sat-pref-general.h"
 #include "sat-pref-qth.h"
+#include "sat-pref-timing.h"
 #include "sat-pref-tle.h"
 
 /**
@@ -59,6 +60,9 @@ GtkWidget      *sat_pref_general_create()
     gtk_notebook_append_page(GTK_NOTEBOOK(nbook),
                              sat_pref_debug_create(),
                              gtk_label_new(_("Message Logs")));
+    gtk_notebook_append_page(GTK_NOTEBOOK(nbook),
+                             sat_pref_timing_create(),
+                             gtk_label_new(_("Module Timing")));
 
     return nbook;
 }
@@ -70,6 +74,7 @@ void sat_pref_general_cancel()
     sat_pref_qth_cancel();
     sat_pref_tle_cancel();
     sat_pref_debug_cancel();
+    sat_pref_timing_cancel();
 }
 
 /** User pressed OK. Any changes should be stored in config. */
@@ -79,4 +84,5 @@ void sat_pref_general_ok()
     sat_pref_qth_ok();
     sat_pref_tle_ok();
     sat_pref_debug_ok();
+    sat_pref_timing_ok();
 }
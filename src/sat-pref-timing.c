@@ -0,0 +1,257 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Timing of the update cycle of the open modules.
+ *
+ * The page shows the median, 95th percentile and maximum duration of each
+ * phase of the module update cycle, see cycle-timing.c, and the hit rate
+ * of the pass cache, see pass-cache.c. The numbers are read when the page
+ * is created and when the user presses Refresh.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+
+#include "cycle-timing.h"
+#include "gtk-sat-module.h"
+#include "mod-mgr.h"
+#include "pass-cache.h"
+#include "sat-cfg.h"
+#include "sat-pref-timing.h"
+
+
+/** Columns in the timing table. */
+enum {
+    TIMING_COL_MODULE = 0,
+    TIMING_COL_PHASE,
+    TIMING_COL_SAMPLES,
+    TIMING_COL_P50,
+    TIMING_COL_P95,
+    TIMING_COL_MAX,
+    TIMING_COL_NUMBER
+};
+
+static GtkWidget *logsum;
+static GtkWidget *cachelbl;
+static GtkListStore *store;
+
+static gboolean dirty = FALSE;
+
+
+/* Fill the table with the current numbers of all modules. */
+static void fill_store(void)
+{
+    GSList         *mods;
+    GtkSatModule   *mod;
+    GtkTreeIter     iter;
+    cycle_summary_t sum;
+    pass_cache_stats_t stats;
+    gchar          *text;
+    gchar           p50[16], p95[16], max[16];
+    guint           i;
+
+    gtk_list_store_clear(store);
+
+    for (mods = mod_mgr_get_modules(); mods != NULL; mods = mods->next)
+    {
+        mod = GTK_SAT_MODULE(mods->data);
+
+        for (i = 0; i < CYCLE_PHASE_NUM; i++)
+        {
+            cycle_timing_get(mod->timing, i, &sum);
+            if (sum.num == 0)
+                continue;
+
+            g_snprintf(p50, sizeof(p50), "%.2f", sum.p50 / 1000.0);
+            g_snprintf(p95, sizeof(p95), "%.2f", sum.p95 / 1000.0);
+            g_snprintf(max, sizeof(max), "%.2f", sum.max / 1000.0);
+
+            gtk_list_store_append(store, &iter);
+            gtk_list_store_set(store, &iter,
+                               TIMING_COL_MODULE, mod->name,
+                               TIMING_COL_PHASE, cycle_timing_phase_name(i),
+                               TIMING_COL_SAMPLES, sum.num,
+                               TIMING_COL_P50, p50,
+                               TIMING_COL_P95, p95,
+                               TIMING_COL_MAX, max, -1);
+        }
+    }
+
+    pass_cache_get_stats(&stats);
+    text = g_strdup_printf(_("Pass cache: %u hits, %u misses, "
+                             "%u passes (%u kB)"),
+                           stats.hits, stats.misses, stats.entries,
+                           (guint) (stats.size / 1024));
+    gtk_label_set_text(GTK_LABEL(cachelbl), text);
+    g_free(text);
+}
+
+/* User pressed cancel. Any changes to config must be cancelled. */
+void sat_pref_timing_cancel()
+{
+    dirty = FALSE;
+}
+
+/* User pressed OK. Any changes should be stored in config. */
+void sat_pref_timing_ok()
+{
+    if (dirty)
+        sat_cfg_set_bool(SAT_CFG_BOOL_LOG_TIMING,
+                         gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
+                                                      (logsum)));
+
+    dirty = FALSE;
+}
+
+static void state_change_cb(GtkWidget * widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    dirty = TRUE;
+}
+
+static void refresh_cb(GtkWidget * button, gpointer data)
+{
+    (void)button;
+    (void)data;
+
+    fill_store();
+}
+
+static void clear_cb(GtkWidget * button, gpointer data)
+{
+    GSList         *mods;
+
+    (void)button;
+    (void)data;
+
+    for (mods = mod_mgr_get_modules(); mods != NULL; mods = mods->next)
+        cycle_timing_reset(GTK_SAT_MODULE(mods->data)->timing);
+
+    fill_store();
+}
+
+static void add_column(GtkWidget * treeview, const gchar * title, gint col,
+                       gfloat xalign)
+{
+    GtkCellRenderer *renderer;
+    GtkTreeViewColumn *column;
+
+    renderer = gtk_cell_renderer_text_new();
+    g_object_set(G_OBJECT(renderer), "xalign", xalign, NULL);
+    column = gtk_tree_view_column_new_with_attributes(title, renderer,
+                                                      "text", col, NULL);
+    gtk_tree_view_insert_column(GTK_TREE_VIEW(treeview), column, -1);
+}
+
+GtkWidget      *sat_pref_timing_create()
+{
+    GtkWidget      *vbox;
+    GtkWidget      *swin;
+    GtkWidget      *treeview;
+    GtkWidget      *label;
+    GtkWidget      *button;
+    GtkWidget      *butbox;
+
+    vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
+    gtk_box_set_homogeneous(GTK_BOX(vbox), FALSE);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 20);
+    gtk_box_set_spacing(GTK_BOX(vbox), 10);
+
+    label = gtk_label_new(_("Time spent in each phase of the module update "
+                            "cycle over the last cycles, in milliseconds.\n"
+                            "Propagation and event search run on worker "
+                            "threads; the other phases block the user "
+                            "interface."));
+    gtk_label_set_line_wrap(GTK_LABEL(label), TRUE);
+    g_object_set(label, "xalign", 0.0f, NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+
+    /* timing table */
+    store = gtk_list_store_new(TIMING_COL_NUMBER, G_TYPE_STRING,
+                               G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING,
+                               G_TYPE_STRING, G_TYPE_STRING);
+    treeview = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    g_object_unref(store);
+
+    add_column(treeview, _("Module"), TIMING_COL_MODULE, 0.0);
+    add_column(treeview, _("Phase"), TIMING_COL_PHASE, 0.0);
+    add_column(treeview, _("Samples"), TIMING_COL_SAMPLES, 1.0);
+    add_column(treeview, _("Median"), TIMING_COL_P50, 1.0);
+    add_column(treeview, _("95%"), TIMING_COL_P95, 1.0);
+    add_column(treeview, _("Max"), TIMING_COL_MAX, 1.0);
+
+    /* pass cache statistics, filled in with the table */
+    cachelbl = gtk_label_new(NULL);
+    g_object_set(cachelbl, "xalign", 0.0f, NULL);
+    gtk_widget_set_tooltip_text(cachelbl,
+                                _("Predicted passes reused since gpredict "
+                                  "was started."));
+    fill_store();
+
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(swin), treeview);
+    gtk_box_pack_start(GTK_BOX(vbox), swin, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), cachelbl, FALSE, FALSE, 0);
+
+    /* periodic summaries in the log */
+    logsum = gtk_check_button_new_with_label(_("Log a summary every minute"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(logsum),
+                                 sat_cfg_get_bool(SAT_CFG_BOOL_LOG_TIMING));
+    gtk_widget_set_tooltip_text(logsum,
+                                _("Write the numbers of each module to the "
+                                  "message log once a minute."));
+    g_signal_connect(logsum, "toggled", G_CALLBACK(state_change_cb), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), logsum, FALSE, FALSE, 0);
+
+    /* refresh and clear buttons */
+    butbox = gtk_button_box_new(GTK_ORIENTATION_HORIZONTAL);
+    gtk_button_box_set_layout(GTK_BUTTON_BOX(butbox), GTK_BUTTONBOX_END);
+
+    button = gtk_button_new_with_label(_("Clear"));
+    gtk_widget_set_tooltip_text(button,
+                                _("Discard the collected numbers."));
+    g_signal_connect(G_OBJECT(button), "clicked", G_CALLBACK(clear_cb),
+                     NULL);
+    gtk_box_pack_end(GTK_BOX(butbox), button, FALSE, TRUE, 10);
+
+    button = gtk_button_new_with_label(_("Refresh"));
+    gtk_widget_set_tooltip_text(button, _("Show the latest numbers."));
+    g_signal_connect(G_OBJECT(button), "clicked", G_CALLBACK(refresh_cb),
+                     NULL);
+    gtk_box_pack_end(GTK_BOX(butbox), button, FALSE, TRUE, 10);
+
+    gtk_box_pack_end(GTK_BOX(vbox), butbox, FALSE, TRUE, 0);
+
+    return vbox;
+}
@@ -0,0 +1,8 @@
+#ifndef SAT_PREF_TIMING_H
+#define SAT_PREF_TIMING_H 1
+
+GtkWidget      *sat_pref_timing_create(void);
+void            sat_pref_timing_cancel(void);
+void            sat_pref_timing_ok(void);
+
+#endif
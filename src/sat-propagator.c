@@ -0,0 +1,533 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file sat-propagator.c
+ * \brief Propagation of the satellites of a module on a worker thread.
+ *
+ * The propagator works on private copies of the satellites, so neither
+ * the satellites of the module nor the propagator state used by the views
+ * are touched by the worker. The results are written to one of two
+ * snapshots, the one which is not published, and published by swapping
+ * the pointer to the current snapshot. A new run is only started from
+ * the main loop after the previous one has finished, so the published
+ * snapshot is never written while it can be read and no locks are
+ * needed.
+ *
+ * The near-earth satellites are propagated together using the SGP4
+ * batch, see sgpsdp/sgp_batch.c, and the others one by one. If the
+ * ephemeris cache is enabled, all satellites are updated from their
+ * cache instead, see sgpsdp/sgp_cheb.c, and the batch is not used.
+ *
+ * The cache is off by default (PREDICT/EPHEM_CACHE_TOLERANCE = 0): the
+ * batch is exact and fast enough for modules of ordinary size. The cache
+ * pays off when the module holds many deep-space satellites, which are
+ * not part of the batch, and the time runs steadily, so that each fitted
+ * window serves many cycles. It does not help when the time is jumped
+ * around in manual mode or at a high throttle, since every query outside
+ * the current window costs a new fit.
+ *
+ * Most satellites of a large module are below the horizon and far from
+ * AOS; they are only shown on the map. The main loop can allow such a
+ * satellite to be updated at a slow rate with sat_propagator_set_slow().
+ * It is then calculated once per slow period. In between, the entry of
+ * its last calculation is reused and only the sub-satellite point, i.e.
+ * the position on the map, is moved on from the last two calculations.
+ * It is calculated again on the first request at or after the time given
+ * by the main loop, e.g. shortly before its AOS, so the views get
+ * calculated data from then on. The slow satellites are left out of the
+ * batch as well, see the skip mask of sgp4_batch_t.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "sat-log.h"
+#include "sat-propagator.h"
+
+
+/* Length of the ephemeris cache windows in minutes */
+#define EPHEM_CACHE_SPAN 10.0
+
+struct _sat_propagator {
+    gint            ref;        /*!< The owner, a running request and its
+                                     idle callback each hold a reference */
+    gint            running;    /*!< Set while a request is running */
+    gint            cancelled;  /*!< Set by sat_propagator_free() */
+    guint           num;        /*!< Number of satellites */
+    sat_t          *sats;       /*!< The satellites, main loop only */
+    sat_t          *work;       /*!< Copies of the satellites, worker only */
+    sgp4_batch_t   *batch;      /*!< Near-earth copies, NULL if not used */
+    ephem_cache_t  *ephem;      /*!< Ephemeris caches, NULL if disabled */
+    gdouble         slow;       /*!< Slow update period [days], 0 if off */
+    gdouble        *hint;       /*!< Slow update allowed before this time,
+                                     main loop only */
+    gdouble        *until;      /*!< Copy of hint for the running request */
+    pass_detail_t  *prev;       /*!< Second last calculation, worker only */
+    pass_detail_t  *last;       /*!< Last calculation, worker only */
+    obs_ctx_t       ctx;        /*!< Observer for the current request */
+    sat_snapshot_t  snap[2];    /*!< The snapshots */
+    sat_snapshot_t *current;    /*!< Published snapshot or NULL */
+    sat_propagator_ready_fn ready;      /*!< Called for a new snapshot */
+    gpointer        data;       /*!< User data for ready */
+};
+
+static GThreadPool *pool = NULL;
+
+
+/** \brief Drop a reference and free the propagator with the last one. */
+static void sat_propagator_unref(sat_propagator_t * prop)
+{
+    if (!g_atomic_int_dec_and_test(&prop->ref))
+        return;
+
+    if (prop->batch != NULL)
+        SGP4_Batch_Free(prop->batch);
+
+    g_free(prop->ephem);
+    g_free(prop->hint);
+    g_free(prop->until);
+    g_free(prop->prev);
+    g_free(prop->last);
+    g_free(prop->snap[0].data);
+    g_free(prop->snap[1].data);
+    g_free(prop->work);
+    g_free(prop);
+}
+
+/**
+ * \brief Build the batch of near-earth satellites.
+ *
+ * Deep-space satellites are not part of the batch. If the batch can not
+ * be created, prop->batch is NULL and all satellites are propagated one
+ * by one.
+ */
+static void sat_propagator_build_batch(sat_propagator_t * prop)
+{
+    guint           i;
+
+    prop->batch = SGP4_Batch_Create(prop->num);
+    if (prop->batch == NULL)
+        return;
+
+    for (i = 0; i < prop->num; i++)
+    {
+        if (prop->work[i].flags & DEEP_SPACE_EPHEM_FLAG)
+            continue;
+
+        if (SGP4_Batch_Add(prop->batch, &prop->work[i]) < 0)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Failed to add #%d to SGP4 batch"),
+                        __func__, prop->work[i].tle.catnr);
+            SGP4_Batch_Free(prop->batch);
+            prop->batch = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Check whether a satellite can be extrapolated in this request.
+ *
+ * A satellite is calculated when it is not allowed to be slow, when
+ * there are no two earlier calculations to extrapolate from, when the
+ * time has been moved back and once per slow period.
+ */
+static gboolean sat_propagator_is_slow(const sat_propagator_t * prop,
+                                       guint i)
+{
+    const pass_detail_t *prev;
+    const pass_detail_t *last;
+    gdouble         t = prop->ctx.time;
+
+    if (prop->slow <= 0.0 || t >= prop->until[i])
+        return FALSE;
+
+    prev = &prop->prev[i];
+    last = &prop->last[i];
+
+    return (prev->time > 0.0 && last->time > prev->time &&
+            t >= last->time && t < last->time + prop->slow);
+}
+
+/**
+ * \brief Extrapolate an angle.
+ * \param a0 The earlier value.
+ * \param a1 The later value.
+ * \param f Time from a1 to the new value relative to the time from a0.
+ * \param min The lower limit of the range of the angle.
+ * \param period The length of the range of the angle.
+ *
+ * The angle is assumed to have moved the short way from a0 to a1. The
+ * result is in the range of the angle.
+ */
+static gdouble extrapolate_angle(gdouble a0, gdouble a1, gdouble f,
+                                 gdouble min, gdouble period)
+{
+    gdouble         d = a1 - a0;
+    gdouble         a;
+
+    d -= period * floor(d / period + 0.5);
+    a = a1 + f * d;
+
+    return a - period * floor((a - min) / period);
+}
+
+/**
+ * \brief Extrapolate the satellite to the time of the request.
+ *
+ * The entry of the last calculation is reused as it is, except for the
+ * time and the sub-satellite point, which is moved on linearly from the
+ * last two calculations. Over a slow period of a low orbit this is good
+ * to a few hundredths of a degree, except close to the poles where the
+ * longitude changes fast. The other data, e.g. azimuth and elevation, lag
+ * behind by up to one slow period; the satellite is far from AOS, so it
+ * does not matter.
+ */
+static void sat_propagator_extrapolate(const sat_propagator_t * prop,
+                                       guint i, pass_detail_t * d)
+{
+    const pass_detail_t *prev = &prop->prev[i];
+    const pass_detail_t *last = &prop->last[i];
+    gdouble         f;
+
+    f = (prop->ctx.time - last->time) / (last->time - prev->time);
+
+    *d = *last;
+    d->time = prop->ctx.time;
+    d->lat = CLAMP(last->lat + f * (last->lat - prev->lat), -90.0, 90.0);
+    d->lon = extrapolate_angle(prev->lon, last->lon, f, -180.0, 360.0);
+}
+
+/** \brief Deliver a new snapshot in the main loop. */
+static gboolean sat_propagator_ready_idle(gpointer data)
+{
+    sat_propagator_t *prop = data;
+
+    if (!g_atomic_int_get(&prop->cancelled) && prop->ready != NULL)
+        prop->ready(prop, prop->data);
+
+    sat_propagator_unref(prop);
+
+    return FALSE;
+}
+
+/** \brief Propagate all satellites; this is the thread pool function. */
+static void sat_propagator_run(gpointer data, gpointer user_data)
+{
+    sat_propagator_t *prop = data;
+    sat_snapshot_t *snap;
+    pass_detail_t  *d;
+    sat_t          *sat;
+    gint64          start = g_get_monotonic_time();
+    guint           i, j;
+
+    (void)user_data;
+
+    if (g_atomic_int_get(&prop->cancelled))
+    {
+        g_atomic_int_set(&prop->running, 0);
+        sat_propagator_unref(prop);
+        return;
+    }
+
+    /* the snapshot that is not published */
+    if (g_atomic_pointer_get(&prop->current) == &prop->snap[0])
+        snap = &prop->snap[1];
+    else
+        snap = &prop->snap[0];
+
+    /* leave the slow satellites out of the batch; the near-earth
+       satellites were added in order, see sat_propagator_build_batch() */
+    if (prop->ephem == NULL && prop->batch != NULL)
+    {
+        for (i = 0, j = 0; i < prop->num; i++)
+        {
+            if (!(prop->work[i].flags & DEEP_SPACE_EPHEM_FLAG))
+                prop->batch->skip[j++] = sat_propagator_is_slow(prop, i);
+        }
+
+        SGP4_Batch_Propagate(prop->batch, prop->ctx.time);
+    }
+
+    for (i = 0; i < prop->num; i++)
+    {
+        sat = &prop->work[i];
+        d = &snap->data[i];
+
+        if (sat_propagator_is_slow(prop, i))
+        {
+            sat_propagator_extrapolate(prop, i, d);
+            continue;
+        }
+
+        if (prop->ephem != NULL)
+            predict_calc_cached(sat, &prop->ephem[i], &prop->ctx);
+        else if (prop->batch == NULL || (sat->flags & DEEP_SPACE_EPHEM_FLAG))
+            predict_calc_ctx(sat, &prop->ctx);
+        else
+            predict_calc_obs(sat, &prop->ctx);
+
+        d->time = sat->jul_utc;
+        d->pos = sat->pos;
+        d->vel = sat->vel;
+        d->velo = sat->velo;
+        d->az = sat->az;
+        d->el = sat->el;
+        d->range = sat->range;
+        d->range_rate = sat->range_rate;
+        d->lat = sat->ssplat;
+        d->lon = sat->ssplon;
+        d->alt = sat->alt;
+        d->ma = sat->ma;
+        d->phase = sat->phase;
+        d->footprint = sat->footprint;
+        d->orbit = sat->orbit;
+
+        if (prop->slow > 0.0)
+        {
+            prop->prev[i] = prop->last[i];
+            prop->last[i] = *d;
+        }
+    }
+    snap->time = prop->ctx.time;
+    snap->usec = g_get_monotonic_time() - start;
+
+    g_atomic_pointer_set(&prop->current, snap);
+    g_atomic_int_set(&prop->running, 0);
+
+    /* the reference of the request goes to the idle callback */
+    g_idle_add(sat_propagator_ready_idle, prop);
+}
+
+/**
+ * \brief Create a propagator.
+ * \param sats The satellites, e.g. of a module.
+ * \param ephem_tol Tolerance of the ephemeris cache [m], 0 to disable it.
+ * \param slow_period Period of the slow updates [s], 0 to disable them.
+ * \param ready Function to call in the main loop for a new snapshot.
+ * \param data User data for ready.
+ * \return The new propagator.
+ *
+ * The satellites are copied, so the propagator must be recreated when
+ * they are reloaded. The array must not be cleared or loaded again until
+ * the propagator is freed, since sat_propagator_apply() updates the
+ * satellites in it. The snapshots are in the order of the array.
+ */
+sat_propagator_t *sat_propagator_new(sat_array_t * sats, gint ephem_tol,
+                                     gint slow_period,
+                                     sat_propagator_ready_fn ready,
+                                     gpointer data)
+{
+    sat_propagator_t *prop = g_new0(sat_propagator_t, 1);
+    guint           i;
+
+    prop->ref = 1;
+    prop->ready = ready;
+    prop->data = data;
+    prop->num = sats->num;
+    prop->sats = sats->sats;
+    prop->work = g_new(sat_t, prop->num);
+
+    for (i = 0; i < prop->num; i++)
+    {
+        /* the strings are owned by the original and not needed */
+        prop->work[i] = sats->sats[i];
+        prop->work[i].name = NULL;
+        prop->work[i].nickname = NULL;
+        prop->work[i].website = NULL;
+    }
+
+    prop->snap[0].num = prop->num;
+    prop->snap[0].data = g_new0(pass_detail_t, prop->num);
+    prop->snap[1].num = prop->num;
+    prop->snap[1].data = g_new0(pass_detail_t, prop->num);
+
+    if (slow_period > 0)
+    {
+        prop->slow = slow_period / 86400.0;
+        prop->hint = g_new0(gdouble, prop->num);
+        prop->until = g_new0(gdouble, prop->num);
+        prop->prev = g_new0(pass_detail_t, prop->num);
+        prop->last = g_new0(pass_detail_t, prop->num);
+    }
+
+    if (ephem_tol > 0)
+    {
+        prop->ephem = g_new(ephem_cache_t, prop->num);
+        for (i = 0; i < prop->num; i++)
+            Ephem_Cache_Init(&prop->ephem[i], EPHEM_CACHE_SPAN,
+                             ephem_tol / 1000.0);
+    }
+    else
+    {
+        sat_propagator_build_batch(prop);
+    }
+
+    return prop;
+}
+
+/**
+ * \brief Free a propagator.
+ * \param prop The propagator.
+ *
+ * A running request is not waited for; its result is dropped and the
+ * ready callback is not called any more. The caller must not use prop
+ * after this call.
+ */
+void sat_propagator_free(sat_propagator_t * prop)
+{
+    g_atomic_int_set(&prop->cancelled, 1);
+    sat_propagator_unref(prop);
+}
+
+/**
+ * \brief Start propagating the satellites.
+ * \param prop The propagator.
+ * \param qth The ground station; only the position is used.
+ * \param t The time (Julian Date).
+ * \return TRUE if the request was started, FALSE if the previous one is
+ *         still running.
+ *
+ * The satellites are propagated on a worker thread and the ready callback
+ * is called in the main loop when the new snapshot has been published.
+ * Until then sat_propagator_snapshot() returns the previous one.
+ */
+gboolean sat_propagator_request(sat_propagator_t * prop, qth_t * qth,
+                                gdouble t)
+{
+    GError         *err = NULL;
+
+    if (!g_atomic_int_compare_and_exchange(&prop->running, 0, 1))
+        return FALSE;
+
+    if (pool == NULL)
+    {
+        pool = g_thread_pool_new(sat_propagator_run, NULL,
+                                 MAX(g_get_num_processors(), 1), FALSE, &err);
+        if (pool == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create thread pool: %s"),
+                        __func__, err->message);
+            g_clear_error(&err);
+        }
+    }
+
+    predict_obs_context(&prop->ctx, qth, t);
+    if (prop->slow > 0.0)
+        memcpy(prop->until, prop->hint, prop->num * sizeof(gdouble));
+    g_atomic_int_inc(&prop->ref);
+
+    /* without a pool we can still do the work, just not in parallel */
+    if (pool == NULL || !g_thread_pool_push(pool, prop, NULL))
+        sat_propagator_run(prop, NULL);
+
+    return TRUE;
+}
+
+/**
+ * \brief Allow a satellite to be updated at the slow rate.
+ * \param prop The propagator.
+ * \param i The index of the satellite in the satellite array.
+ * \param until The slow rate is allowed for requests before this time
+ *              (Julian Date); 0.0 for the full rate.
+ *
+ * This must be called from the main loop and applies from the next
+ * sat_propagator_request(). All satellites start at the full rate.
+ * Nothing is done if the slow updates are disabled.
+ */
+void sat_propagator_set_slow(sat_propagator_t * prop, guint i, gdouble until)
+{
+    if (prop->slow > 0.0 && i < prop->num)
+        prop->hint[i] = until;
+}
+
+/**
+ * \brief Get the published snapshot.
+ * \param prop The propagator.
+ * \return The latest snapshot or NULL if there is none yet.
+ *
+ * This must be called from the main loop. The snapshot stays valid until
+ * the next call to sat_propagator_request().
+ */
+const sat_snapshot_t *sat_propagator_snapshot(sat_propagator_t * prop)
+{
+    return g_atomic_pointer_get(&prop->current);
+}
+
+/**
+ * \brief Copy the published snapshot to the satellites.
+ * \param prop The propagator.
+ * \return The time of the snapshot, 0.0 if there is none yet.
+ *
+ * This must be called from the main loop. Only the time dependent data of
+ * the satellites given to sat_propagator_new() is changed; their
+ * propagator state is left as it is.
+ */
+gdouble sat_propagator_apply(sat_propagator_t * prop)
+{
+    const sat_snapshot_t *snap = sat_propagator_snapshot(prop);
+    const pass_detail_t *d;
+    sat_t          *sat;
+    guint           i;
+
+    if (snap == NULL)
+        return 0.0;
+
+    for (i = 0; i < snap->num; i++)
+    {
+        d = &snap->data[i];
+        sat = &prop->sats[i];
+
+        sat->jul_utc = d->time;
+        sat->tsince = (d->time - sat->jul_epoch) * xmnpda;
+        sat->pos = d->pos;
+        sat->vel = d->vel;
+        sat->velo = d->velo;
+        sat->az = d->az;
+        sat->el = d->el;
+        sat->range = d->range;
+        sat->range_rate = d->range_rate;
+        sat->ssplat = d->lat;
+        sat->ssplon = d->lon;
+        sat->alt = d->alt;
+        sat->ma = d->ma;
+        sat->phase = d->phase;
+        sat->footprint = d->footprint;
+        sat->orbit = d->orbit;
+    }
+
+    return snap->time;
+}
@@ -0,0 +1,76 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_PROPAGATOR_H
+#define SAT_PROPAGATOR_H 1
+
+#include <glib.h>
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sat-array.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/**
+ * \brief State of all satellites of a propagator at one time.
+ *
+ * A snapshot is filled by the worker and never changed after it has been
+ * published, see sat_propagator_snapshot().
+ */
+typedef struct {
+    gdouble         time;       /*!< Time in "jul_utc" */
+    gint64          usec;       /*!< Time the worker took [usec] */
+    guint           num;        /*!< Number of satellites */
+    pass_detail_t  *data;       /*!< One entry per satellite, in the order
+                                     of the satellite array (no vis) */
+} sat_snapshot_t;
+
+/** \brief Propagation worker for a set of satellites. */
+typedef struct _sat_propagator sat_propagator_t;
+
+/**
+ * \brief Callback for a new snapshot.
+ * \param prop The propagator.
+ * \param data The user data given to sat_propagator_new().
+ *
+ * Called in the main loop after the worker has published a snapshot.
+ */
+typedef void    (*sat_propagator_ready_fn) (sat_propagator_t * prop,
+                                            gpointer data);
+
+sat_propagator_t *sat_propagator_new(sat_array_t * sats, gint ephem_tol,
+                                     gint slow_period,
+                                     sat_propagator_ready_fn ready,
+                                     gpointer data);
+void            sat_propagator_free(sat_propagator_t * prop);
+gboolean        sat_propagator_request(sat_propagator_t * prop, qth_t * qth,
+                                       gdouble t);
+void            sat_propagator_set_slow(sat_propagator_t * prop, guint i,
+                                        gdouble until);
+const sat_snapshot_t *sat_propagator_snapshot(sat_propagator_t * prop);
+gdouble         sat_propagator_apply(sat_propagator_t * prop);
+
+#endif
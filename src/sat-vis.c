@@ -32,6 +32,8 @@
 #include "gtk-sat-data.h"
 #include "sat-vis.h"
 #include "sat-cfg.h"
+#include "predict-tools.h"
+#include "solar-cache.h"
 
 
 static gchar VIS2CHR[SAT_VIS_NUM] = { '-', 'V', 'D', 'E'};
@@ -55,51 +57,53 @@ static gchar *VIS2STR[SAT_VIS_NUM] = {
 sat_vis_t
 get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc)
 {
-    gboolean sat_sun_status;
+    obs_frame_t frame;
+
+    predict_obs_frame (&frame, qth);
+
+    return get_sat_vis_thld (&sat->pos, sat->el, &frame, jul_utc,
+                             sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD));
+}
+
+
+/** \brief Calculate satellite visibility using a given twilight threshold.
+ *  \param pos The ECI position of the satellite [km].
+ *  \param el The elevation of the satellite [deg].
+ *  \param frame The observer frame of the QTH, see predict_obs_frame().
+ *  \param jul_utc The time at which the visibility should be calculated.
+ *  \param threshold Sun elevation below which the satellite can be seen [deg].
+ *  \return The visibility code.
+ *
+ * Same as get_sat_vis() but does not need a sat_t and does not read the
+ * configuration, so it can be used outside the main thread. The position
+ * of the sun is taken from the solar cache, see solar-cache.c.
+ */
+sat_vis_t
+get_sat_vis_thld (vector_t *pos, gdouble el, const obs_frame_t *frame,
+                  gdouble jul_utc, gdouble threshold)
+{
     gdouble  sun_el;
-    gdouble  threshold;
     gdouble  eclipse_depth;
     sat_vis_t vis = SAT_VIS_NONE;
-    vector_t zero_vector = {0,0,0,0};
-    geodetic_t obs_geodetic;
 
     /* Solar ECI position vector  */
-    vector_t solar_vector=zero_vector;
-
-    /* Solar observed az and el vector  */
-    obs_set_t solar_set;
-
-    /* FIXME: could be passed as parameter */
-    obs_geodetic.lon = qth->lon * de2ra;
-    obs_geodetic.lat = qth->lat * de2ra;
-    obs_geodetic.alt = qth->alt / 1000.0;
-    obs_geodetic.theta = 0;
-
+    vector_t solar_vector;
 
-    Calculate_Solar_Position (jul_utc, &solar_vector);
-    Calculate_Obs (jul_utc, &solar_vector, &zero_vector, &obs_geodetic, &solar_set);
+    solar_cache_pos (jul_utc, &solar_vector);
 
-    if (Sat_Eclipsed (&sat->pos, &solar_vector, &eclipse_depth)) {
+    if (Sat_Eclipsed (pos, &solar_vector, &eclipse_depth)) {
         /* satellite is eclipsed */
-        sat_sun_status = FALSE;
+        vis = SAT_VIS_ECLIPSED;
     }
     else {
         /* satellite in sunlight => may be visible */
-        sat_sun_status = TRUE;
-    }
+        sun_el = solar_cache_el (jul_utc, &solar_vector, frame);
 
-
-    if (sat_sun_status) {
-        sun_el = Degrees (solar_set.el);
-        threshold = (gdouble) sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD);
-        
-        if (sun_el <= threshold && sat->el >= 0.0)
+        if (sun_el <= threshold && el >= 0.0)
             vis = SAT_VIS_VISIBLE;
         else
             vis = SAT_VIS_DAYLIGHT;
     }
-    else
-        vis = SAT_VIS_ECLIPSED;
 
 
     return vis;
@@ -50,6 +50,9 @@ typedef enum {
 
 
 sat_vis_t  get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc);
+sat_vis_t  get_sat_vis_thld (vector_t *pos, gdouble el,
+                             const obs_frame_t *frame, gdouble jul_utc,
+                             gdouble threshold);
 gchar      vis_to_chr  (sat_vis_t vis);
 gchar     *vis_to_str  (sat_vis_t vis);
 
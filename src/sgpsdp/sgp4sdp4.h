@@ -96,6 +96,34 @@ typedef struct {
     double          w;          /*!< Magnitude */
 } vector_t;
 
+/** \brief Observer frame with the time independent terms precomputed.
+ *  \ingroup sgpsdpif
+ *
+ * See Obs_Frame_Init() and Calculate_User_Frame().
+ */
+typedef struct {
+    double          lon;        /*!< Longitude [rad] */
+    double          sin_lat;    /*!< Sine of the latitude */
+    double          cos_lat;    /*!< Cosine of the latitude */
+    double          achcp;      /*!< Distance from the earth axis [km] */
+    double          z;          /*!< Distance from the equator plane [km] */
+} obs_frame_t;
+
+/** \brief Observer state at a given time, shared by all satellites.
+ *  \ingroup sgpsdpif
+ *
+ * See Obs_Context_Init(), Calculate_Obs_Context() and
+ * Calculate_LatLonAlt_Context().
+ */
+typedef struct {
+    double          time;       /*!< Time (Julian date) */
+    double          thetag;     /*!< Greenwich sidereal time [rad] */
+    double          theta;      /*!< Local sidereal time [rad] */
+    double          rot[3][3];  /*!< ECI to topocentric south, east, zenith */
+    vector_t        obs_pos;    /*!< Observer position in ECI [km] */
+    vector_t        obs_vel;    /*!< Observer velocity in ECI [km/s] */
+} obs_ctx_t;
+
 
 /** \brief Bearing to satellite from observer
  *  \ingroup sgpsdpif
@@ -119,9 +147,6 @@ typedef struct {
     double          eosq, sinio, cosio, betao, aodp, theta2, sing, cosg;
     double          betao2, xmdot, omgdot, xnodot, xnodp;
 
-    /* Used by dpsec and dpper parts of Deep() */
-    double          xll, omgadf, xnode, em, xinc, xn, t;
-
     /* Used by thetg and Deep() */
     double          ds50;
 } deep_arg_t;
@@ -137,18 +162,45 @@ typedef struct {
 
 /* static data for DEEP */
 typedef struct {
-    double          thgr, xnq, xqncl, omegaq, zmol, zmos, savtsn, ee2, e3, xi2;
+    double          thgr, xnq, xqncl, omegaq, zmol, zmos, ee2, e3, xi2;
     double          xl2, xl3, xl4, xgh2, xgh3, xgh4, xh2, xh3, sse, ssi, ssg,
         xi3;
     double          se2, si2, sl2, sgh2, sh2, se3, si3, sl3, sgh3, sh3, sl4,
         sgh4;
     double          ssl, ssh, d3210, d3222, d4410, d4422, d5220, d5232, d5421;
     double          d5433, del1, del2, del3, fasx2, fasx4, fasx6, xlamo, xfact;
-    double          xni, atime, stepp, stepn, step2, preep, pl, sghs, xli;
-    double          d2201, d2211, sghl, sh1, pinc, pe, shs, zsingl, zcosgl;
+    double          stepp, stepn, step2, preep;
+    double          d2201, d2211, zsingl, zcosgl;
     double          zsinhl, zcoshl, zsinil, zcosil;
 } deep_static_t;
 
+/**
+ * \brief Propagator state.
+ * \ingroup sgpsdpif
+ *
+ * The values SGP4_Eval() and SDP4_Eval() modify while propagating.
+ * The sat_t holding the elements and the initialization constants is
+ * only read, so one initialized sat_t can be shared by several states,
+ * e.g. one per thread or one per what-if prediction.
+ */
+typedef struct {
+    /* Used by dpsec and dpper parts of Deep() */
+    double          xll, omgadf, xnode, em, xinc, xn, t;
+
+    /* Resonance integrator and lunar-solar periodics of Deep() */
+    double          xli, xni, atime, savtsn, sghs, shs, sghl, sh1, pe, pinc,
+        pl;
+
+    vector_t        pos;        /*!< Raw position */
+    vector_t        vel;        /*!< Raw velocity */
+    double          phase;      /*!< Orbit phase [rad] */
+
+    /* values needed for squint calculations */
+    double          xincl1;
+    double          xnodeo1;
+    double          omegao1;
+} sgpsdp_state_t;
+
 /**
  * \brief Satellite data structure
  * \ingroup sgpsdpif
@@ -163,6 +215,7 @@ typedef struct {
     sgpsdp_static_t sgps;
     deep_static_t   dps;
     deep_arg_t      deep_arg;
+    sgpsdp_state_t  state;      /*!< State used by SGP4() and SDP4() */
     vector_t        pos;        /*!< Raw position and range */
     vector_t        vel;        /*!< Raw velocity */
 
@@ -196,6 +249,66 @@ typedef struct {
 #define SAT(sat)  ((sat_t *) sat)
 
 
+/**
+ * \brief Batch of near-earth satellites for SGP4 propagation.
+ * \ingroup sgpsdpif
+ *
+ * The TLE fields and sgpsdp_static_t constants of each satellite are
+ * stored in structure-of-arrays form so that all satellites can be
+ * propagated to the same time in one pass, see sgp_batch.c.
+ * The batch does not own the satellites.
+ */
+typedef struct {
+    int             num;        /*!< Number of satellites in the batch */
+    int             size;       /*!< Allocated number of entries */
+    sat_t         **sats;       /*!< The satellites */
+    int            *done;       /*!< Kepler iteration converged */
+    int            *skip;       /*!< Left out of SGP4_Batch_Propagate(),
+                                     set by the caller */
+
+    /* TLE fields and SGP4 initialization constants */
+    double         *xmo, *omegao, *xnodeo, *eo, *xincl, *bstar, *jul_epoch;
+    double         *simple;     /*!< 1.0 if SIMPLE_FLAG is set */
+    double         *aodp, *aycof, *c1, *c4, *c5, *cosio, *d2, *d3, *d4;
+    double         *delmo, *omgcof, *eta, *omgdot, *sinio, *xnodp, *sinmo;
+    double         *t2cof, *t3cof, *t4cof, *t5cof, *x1mth2, *x3thm1, *x7thm1;
+    double         *xmcof, *xmdot, *xnodcf, *xnodot, *xlcof;
+
+    /* intermediate values */
+    double         *tsince, *a, *xn, *xnode, *omgadf, *omega, *xlt;
+    double         *axn, *ayn, *capu, *epw;
+
+    /* results, same units as SGP4 */
+    double         *x, *y, *z, *vx, *vy, *vz, *phase, *xnodek, *xinck;
+} sgp4_batch_t;
+
+
+/** \brief Number of Chebyshev coefficients per channel in ephem_cache_t */
+#define EPHEM_NUM_COEFFS    8
+
+/** \brief Number of interpolated values in ephem_cache_t (pos, vel, phase) */
+#define EPHEM_NUM_CHANNELS  7
+
+/**
+ * \brief Chebyshev ephemeris cache for one satellite.
+ * \ingroup sgpsdpif
+ *
+ * Holds Chebyshev fits of the SGP4/SDP4 position, velocity and phase over
+ * a short time window so that nearby times can be evaluated without
+ * running the propagator, see sgp_cheb.c.
+ */
+typedef struct {
+    double          span;       /*!< Nominal window length [min] */
+    double          tol;        /*!< Max position error [km] */
+    double          tstart;     /*!< Window start, tsince [min] */
+    double          tend;       /*!< Window end, tsince [min] */
+    int             valid;      /*!< The window contains a usable fit */
+    int             direct;     /*!< No fit possible, propagate directly */
+    long            fits;       /*!< Number of fits done (statistics) */
+    double          c[EPHEM_NUM_CHANNELS][EPHEM_NUM_COEFFS];
+} ephem_cache_t;
+
+
 /** Table of constant values **/
 #define de2ra    1.74532925E-2  /* Degrees to Radians */
 #define pi       3.1415926535898        /* Pi */
@@ -261,7 +374,10 @@ FIXME: Change to enu */
 #define CR  0x0A
 #define LF  0x0D
 
-/* Flow control flag definitions */
+/* Flow control flag definitions.
+   These are kept per satellite in sat_t.flags; the library has no
+   global state and can be used from several threads as long as each
+   sat_t is only touched by one thread at a time. */
 #define ALL_FLAGS              -1
 #define SGP_INITIALIZED_FLAG   0x000001
 #define SGP4_INITIALIZED_FLAG  0x000002
@@ -286,11 +402,26 @@ FIXME: Change to enu */
 /* sgp4sdp4.c */
 void            SGP4(sat_t * sat, double tsince);
 void            SDP4(sat_t * sat, double tsince);
+void            SGP4_Eval(const sat_t * sat, sgpsdp_state_t * state,
+                          double tsince);
+void            SDP4_Eval(const sat_t * sat, sgpsdp_state_t * state,
+                          double tsince);
 void            Deep(int ientry, sat_t * sat);
-int             isFlagSet(int flag);
-int             isFlagClear(int flag);
-void            SetFlag(int flag);
-void            ClearFlag(int flag);
+
+/* sgp_batch.c */
+sgp4_batch_t   *SGP4_Batch_Create(int size);
+int             SGP4_Batch_Reserve(sgp4_batch_t * batch, int size);
+void            SGP4_Batch_Free(sgp4_batch_t * batch);
+void            SGP4_Batch_Clear(sgp4_batch_t * batch);
+int             SGP4_Batch_Add(sgp4_batch_t * batch, sat_t * sat);
+void            SGP4_Batch_Propagate(sgp4_batch_t * batch, double jul_utc);
+
+/* sgp_cheb.c */
+void            Ephem_Cache_Init(ephem_cache_t * cache, double span,
+                                 double tol);
+void            Ephem_Cache_Reset(ephem_cache_t * cache);
+void            Ephem_Cache_Propagate(sat_t * sat, ephem_cache_t * cache,
+                                      double tsince);
 
 /* sgp_in.c */
 int             Checksum_Good(char *tle_set);
@@ -334,6 +465,17 @@ void            Calculate_Obs(double _time, vector_t * pos, vector_t * vel,
 void            Calculate_RADec_and_Obs(double _time, vector_t * pos,
                                         vector_t * vel, geodetic_t * geodetic,
                                         obs_astro_t * obs_set);
+void            Obs_Frame_Init(geodetic_t * geodetic, obs_frame_t * frame);
+void            Calculate_User_Frame(double _time, const obs_frame_t * frame,
+                                     vector_t * obs_pos, vector_t * obs_vel,
+                                     vector_t * up);
+void            Obs_Context_Init(double _time, const obs_frame_t * frame,
+                                 obs_ctx_t * ctx);
+void            Calculate_Obs_Context(const obs_ctx_t * ctx, vector_t * pos,
+                                      vector_t * vel, obs_set_t * obs_set);
+void            Calculate_LatLonAlt_Context(const obs_ctx_t * ctx,
+                                            vector_t * pos,
+                                            geodetic_t * geodetic);
 
 /* sgp_time.c */
 double          Julian_Date_of_Epoch(double epoch);
@@ -0,0 +1,497 @@
+/*
+ * Unit SGP_Batch
+ *
+ * Structure-of-arrays version of the SGP4 propagator.
+ *
+ * The near-earth constants (sgpsdp_static_t) and the needed TLE fields
+ * of many satellites are kept in contiguous arrays so that all of them
+ * can be propagated to the same Julian date in a few tight loops. The
+ * loops contain no calls between satellites and no data dependencies
+ * across iterations, which allows the compiler to vectorize them
+ * (e.g. gcc -O3 with a vector math library); otherwise they simply run
+ * as scalar loops.
+ *
+ * The arithmetic is a verbatim copy of the time dependent part of SGP4()
+ * in sgp4sdp4.c, performed in the same order, so the results are
+ * identical to calling SGP4() on each satellite (as long as the compiler
+ * is not allowed to contract the two code paths into FMA instructions
+ * differently, see -ffp-contract).
+ *
+ * Deep-space satellites are not handled here; SDP4() carries integrator
+ * state between calls and must still be called one satellite at a time.
+ *
+ * The caller can leave satellites out of a propagation by setting their
+ * entry in batch->skip, e.g. those that are only updated at a slow rate.
+ * Their lanes are not calculated and their sat_t is not touched.
+ */
+
+#include "sgp4sdp4.h"
+
+/* Number of per-satellite arrays in sgp4_batch_t */
+#define BATCH_NUM_FIELDS 56
+
+/* Collect pointers to all per-satellite arrays so that they
+   can be (re)allocated and freed in one loop */
+static int Batch_Fields(sgp4_batch_t * b, double **f[BATCH_NUM_FIELDS])
+{
+    int             i = 0;
+
+    /* element and initialization constants */
+    f[i++] = &b->xmo;
+    f[i++] = &b->omegao;
+    f[i++] = &b->xnodeo;
+    f[i++] = &b->eo;
+    f[i++] = &b->xincl;
+    f[i++] = &b->bstar;
+    f[i++] = &b->jul_epoch;
+    f[i++] = &b->simple;
+    f[i++] = &b->aodp;
+    f[i++] = &b->aycof;
+    f[i++] = &b->c1;
+    f[i++] = &b->c4;
+    f[i++] = &b->c5;
+    f[i++] = &b->cosio;
+    f[i++] = &b->d2;
+    f[i++] = &b->d3;
+    f[i++] = &b->d4;
+    f[i++] = &b->delmo;
+    f[i++] = &b->omgcof;
+    f[i++] = &b->eta;
+    f[i++] = &b->omgdot;
+    f[i++] = &b->sinio;
+    f[i++] = &b->xnodp;
+    f[i++] = &b->sinmo;
+    f[i++] = &b->t2cof;
+    f[i++] = &b->t3cof;
+    f[i++] = &b->t4cof;
+    f[i++] = &b->t5cof;
+    f[i++] = &b->x1mth2;
+    f[i++] = &b->x3thm1;
+    f[i++] = &b->x7thm1;
+    f[i++] = &b->xmcof;
+    f[i++] = &b->xmdot;
+    f[i++] = &b->xnodcf;
+    f[i++] = &b->xnodot;
+    f[i++] = &b->xlcof;
+
+    /* intermediate values */
+    f[i++] = &b->tsince;
+    f[i++] = &b->a;
+    f[i++] = &b->xn;
+    f[i++] = &b->xnode;
+    f[i++] = &b->omgadf;
+    f[i++] = &b->omega;
+    f[i++] = &b->xlt;
+    f[i++] = &b->axn;
+    f[i++] = &b->ayn;
+    f[i++] = &b->capu;
+    f[i++] = &b->epw;
+
+    /* results */
+    f[i++] = &b->x;
+    f[i++] = &b->y;
+    f[i++] = &b->z;
+    f[i++] = &b->vx;
+    f[i++] = &b->vy;
+    f[i++] = &b->vz;
+    f[i++] = &b->phase;
+    f[i++] = &b->xnodek;
+    f[i++] = &b->xinck;
+
+    return i;
+}
+
+/* Create a new, empty batch with room for size satellites */
+sgp4_batch_t   *SGP4_Batch_Create(int size)
+{
+    sgp4_batch_t   *batch;
+
+    batch = calloc(1, sizeof(sgp4_batch_t));
+    if (batch == NULL)
+        return NULL;
+
+    if (size < 16)
+        size = 16;
+
+    if (!SGP4_Batch_Reserve(batch, size))
+    {
+        SGP4_Batch_Free(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+/* Make room for at least size satellites; returns 0 on failure */
+int SGP4_Batch_Reserve(sgp4_batch_t * batch, int size)
+{
+    double        **fields[BATCH_NUM_FIELDS];
+    double         *arr;
+    sat_t         **sats;
+    int            *done;
+    int            *skip;
+    int             i, n;
+
+    if (size <= batch->size)
+        return 1;
+
+    n = Batch_Fields(batch, fields);
+    for (i = 0; i < n; i++)
+    {
+        arr = realloc(*fields[i], size * sizeof(double));
+        if (arr == NULL)
+            return 0;
+        *fields[i] = arr;
+    }
+
+    sats = realloc(batch->sats, size * sizeof(sat_t *));
+    if (sats == NULL)
+        return 0;
+    batch->sats = sats;
+
+    done = realloc(batch->done, size * sizeof(int));
+    if (done == NULL)
+        return 0;
+    batch->done = done;
+
+    skip = realloc(batch->skip, size * sizeof(int));
+    if (skip == NULL)
+        return 0;
+    batch->skip = skip;
+
+    batch->size = size;
+
+    return 1;
+}
+
+/* Free a batch; the satellites themselves are not touched */
+void SGP4_Batch_Free(sgp4_batch_t * batch)
+{
+    double        **fields[BATCH_NUM_FIELDS];
+    int             i, n;
+
+    if (batch == NULL)
+        return;
+
+    n = Batch_Fields(batch, fields);
+    for (i = 0; i < n; i++)
+        free(*fields[i]);
+
+    free(batch->sats);
+    free(batch->done);
+    free(batch->skip);
+    free(batch);
+}
+
+/* Remove all satellites from the batch but keep the allocated memory */
+void SGP4_Batch_Clear(sgp4_batch_t * batch)
+{
+    batch->num = 0;
+}
+
+/* Add a satellite to the batch.
+   Returns the index of the satellite in the batch or -1 if the satellite
+   uses the deep-space ephemeris or memory could not be allocated.
+   The SGP4 constants are initialised if that has not already been done,
+   in which case the position of sat is updated to epoch. The batch copies
+   the constants, so satellites with new elements must be added again. */
+int SGP4_Batch_Add(sgp4_batch_t * batch, sat_t * sat)
+{
+    int             i;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        return -1;
+
+    if (batch->num == batch->size &&
+        !SGP4_Batch_Reserve(batch, 2 * batch->size))
+        return -1;
+
+    if (~sat->flags & SGP4_INITIALIZED_FLAG)
+        SGP4(sat, 0.0);
+
+    i = batch->num++;
+
+    batch->sats[i] = sat;
+    batch->skip[i] = 0;
+    batch->xmo[i] = sat->tle.xmo;
+    batch->omegao[i] = sat->tle.omegao;
+    batch->xnodeo[i] = sat->tle.xnodeo;
+    batch->eo[i] = sat->tle.eo;
+    batch->xincl[i] = sat->tle.xincl;
+    batch->bstar[i] = sat->tle.bstar;
+    batch->jul_epoch[i] = sat->jul_epoch;
+    batch->simple[i] = (sat->flags & SIMPLE_FLAG) ? 1.0 : 0.0;
+    batch->aodp[i] = sat->sgps.aodp;
+    batch->aycof[i] = sat->sgps.aycof;
+    batch->c1[i] = sat->sgps.c1;
+    batch->c4[i] = sat->sgps.c4;
+    batch->c5[i] = sat->sgps.c5;
+    batch->cosio[i] = sat->sgps.cosio;
+    batch->d2[i] = sat->sgps.d2;
+    batch->d3[i] = sat->sgps.d3;
+    batch->d4[i] = sat->sgps.d4;
+    batch->delmo[i] = sat->sgps.delmo;
+    batch->omgcof[i] = sat->sgps.omgcof;
+    batch->eta[i] = sat->sgps.eta;
+    batch->omgdot[i] = sat->sgps.omgdot;
+    batch->sinio[i] = sat->sgps.sinio;
+    batch->xnodp[i] = sat->sgps.xnodp;
+    batch->sinmo[i] = sat->sgps.sinmo;
+    batch->t2cof[i] = sat->sgps.t2cof;
+    batch->t3cof[i] = sat->sgps.t3cof;
+    batch->t4cof[i] = sat->sgps.t4cof;
+    batch->t5cof[i] = sat->sgps.t5cof;
+    batch->x1mth2[i] = sat->sgps.x1mth2;
+    batch->x3thm1[i] = sat->sgps.x3thm1;
+    batch->x7thm1[i] = sat->sgps.x7thm1;
+    batch->xmcof[i] = sat->sgps.xmcof;
+    batch->xmdot[i] = sat->sgps.xmdot;
+    batch->xnodcf[i] = sat->sgps.xnodcf;
+    batch->xnodot[i] = sat->sgps.xnodot;
+    batch->xlcof[i] = sat->sgps.xlcof;
+
+    return i;
+}
+
+/* Secular gravity, drag and long period periodics for all satellites */
+static void Batch_Secular(sgp4_batch_t * b, double jul_utc)
+{
+    double          tsince, xmdf, omgadf, xnoddf, omega, xmp, tsq, xnode,
+        tempa, tempe, templ, delomg, delm, temp, tcube, tfour, a, e, xl,
+        beta, axn, xll, aynl;
+    int             i;
+
+    for (i = 0; i < b->num; i++)
+    {
+        /* a skipped lane counts as converged for Batch_Kepler() */
+        if (b->skip[i])
+        {
+            b->done[i] = 1;
+            continue;
+        }
+
+        tsince = (jul_utc - b->jul_epoch[i]) * xmnpda;
+
+        /* Update for secular gravity and atmospheric drag. */
+        xmdf = b->xmo[i] + b->xmdot[i] * tsince;
+        omgadf = b->omegao[i] + b->omgdot[i] * tsince;
+        xnoddf = b->xnodeo[i] + b->xnodot[i] * tsince;
+        omega = omgadf;
+        xmp = xmdf;
+        tsq = tsince * tsince;
+        xnode = xnoddf + b->xnodcf[i] * tsq;
+        tempa = 1.0 - b->c1[i] * tsince;
+        tempe = b->bstar[i] * b->c4[i] * tsince;
+        templ = b->t2cof[i] * tsq;
+        if (b->simple[i] == 0.0)
+        {
+            delomg = b->omgcof[i] * tsince;
+            delm = b->xmcof[i] * (pow(1 + b->eta[i] * cos(xmdf), 3) -
+                                  b->delmo[i]);
+            temp = delomg + delm;
+            xmp = xmdf + temp;
+            omega = omgadf - temp;
+            tcube = tsq * tsince;
+            tfour = tsince * tcube;
+            tempa = tempa - b->d2[i] * tsq - b->d3[i] * tcube -
+                b->d4[i] * tfour;
+            tempe = tempe + b->bstar[i] * b->c5[i] * (sin(xmp) - b->sinmo[i]);
+            templ = templ + b->t3cof[i] * tcube + tfour *
+                (b->t4cof[i] + tsince * b->t5cof[i]);
+        }
+
+        a = b->aodp[i] * pow(tempa, 2);
+        e = b->eo[i] - tempe;
+        xl = xmp + omega + xnode + b->xnodp[i] * templ;
+        beta = sqrt(1.0 - e * e);
+
+        /* Long period periodics */
+        axn = e * cos(omega);
+        temp = 1.0 / (a * beta * beta);
+        xll = temp * b->xlcof[i] * axn;
+        aynl = temp * b->aycof[i];
+
+        b->tsince[i] = tsince;
+        b->a[i] = a;
+        b->xn[i] = xke / pow(a, 1.5);
+        b->xnode[i] = xnode;
+        b->omgadf[i] = omgadf;
+        b->omega[i] = omega;
+        b->xlt[i] = xl + xll;
+        b->axn[i] = axn;
+        b->ayn[i] = e * sin(omega) + aynl;
+        b->capu[i] = FMod2p(b->xlt[i] - xnode);
+        b->epw[i] = b->capu[i];
+        b->done[i] = 0;
+    }
+}
+
+/* Solve Kepler's equation for all satellites.
+   Every lane is frozen as soon as it has converged, exactly like the
+   early break in SGP4(), so the number of iterations per satellite
+   is the same as in the scalar code. A lane that has not converged
+   after the last iteration keeps the previous iterate, since SGP4()
+   uses the sine and cosine of that one. */
+static void Batch_Kepler(sgp4_batch_t * b)
+{
+    double          sinepw, cosepw, epw, temp2;
+    int             i, k, active;
+
+    for (k = 0; k <= 10; k++)
+    {
+        active = 0;
+
+        for (i = 0; i < b->num; i++)
+        {
+            if (b->done[i])
+                continue;
+
+            temp2 = b->epw[i];
+            sinepw = sin(temp2);
+            cosepw = cos(temp2);
+            epw = (b->capu[i] - b->ayn[i] * cosepw + b->axn[i] * sinepw -
+                   temp2) / (1.0 - b->axn[i] * cosepw - b->ayn[i] * sinepw) +
+                temp2;
+
+            if (fabs(epw - temp2) <= e6a || k == 10)
+                b->done[i] = 1;
+            else
+            {
+                b->epw[i] = epw;
+                active++;
+            }
+        }
+
+        if (active == 0)
+            break;
+    }
+}
+
+/* Short period periodics and state vectors for all satellites */
+static void Batch_Periodics(sgp4_batch_t * b)
+{
+    double          a, axn, ayn, sinepw, cosepw, temp, temp1, temp2, temp3,
+        temp4, temp5, temp6, ecose, esine, elsq, pl, r, rdot, rfdot, betal,
+        cosu, sinu, u, sin2u, cos2u, rk, uk, xnodek, xinck, rdotk, rfdotk,
+        sinuk, cosuk, sinik, cosik, sinnok, cosnok, xmx, xmy, ux, uy, uz, vx,
+        vy, vz, phase;
+    int             i;
+
+    for (i = 0; i < b->num; i++)
+    {
+        if (b->skip[i])
+            continue;
+
+        a = b->a[i];
+        axn = b->axn[i];
+        ayn = b->ayn[i];
+
+        sinepw = sin(b->epw[i]);
+        cosepw = cos(b->epw[i]);
+        temp3 = axn * sinepw;
+        temp4 = ayn * cosepw;
+        temp5 = axn * cosepw;
+        temp6 = ayn * sinepw;
+
+        /* Short period preliminary quantities */
+        ecose = temp5 + temp6;
+        esine = temp3 - temp4;
+        elsq = axn * axn + ayn * ayn;
+        temp = 1.0 - elsq;
+        pl = a * temp;
+        r = a * (1.0 - ecose);
+        temp1 = 1.0 / r;
+        rdot = xke * sqrt(a) * esine * temp1;
+        rfdot = xke * sqrt(pl) * temp1;
+        temp2 = a * temp1;
+        betal = sqrt(temp);
+        temp3 = 1.0 / (1.0 + betal);
+        cosu = temp2 * (cosepw - axn + ayn * esine * temp3);
+        sinu = temp2 * (sinepw - ayn - axn * esine * temp3);
+        u = AcTan(sinu, cosu);
+        sin2u = 2.0 * sinu * cosu;
+        cos2u = 2.0 * cosu * cosu - 1.0;
+        temp = 1.0 / pl;
+        temp1 = ck2 * temp;
+        temp2 = temp1 * temp;
+
+        /* Update for short periodics */
+        rk = r * (1.0 - 1.5 * temp2 * betal * b->x3thm1[i]) +
+            0.5 * temp1 * b->x1mth2[i] * cos2u;
+        uk = u - 0.25 * temp2 * b->x7thm1[i] * sin2u;
+        xnodek = b->xnode[i] + 1.5 * temp2 * b->cosio[i] * sin2u;
+        xinck = b->xincl[i] + 1.5 * temp2 * b->cosio[i] * b->sinio[i] * cos2u;
+        rdotk = rdot - b->xn[i] * temp1 * b->x1mth2[i] * sin2u;
+        rfdotk = rfdot + b->xn[i] * temp1 *
+            (b->x1mth2[i] * cos2u + 1.5 * b->x3thm1[i]);
+
+        /* Orientation vectors */
+        sinuk = sin(uk);
+        cosuk = cos(uk);
+        sinik = sin(xinck);
+        cosik = cos(xinck);
+        sinnok = sin(xnodek);
+        cosnok = cos(xnodek);
+        xmx = -sinnok * cosik;
+        xmy = cosnok * cosik;
+        ux = xmx * sinuk + cosnok * cosuk;
+        uy = xmy * sinuk + sinnok * cosuk;
+        uz = sinik * sinuk;
+        vx = xmx * cosuk - cosnok * sinuk;
+        vy = xmy * cosuk - sinnok * sinuk;
+        vz = sinik * cosuk;
+
+        /* Position and velocity */
+        b->x[i] = rk * ux;
+        b->y[i] = rk * uy;
+        b->z[i] = rk * uz;
+        b->vx[i] = rdotk * ux + rfdotk * vx;
+        b->vy[i] = rdotk * uy + rfdotk * vy;
+        b->vz[i] = rdotk * uz + rfdotk * vz;
+
+        phase = b->xlt[i] - b->xnode[i] - b->omgadf[i] + twopi;
+        if (phase < 0)
+            phase += twopi;
+        b->phase[i] = FMod2p(phase);
+        b->xnodek[i] = xnodek;
+        b->xinck[i] = xinck;
+    }
+}
+
+/* Propagate all satellites in the batch to jul_utc.
+   The raw position, velocity and phase (in the same units as returned by
+   SGP4) as well as jul_utc and tsince are stored back in each sat_t;
+   use Convert_Sat_State() to convert the state to km and km/s.
+   Satellites whose batch->skip entry is set are left out. */
+void SGP4_Batch_Propagate(sgp4_batch_t * batch, double jul_utc)
+{
+    sat_t          *sat;
+    int             i;
+
+    if (batch == NULL || batch->num == 0)
+        return;
+
+    Batch_Secular(batch, jul_utc);
+    Batch_Kepler(batch);
+    Batch_Periodics(batch);
+
+    for (i = 0; i < batch->num; i++)
+    {
+        if (batch->skip[i])
+            continue;
+
+        sat = batch->sats[i];
+        sat->jul_utc = jul_utc;
+        sat->tsince = batch->tsince[i];
+        sat->pos.x = batch->x[i];
+        sat->pos.y = batch->y[i];
+        sat->pos.z = batch->z[i];
+        sat->vel.x = batch->vx[i];
+        sat->vel.y = batch->vy[i];
+        sat->vel.z = batch->vz[i];
+        sat->phase = batch->phase[i];
+        sat->tle.omegao1 = batch->omega[i];
+        sat->tle.xincl1 = batch->xinck[i];
+        sat->tle.xnodeo1 = batch->xnodek[i];
+    }
+}
@@ -0,0 +1,268 @@
+/*
+ * Unit SGP_Cheb
+ *
+ * Chebyshev ephemeris cache.
+ *
+ * Consumers that update at a fixed tick (list, map, polar view, radio
+ * and rotator control) evaluate each satellite at times that are only a
+ * second or so apart. The cache fits Chebyshev polynomials to the
+ * SGP4/SDP4 position, velocity and phase over a short window (typically
+ * 10 minutes) and answers queries inside the window by evaluating the
+ * polynomials, which is much cheaper than running the propagator.
+ *
+ * When a fit is made, the propagator is also run halfway between the
+ * Chebyshev nodes and the fit is only accepted if the position error is
+ * within the configured tolerance there. Otherwise the window is halved
+ * and the fit is repeated. If even the shortest window does not meet
+ * the tolerance, the satellite is propagated directly for the rest of
+ * the nominal window.
+ *
+ * SDP4() output depends a little on the previous calls: the lunar-solar
+ * periodics are reused for 30 minutes and the resonance integrator steps
+ * back from where it was. The samples for the fits are therefore taken
+ * with fresh periodics and forward integration only, so the cached
+ * ephemeris is smooth and does not depend on the history.
+ *
+ * A new window is fitted when a query falls outside the current one. The
+ * window is placed ahead of the query in the direction the time is
+ * moving, so that the time controller can run backwards too.
+ */
+
+#include "sgp4sdp4.h"
+
+/* Shortest window to try before giving up [min] */
+#define EPHEM_MIN_SPAN  0.5
+
+/* Fraction of the tolerance allowed at the check points. The error
+   between the check points can be slightly larger. */
+#define EPHEM_TOL_MARGIN 0.5
+
+/* Call the propagator selected for the satellite. SDP4 is made to    */
+/* give the same result no matter what it has been called with before: */
+/* the lunar-solar periodics are recalculated instead of reusing those */
+/* from up to 30 minutes ago, and the resonance integrator integrates  */
+/* forward from epoch instead of stepping back. Otherwise the samples  */
+/* may contain small steps which can not be fitted.                    */
+static void Ephem_Sample(sat_t * sat, double tsince)
+{
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+    {
+        sat->state.savtsn = 1E20;
+        if (fabs(tsince) < fabs(sat->state.atime))
+            sat->state.atime = 0;
+        SDP4(sat, tsince);
+    }
+    else
+        SGP4(sat, tsince);
+}
+
+/* Evaluate a Chebyshev series at x in [-1;1] (Clenshaw recurrence) */
+static double Cheb_Eval(const double *c, double x)
+{
+    double          b0 = 0.0, b1 = 0.0, b2;
+    int             j;
+
+    for (j = EPHEM_NUM_COEFFS - 1; j >= 1; j--)
+    {
+        b2 = b1;
+        b1 = b0;
+        b0 = 2.0 * x * b1 - b2 + c[j];
+    }
+
+    return x * b0 - b1 + c[0];
+}
+
+/* Evaluate all channels at x; same as Cheb_Eval() on each channel, */
+/* but the independent recurrences are interleaved.                 */
+static void Cheb_Eval_All(const ephem_cache_t * cache, double x,
+                          double v[EPHEM_NUM_CHANNELS])
+{
+    double          b0[EPHEM_NUM_CHANNELS], b1[EPHEM_NUM_CHANNELS], b2;
+    int             i, j;
+
+    for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+        b0[i] = b1[i] = 0.0;
+
+    for (j = EPHEM_NUM_COEFFS - 1; j >= 1; j--)
+        for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+        {
+            b2 = b1[i];
+            b1[i] = b0[i];
+            b0[i] = 2.0 * x * b1[i] - b2 + cache->c[i][j];
+        }
+
+    for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+        v[i] = x * b0[i] - b1[i] + cache->c[i][0];
+}
+
+/* Fit the window [t0;t0+span] and return 1 if the result is within */
+/* the tolerance. The coefficients are stored in cache->c in any case. */
+static int Ephem_Fit(sat_t * sat, ephem_cache_t * cache, double t0,
+                     double span)
+{
+    double          f[EPHEM_NUM_CHANNELS][EPHEM_NUM_COEFFS];
+    double          chk[EPHEM_NUM_COEFFS - 1][3];
+    double          xchk[EPHEM_NUM_COEFFS - 1];
+    double          xnode[EPHEM_NUM_COEFFS];
+    double          tj[EPHEM_NUM_COEFFS];
+    double          x, t, phase, prev = 0.0;
+    double          dx, dy, dz, tol;
+    int             i, j, k, n = EPHEM_NUM_COEFFS;
+
+    /* The nodes are x_k = cos(pi*(k+0.5)/n) and the check points are */
+    /* halfway in between at cos(pi*k/n). Both are cos(pi*i/2n) with  */
+    /* odd and even i, respectively. Visit them with decreasing i,    */
+    /* i.e. increasing time, so that SDP4 always integrates forward.  */
+    for (i = 2 * n - 1; i >= 1; i--)
+    {
+        x = cos(pi * i / (2.0 * n));
+        t = t0 + 0.5 * (x + 1.0) * span;
+        Ephem_Sample(sat, t);
+
+        /* unwrap the phase so that it can be fitted */
+        phase = sat->phase;
+        if (i < 2 * n - 1)
+        {
+            while (phase - prev > pi)
+                phase -= twopi;
+            while (phase - prev < -pi)
+                phase += twopi;
+        }
+        prev = phase;
+
+        if (i & 1)
+        {
+            k = (i - 1) / 2;
+            xnode[k] = x;
+            f[0][k] = sat->pos.x;
+            f[1][k] = sat->pos.y;
+            f[2][k] = sat->pos.z;
+            f[3][k] = sat->vel.x;
+            f[4][k] = sat->vel.y;
+            f[5][k] = sat->vel.z;
+            f[6][k] = phase;
+        }
+        else
+        {
+            k = i / 2 - 1;
+            xchk[k] = x;
+            chk[k][0] = sat->pos.x;
+            chk[k][1] = sat->pos.y;
+            chk[k][2] = sat->pos.z;
+        }
+    }
+
+    /* c_j = 2/n * sum_k f(x_k) * T_j(x_k), with c_0 halved */
+    for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+        for (j = 0; j < n; j++)
+            cache->c[i][j] = 0.0;
+
+    for (k = 0; k < n; k++)
+    {
+        tj[0] = 1.0;
+        tj[1] = xnode[k];
+        for (j = 2; j < n; j++)
+            tj[j] = 2.0 * xnode[k] * tj[j - 1] - tj[j - 2];
+
+        for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+            for (j = 0; j < n; j++)
+                cache->c[i][j] += f[i][k] * tj[j];
+    }
+
+    for (i = 0; i < EPHEM_NUM_CHANNELS; i++)
+    {
+        for (j = 0; j < n; j++)
+            cache->c[i][j] *= 2.0 / n;
+        cache->c[i][0] *= 0.5;
+    }
+
+    /* position is in earth radii */
+    tol = EPHEM_TOL_MARGIN * cache->tol / xkmper;
+    for (k = 0; k < n - 1; k++)
+    {
+        dx = Cheb_Eval(cache->c[0], xchk[k]) - chk[k][0];
+        dy = Cheb_Eval(cache->c[1], xchk[k]) - chk[k][1];
+        dz = Cheb_Eval(cache->c[2], xchk[k]) - chk[k][2];
+        if (sqrt(dx * dx + dy * dy + dz * dz) > tol)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Ephem_Cache_Init */
+/* Initialize an empty cache. span is the nominal window length in */
+/* minutes and tol is the maximum position error in km.            */
+void Ephem_Cache_Init(ephem_cache_t * cache, double span, double tol)
+{
+    cache->span = span;
+    cache->tol = tol;
+    cache->fits = 0;
+    Ephem_Cache_Reset(cache);
+}
+
+/* Ephem_Cache_Reset */
+/* Drop the current window, e.g. after the elements have changed. */
+void Ephem_Cache_Reset(ephem_cache_t * cache)
+{
+    cache->tstart = 0.0;
+    cache->tend = 0.0;
+    cache->valid = 0;
+    cache->direct = 0;
+}
+
+/* Ephem_Cache_Propagate */
+/* Same as calling SGP4() or SDP4() but uses the cache when possible. */
+/* The result is stored in sat->pos, sat->vel and sat->phase. When a  */
+/* new window is fitted, the propagator state and the squint fields  */
+/* are those of the last sample in the window.                       */
+void Ephem_Cache_Propagate(sat_t * sat, ephem_cache_t * cache,
+                           double tsince)
+{
+    double          v[EPHEM_NUM_CHANNELS];
+    double          span, x;
+    int             back;
+
+    if ((!cache->valid && !cache->direct) ||
+        tsince < cache->tstart || tsince > cache->tend)
+    {
+        back = (cache->valid || cache->direct) && tsince < cache->tstart;
+
+        cache->valid = 0;
+        cache->direct = 0;
+        for (span = cache->span; span >= EPHEM_MIN_SPAN; span *= 0.5)
+        {
+            cache->tstart = back ? tsince - span : tsince;
+            cache->tend = cache->tstart + span;
+            cache->fits++;
+            if (Ephem_Fit(sat, cache, cache->tstart, span))
+            {
+                cache->valid = 1;
+                break;
+            }
+        }
+
+        if (!cache->valid)
+        {
+            cache->direct = 1;
+            cache->tstart = back ? tsince - cache->span : tsince;
+            cache->tend = cache->tstart + cache->span;
+        }
+    }
+
+    if (cache->direct)
+    {
+        Ephem_Sample(sat, tsince);
+        return;
+    }
+
+    x = 2.0 * (tsince - cache->tstart) / (cache->tend - cache->tstart) - 1.0;
+    Cheb_Eval_All(cache, x, v);
+    sat->pos.x = v[0];
+    sat->pos.y = v[1];
+    sat->pos.z = v[2];
+    sat->vel.x = v[3];
+    sat->vel.y = v[4];
+    sat->vel.z = v[5];
+    sat->phase = FMod2p(v[6]);
+}
@@ -11,6 +11,11 @@
 
 #include "sgp4sdp4.h"
 
+static void     latlonalt(double thetag, vector_t * pos, geodetic_t * geodetic);
+static void     topocentric_rot(double sin_lat, double cos_lat,
+                                double sin_theta, double cos_theta,
+                                double rot[3][3]);
+
 /* Procedure Calculate_User_PosVel passes the user's geodetic position */
 /* and the time of interest and returns the ECI position and velocity  */
 /* of the observer. The velocity calculation assumes the geodetic      */
@@ -37,19 +42,72 @@ void Calculate_User_PosVel(double _time, geodetic_t * geodetic,
     Magnitude(obs_vel);
 }
 
+/* Procedure Obs_Frame_Init precomputes the parts of the observer */
+/* position that do not change with time, so that searches which  */
+/* need the observer at many times can use Calculate_User_Frame.  */
+void Obs_Frame_Init(geodetic_t * geodetic, obs_frame_t * frame)
+{
+    double          c, sq;
+
+    frame->lon = geodetic->lon;
+    frame->sin_lat = sin(geodetic->lat);
+    frame->cos_lat = cos(geodetic->lat);
+    c = 1 / sqrt(1 + __f * (__f - 2) * Sqr(frame->sin_lat));
+    sq = Sqr(1 - __f) * c;
+    frame->achcp = (xkmper * c + geodetic->alt) * frame->cos_lat;
+    frame->z = (xkmper * sq + geodetic->alt) * frame->sin_lat;
+}
+
+/* Procedure Calculate_User_Frame is Calculate_User_PosVel for a  */
+/* precomputed observer frame. It also returns the local vertical */
+/* {up} as a unit vector. The magnitudes of the position and      */
+/* velocity are not calculated.                                   */
+void Calculate_User_Frame(double _time, const obs_frame_t * frame,
+                          vector_t * obs_pos, vector_t * obs_vel,
+                          vector_t * up)
+{
+    double          theta, sin_theta, cos_theta;
+
+    theta = FMod2p(ThetaG_JD(_time) + frame->lon);
+    sin_theta = sin(theta);
+    cos_theta = cos(theta);
+    obs_pos->x = frame->achcp * cos_theta;      /* km */
+    obs_pos->y = frame->achcp * sin_theta;
+    obs_pos->z = frame->z;
+    obs_vel->x = -mfactor * obs_pos->y; /* km/sec */
+    obs_vel->y = mfactor * obs_pos->x;
+    obs_vel->z = 0;
+    up->x = frame->cos_lat * cos_theta;
+    up->y = frame->cos_lat * sin_theta;
+    up->z = frame->sin_lat;
+}
+
 /* Procedure Calculate_LatLonAlt will calculate the geodetic  */
 /* position of an object given its ECI position pos and time. */
 /* It is intended to be used to determine the ground track of */
 /* a satellite.  The calculations  assume the earth to be an  */
 /* oblate spheroid as defined in WGS '72.                     */
 void Calculate_LatLonAlt(double _time, vector_t * pos, geodetic_t * geodetic)
+{
+    latlonalt(ThetaG_JD(_time), pos, geodetic);
+}
+
+/* Calculate_LatLonAlt for a time given by an observation context. */
+void Calculate_LatLonAlt_Context(const obs_ctx_t * ctx, vector_t * pos,
+                                 geodetic_t * geodetic)
+{
+    latlonalt(ctx->thetag, pos, geodetic);
+}
+
+/* Calculate_LatLonAlt with the sidereal time {thetag} already known. */
+static void latlonalt(double thetag, vector_t * pos, geodetic_t * geodetic)
 {
     /* Reference:  The 1992 Astronomical Almanac, page K12. */
 
     double          r, e2, phi, c;
 
     geodetic->theta = AcTan(pos->y, pos->x);    /* rad */
-    geodetic->lon = FMod2p(geodetic->theta - ThetaG_JD(_time)); /* rad */
+    geodetic->lon = FMod2p(geodetic->theta - thetag);   /* rad */
     r = sqrt(Sqr(pos->x) + Sqr(pos->y));
     e2 = __f * (2 - __f);
     geodetic->lat = AcTan(pos->z, r);   /* rad */
@@ -86,32 +144,65 @@ void Calculate_LatLonAlt(double _time, vector_t * pos, geodetic_t * geodetic)
 void Calculate_Obs(double _time, vector_t * pos,
                    vector_t * vel, geodetic_t * geodetic, obs_set_t * obs_set)
 {
-    double          sin_lat, cos_lat, sin_theta, cos_theta;
-    double          el, azim, top_s, top_e, top_z;
+    obs_ctx_t       ctx;
+
+    Calculate_User_PosVel(_time, geodetic, &ctx.obs_pos, &ctx.obs_vel);
+    topocentric_rot(sin(geodetic->lat), cos(geodetic->lat),
+                    sin(geodetic->theta), cos(geodetic->theta), ctx.rot);
+
+    Calculate_Obs_Context(&ctx, pos, vel, obs_set);
+}
 
-    vector_t        obs_pos, obs_vel, range, rgvel;
+/* Procedure Obs_Context_Init calculates everything about the observer */
+/* at time {time} that Calculate_Obs and Calculate_LatLonAlt need, so  */
+/* that it can be shared by all objects calculated for that time.      */
+void Obs_Context_Init(double _time, const obs_frame_t * frame,
+                      obs_ctx_t * ctx)
+{
+    double          sin_theta, cos_theta;
 
-    Calculate_User_PosVel(_time, geodetic, &obs_pos, &obs_vel);
+    ctx->time = _time;
+    ctx->thetag = ThetaG_JD(_time);
+    ctx->theta = FMod2p(ctx->thetag + frame->lon);
+    sin_theta = sin(ctx->theta);
+    cos_theta = cos(ctx->theta);
 
-    range.x = pos->x - obs_pos.x;
-    range.y = pos->y - obs_pos.y;
-    range.z = pos->z - obs_pos.z;
+    topocentric_rot(frame->sin_lat, frame->cos_lat, sin_theta, cos_theta,
+                    ctx->rot);
 
-    rgvel.x = vel->x - obs_vel.x;
-    rgvel.y = vel->y - obs_vel.y;
-    rgvel.z = vel->z - obs_vel.z;
+    ctx->obs_pos.x = frame->achcp * cos_theta;  /* km */
+    ctx->obs_pos.y = frame->achcp * sin_theta;
+    ctx->obs_pos.z = frame->z;
+    ctx->obs_vel.x = -mfactor * ctx->obs_pos.y; /* km/sec */
+    ctx->obs_vel.y = mfactor * ctx->obs_pos.x;
+    ctx->obs_vel.z = 0;
+    Magnitude(&ctx->obs_pos);
+    Magnitude(&ctx->obs_vel);
+}
+
+/* Calculate_Obs for the observer and time of an observation context. */
+void Calculate_Obs_Context(const obs_ctx_t * ctx, vector_t * pos,
+                           vector_t * vel, obs_set_t * obs_set)
+{
+    double          el, azim, top_s, top_e, top_z;
+
+    vector_t        range, rgvel;
+
+    range.x = pos->x - ctx->obs_pos.x;
+    range.y = pos->y - ctx->obs_pos.y;
+    range.z = pos->z - ctx->obs_pos.z;
+
+    rgvel.x = vel->x - ctx->obs_vel.x;
+    rgvel.y = vel->y - ctx->obs_vel.y;
+    rgvel.z = vel->z - ctx->obs_vel.z;
 
     Magnitude(&range);
 
-    sin_lat = sin(geodetic->lat);
-    cos_lat = cos(geodetic->lat);
-    sin_theta = sin(geodetic->theta);
-    cos_theta = cos(geodetic->theta);
-    top_s = sin_lat * cos_theta * range.x
-        + sin_lat * sin_theta * range.y - cos_lat * range.z;
-    top_e = -sin_theta * range.x + cos_theta * range.y;
-    top_z = cos_lat * cos_theta * range.x
-        + cos_lat * sin_theta * range.y + sin_lat * range.z;
+    top_s = ctx->rot[0][0] * range.x
+        + ctx->rot[0][1] * range.y + ctx->rot[0][2] * range.z;
+    top_e = ctx->rot[1][0] * range.x + ctx->rot[1][1] * range.y;
+    top_z = ctx->rot[2][0] * range.x
+        + ctx->rot[2][1] * range.y + ctx->rot[2][2] * range.z;
     azim = atan(-top_e / top_s);        /*Azimuth */
     if (top_s > 0)
         azim = azim + pi;
@@ -130,13 +221,24 @@ void Calculate_Obs(double _time, vector_t * pos,
 /* Correction is meaningless when apparent elevation is below horizon */
 //      obs_set->el = obs_set->el + Radians((1.02/tan(Radians(Degrees(el)+
 //                                                            10.3/(Degrees(el)+5.11))))/60);
-    if (obs_set->el >= 0)
-        SetFlag(VISIBLE_FLAG);
-    else
-    {
+    if (obs_set->el < 0)
         obs_set->el = el;       /*Reset to true elevation */
-        ClearFlag(VISIBLE_FLAG);
-    }
+}
+
+/* Rotation from ECI to the topocentric south, east, zenith frame. */
+static void topocentric_rot(double sin_lat, double cos_lat,
+                            double sin_theta, double cos_theta,
+                            double rot[3][3])
+{
+    rot[0][0] = sin_lat * cos_theta;
+    rot[0][1] = sin_lat * sin_theta;
+    rot[0][2] = -cos_lat;
+    rot[1][0] = -sin_theta;
+    rot[1][1] = cos_theta;
+    rot[1][2] = 0;
+    rot[2][0] = cos_lat * cos_theta;
+    rot[2][1] = cos_lat * sin_theta;
+    rot[2][2] = sin_lat;
 }
 
 void Calculate_RADec_and_Obs(double _time, vector_t * pos, vector_t * vel,
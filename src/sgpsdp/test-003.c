@@ -0,0 +1,156 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/* Unit test for the SGP4 batch propagator.
+   All near-earth satellites from the bundled satellites.dat are
+   propagated with SGP4_Batch_Propagate() and with SGP4() and the
+   results are compared bit for bit. On every other step half of the
+   satellites are skipped, and those must not be touched.
+   Note: This is built with -ffp-contract=off, see Makefile.am,
+   otherwise the two code paths may be contracted differently on
+   targets with FMA instructions and the last bits will not match. */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sgp4sdp4.h"
+
+#define MAX_SATS   10000
+#define TEST_STEPS 5
+
+/* time offsets from the first epoch [days] */
+const double    offsets[TEST_STEPS] = { 0.0, 0.25, 1.0, 3.5, 10.0 };
+
+sat_t           sats[MAX_SATS];
+sat_t           ref;
+
+/* read all satellites from a gpredict satellites.dat file */
+static int read_catalog(const char *fname)
+{
+    FILE           *fp;
+    char            line[80];
+    char            tle_str[3][80];
+    int             num = 0;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL && num < MAX_SATS)
+    {
+        if (strncmp(line, "NAME=", 5) == 0)
+            snprintf(tle_str[0], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE1=", 5) == 0)
+            snprintf(tle_str[1], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE2=", 5) == 0)
+        {
+            snprintf(tle_str[2], 80, "%s", &line[5]);
+            memset(&sats[num], 0, sizeof(sat_t));
+            if (Get_Next_Tle_Set(tle_str, &sats[num].tle) == 1)
+            {
+                select_ephemeris(&sats[num]);
+                sats[num].jul_epoch = Julian_Date_of_Epoch(sats[num].tle.epoch);
+                num++;
+            }
+        }
+    }
+    fclose(fp);
+
+    return num;
+}
+
+int main(int argc, char *argv[])
+{
+    sgp4_batch_t   *batch;
+    double          t0, t;
+    int             num, i, j, errors = 0;
+
+    num = read_catalog(argc > 1 ? argv[1] :
+                       "../../data/satdata/satellites.dat");
+    if (num == 0)
+        return 1;
+
+    batch = SGP4_Batch_Create(num);
+    for (i = 0; i < num; i++)
+        SGP4_Batch_Add(batch, &sats[i]);
+
+    printf("Read %d satellites, %d in batch\n", num, batch->num);
+
+    t0 = sats[0].jul_epoch;
+    for (j = 0; j < TEST_STEPS; j++)
+    {
+        t = t0 + offsets[j];
+        for (i = 0; i < batch->num; i++)
+            batch->skip[i] = (j % 2) && (i % 2);
+
+        SGP4_Batch_Propagate(batch, t);
+
+        for (i = 0; i < batch->num; i++)
+        {
+            if (batch->skip[i])
+            {
+                if (batch->sats[i]->jul_utc == t)
+                {
+                    printf("STEP %d: SKIPPED %d (%s) was propagated\n",
+                           j + 1, batch->sats[i]->tle.catnr,
+                           batch->sats[i]->tle.sat_name);
+                    errors++;
+                }
+                continue;
+            }
+
+            memcpy(&ref, batch->sats[i], sizeof(sat_t));
+            SGP4(&ref, (t - ref.jul_epoch) * xmnpda);
+
+            if (ref.pos.x != batch->sats[i]->pos.x ||
+                ref.pos.y != batch->sats[i]->pos.y ||
+                ref.pos.z != batch->sats[i]->pos.z ||
+                ref.vel.x != batch->sats[i]->vel.x ||
+                ref.vel.y != batch->sats[i]->vel.y ||
+                ref.vel.z != batch->sats[i]->vel.z ||
+                ref.phase != batch->sats[i]->phase)
+            {
+                printf("STEP %d: MISMATCH for %d (%s)\n", j + 1,
+                       ref.tle.catnr, ref.tle.sat_name);
+                errors++;
+            }
+        }
+        printf("STEP %d  t: %.5f  %d satellites checked\n", j + 1, t,
+               batch->num);
+    }
+
+    SGP4_Batch_Free(batch);
+
+    printf("\n%d errors\n", errors);
+
+    return errors ? 1 : 0;
+}
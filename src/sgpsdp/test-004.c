@@ -0,0 +1,238 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/* Thread safety stress test for the SGP4/SDP4 library.
+   The bundled satellites.dat is propagated once in the main thread with
+   SGP4() and SDP4() to produce a reference. Then NUM_THREADS threads
+   propagate the same catalog concurrently with SGP4_Eval() and
+   SDP4_Eval(), sharing the initialized sat_t structures and using one
+   sgpsdp_state_t per satellite and thread. Every thread must reproduce
+   the reference bit for bit.
+
+   Usage: test-004 [satellites.dat] [threads] */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include "sgp4sdp4.h"
+
+#define MAX_SATS    10000
+#define NUM_THREADS 16
+#define TEST_STEPS  8
+
+/* one propagation result */
+typedef struct {
+    vector_t        pos;
+    vector_t        vel;
+    obs_set_t       obs;
+    double          depth;
+    int             eclipsed;
+} result_t;
+
+/* per-thread job */
+typedef struct {
+    sgpsdp_state_t *states;
+    result_t       *res;
+    int             errors;
+} job_t;
+
+sat_t           catalog[MAX_SATS];
+result_t       *reference;
+int             num;
+double          t0;
+
+/* read all satellites from a gpredict satellites.dat file */
+static int read_catalog(const char *fname)
+{
+    FILE           *fp;
+    char            line[80];
+    char            tle_str[3][80];
+    int             n = 0;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL && n < MAX_SATS)
+    {
+        if (strncmp(line, "NAME=", 5) == 0)
+            snprintf(tle_str[0], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE1=", 5) == 0)
+            snprintf(tle_str[1], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE2=", 5) == 0)
+        {
+            snprintf(tle_str[2], 80, "%s", &line[5]);
+            memset(&catalog[n], 0, sizeof(sat_t));
+            if (Get_Next_Tle_Set(tle_str, &catalog[n].tle) == 1)
+            {
+                select_ephemeris(&catalog[n]);
+                catalog[n].jul_epoch =
+                    Julian_Date_of_Epoch(catalog[n].tle.epoch);
+
+                /* initialize like gtk_sat_data_init_sat() does */
+                if (catalog[n].flags & DEEP_SPACE_EPHEM_FLAG)
+                    SDP4(&catalog[n], 0.0);
+                else
+                    SGP4(&catalog[n], 0.0);
+                n++;
+            }
+        }
+    }
+    fclose(fp);
+
+    return n;
+}
+
+/* propagate all satellites over all time steps and store the results;
+   if states is NULL the satellites are propagated with SGP4() and SDP4(),
+   otherwise with SGP4_Eval() and SDP4_Eval() */
+static void propagate(sat_t * sats, sgpsdp_state_t * states, result_t * res)
+{
+    geodetic_t      obs_geodetic;
+    vector_t        solar;
+    vector_t        pos, vel;
+    double          t, tsince;
+    int             i, j;
+
+    /* OZ9AEC */
+    obs_geodetic.lat = 55.6167 * de2ra;
+    obs_geodetic.lon = 12.6500 * de2ra;
+    obs_geodetic.alt = 0.005;
+    obs_geodetic.theta = 0.0;
+
+    for (j = 0; j < TEST_STEPS; j++)
+    {
+        t = t0 + 0.37 * j;
+        Calculate_Solar_Position(t, &solar);
+
+        for (i = 0; i < num; i++)
+        {
+            result_t       *r = &res[j * num + i];
+
+            tsince = (t - sats[i].jul_epoch) * xmnpda;
+            if (states == NULL)
+            {
+                if (sats[i].flags & DEEP_SPACE_EPHEM_FLAG)
+                    SDP4(&sats[i], tsince);
+                else
+                    SGP4(&sats[i], tsince);
+                pos = sats[i].pos;
+                vel = sats[i].vel;
+            }
+            else
+            {
+                if (sats[i].flags & DEEP_SPACE_EPHEM_FLAG)
+                    SDP4_Eval(&sats[i], &states[i], tsince);
+                else
+                    SGP4_Eval(&sats[i], &states[i], tsince);
+                pos = states[i].pos;
+                vel = states[i].vel;
+            }
+
+            Convert_Sat_State(&pos, &vel);
+            r->pos = pos;
+            r->vel = vel;
+            Calculate_Obs(t, &pos, &vel, &obs_geodetic, &r->obs);
+            r->eclipsed = Sat_Eclipsed(&pos, &solar, &r->depth);
+        }
+    }
+}
+
+static gpointer worker(gpointer data)
+{
+    job_t          *job = (job_t *) data;
+    int             i;
+
+    propagate(catalog, job->states, job->res);
+
+    for (i = 0; i < num * TEST_STEPS; i++)
+        if (memcmp(&job->res[i].pos, &reference[i].pos, sizeof(vector_t)) ||
+            memcmp(&job->res[i].vel, &reference[i].vel, sizeof(vector_t)) ||
+            memcmp(&job->res[i].obs, &reference[i].obs, sizeof(obs_set_t)) ||
+            job->res[i].depth != reference[i].depth ||
+            job->res[i].eclipsed != reference[i].eclipsed)
+            job->errors++;
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    sat_t          *sats;
+    GThread        *threads[NUM_THREADS];
+    job_t           jobs[NUM_THREADS];
+    int             i, j, nthreads = NUM_THREADS, errors = 0;
+
+    num = read_catalog(argc > 1 ? argv[1] :
+                       "../../data/satdata/satellites.dat");
+    if (num == 0)
+        return 1;
+    if (argc > 2)
+        nthreads = CLAMP(atoi(argv[2]), 1, NUM_THREADS);
+
+    t0 = catalog[0].jul_epoch;
+
+    /* single threaded reference run */
+    sats = malloc(num * sizeof(sat_t));
+    reference = malloc(num * TEST_STEPS * sizeof(result_t));
+    memcpy(sats, catalog, num * sizeof(sat_t));
+    propagate(sats, NULL, reference);
+    free(sats);
+
+    printf("Read %d satellites, propagating in %d threads\n", num, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        jobs[i].states = malloc(num * sizeof(sgpsdp_state_t));
+        jobs[i].res = malloc(num * TEST_STEPS * sizeof(result_t));
+        jobs[i].errors = 0;
+        for (j = 0; j < num; j++)
+            jobs[i].states[j] = catalog[j].state;
+        threads[i] = g_thread_new("sgpsdp-test", worker, &jobs[i]);
+    }
+
+    for (i = 0; i < nthreads; i++)
+    {
+        g_thread_join(threads[i]);
+        printf("THREAD %2d: %d mismatches\n", i, jobs[i].errors);
+        errors += jobs[i].errors;
+        free(jobs[i].states);
+        free(jobs[i].res);
+    }
+
+    free(reference);
+
+    printf("\n%d errors\n", errors);
+
+    return errors ? 1 : 0;
+}
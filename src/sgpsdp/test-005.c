@@ -0,0 +1,174 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/* Unit test for the Chebyshev ephemeris cache.
+   Every satellite from the bundled satellites.dat is propagated over
+   a few hours with one second steps, first forwards and then backwards,
+   using Ephem_Cache_Propagate(). Each result is compared with a
+   direct SGP4()/SDP4() call and the position error must be within the
+   tolerance of the cache.
+   Note: The SGP4 and SDP4 output itself is not smooth at the 10 m level
+   (mainly because Kepler's equation is only solved to 1E-6), so the
+   tolerance should not be much smaller than the default 100 m.
+
+   Usage: test-005 [satellites.dat] [tolerance in km] */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sgp4sdp4.h"
+
+#define MAX_SATS   10000
+#define TEST_SPAN  180.0        /* minutes */
+#define TEST_STEP  (1.0 / 60.0) /* minutes */
+#define CACHE_SPAN 10.0         /* minutes */
+
+sat_t           sats[MAX_SATS];
+sat_t           ref;
+
+/* read all satellites from a gpredict satellites.dat file */
+static int read_catalog(const char *fname)
+{
+    FILE           *fp;
+    char            line[80];
+    char            tle_str[3][80];
+    int             num = 0;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL && num < MAX_SATS)
+    {
+        if (strncmp(line, "NAME=", 5) == 0)
+            snprintf(tle_str[0], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE1=", 5) == 0)
+            snprintf(tle_str[1], 80, "%s", &line[5]);
+        else if (strncmp(line, "TLE2=", 5) == 0)
+        {
+            snprintf(tle_str[2], 80, "%s", &line[5]);
+            memset(&sats[num], 0, sizeof(sat_t));
+            if (Get_Next_Tle_Set(tle_str, &sats[num].tle) == 1)
+            {
+                select_ephemeris(&sats[num]);
+                sats[num].jul_epoch = Julian_Date_of_Epoch(sats[num].tle.epoch);
+                num++;
+            }
+        }
+    }
+    fclose(fp);
+
+    return num;
+}
+
+/* propagate sat with the cache at tsince and return the position
+   error in km compared to a direct propagation */
+static double check(sat_t * sat, ephem_cache_t * cache, double tsince)
+{
+    double          dx, dy, dz;
+
+    memcpy(&ref, sat, sizeof(sat_t));
+    if (ref.flags & DEEP_SPACE_EPHEM_FLAG)
+    {
+        /* compare with the history independent SDP4, see sgp_cheb.c */
+        ref.state.savtsn = 1E20;
+        if (fabs(tsince) < fabs(ref.state.atime))
+            ref.state.atime = 0;
+        SDP4(&ref, tsince);
+    }
+    else
+        SGP4(&ref, tsince);
+
+    Ephem_Cache_Propagate(sat, cache, tsince);
+
+    dx = sat->pos.x - ref.pos.x;
+    dy = sat->pos.y - ref.pos.y;
+    dz = sat->pos.z - ref.pos.z;
+
+    return xkmper * sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+int main(int argc, char *argv[])
+{
+    ephem_cache_t   cache;
+    double          tol, t0, t, err, maxerr = 0.0;
+    long            fits = 0, evals = 0, direct = 0;
+    int             num, i, errors = 0;
+
+    num = read_catalog(argc > 1 ? argv[1] :
+                       "../../data/satdata/satellites.dat");
+    if (num == 0)
+        return 1;
+
+    tol = argc > 2 ? atof(argv[2]) : 0.1;
+
+    printf("Read %d satellites, tolerance %.4f km\n", num, tol);
+
+    t0 = sats[0].jul_epoch;
+    for (i = 0; i < num; i++)
+    {
+        Ephem_Cache_Init(&cache, CACHE_SPAN, tol);
+
+        for (t = 0.0; t <= TEST_SPAN; t += TEST_STEP)
+        {
+            err = check(&sats[i], &cache, (t0 - sats[i].jul_epoch) * xmnpda + t);
+            if (err > maxerr)
+                maxerr = err;
+            if (err > tol)
+                errors++;
+            if (cache.direct)
+                direct++;
+            evals++;
+        }
+
+        /* and back again */
+        for (t = TEST_SPAN; t >= 0.0; t -= TEST_STEP)
+        {
+            err = check(&sats[i], &cache, (t0 - sats[i].jul_epoch) * xmnpda + t);
+            if (err > maxerr)
+                maxerr = err;
+            if (err > tol)
+                errors++;
+            if (cache.direct)
+                direct++;
+            evals++;
+        }
+
+        fits += cache.fits;
+    }
+
+    printf("%ld evaluations, %ld fits, %ld direct\n", evals, fits, direct);
+    printf("Max error: %.6f km\n", maxerr);
+    printf("\n%d errors\n", errors);
+
+    return errors ? 1 : 0;
+}
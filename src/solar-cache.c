@@ -0,0 +1,155 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \file solar-cache.c
+ * \brief Cached position of the sun.
+ *
+ * The visibility of a satellite depends on the position of the sun, which
+ * is needed for every pass detail and for every satellite in the list
+ * views on every update. Calculate_Solar_Position() is evaluated here on
+ * a fixed grid of SOLAR_CACHE_STEP and the positions in between are
+ * interpolated linearly.
+ *
+ * The sun moves along its orbit by about 1 degree per day, so the error
+ * of the interpolation is below (n h)^2 / 8 of the distance, where n is
+ * the mean motion of the sun and h the grid step. With a one hour grid
+ * this is 7e-8 rad or 0.015 arc seconds in direction, far below the
+ * accuracy of the solar model itself.
+ *
+ * The elevation of the sun at the QTH changes with the rotation of the
+ * earth and is not interpolated. It is calculated from the cached sun
+ * position and an observer frame set up once by the caller, which only
+ * needs the sidereal time and a dot product, and it is as accurate as the
+ * position.
+ *
+ * Each thread keeps its own table of grid points, so the prediction
+ * workers can use the functions at the same time without any locking.
+ * A table only holds a few days around the times a thread works on, and
+ * filling it costs one Calculate_Solar_Position() per hour of that span.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+
+#include "solar-cache.h"
+
+
+/** \brief Grid step of the cache [days]. */
+#define SOLAR_CACHE_STEP (1.0 / 24.0)
+
+/** \brief Number of grid points kept, must be a power of two. */
+#define SOLAR_CACHE_SIZE 256
+
+/** \brief Sun position at a grid point. */
+typedef struct {
+    gint64          k;          /*!< Grid index, time is k * SOLAR_CACHE_STEP */
+    gboolean        valid;      /*!< Whether the entry holds a position */
+    vector_t        pos;        /*!< Sun position in ECI [km] */
+} solar_node_t;
+
+/* grid points of each thread, indexed by k modulo SOLAR_CACHE_SIZE */
+static GPrivate solar_nodes = G_PRIVATE_INIT(g_free);
+
+
+/** \brief Get the sun position at a grid point from the thread's table. */
+static const vector_t *solar_node(solar_node_t * nodes, gint64 k)
+{
+    solar_node_t   *node = &nodes[k & (SOLAR_CACHE_SIZE - 1)];
+
+    if (!node->valid || node->k != k)
+    {
+        Calculate_Solar_Position(k * SOLAR_CACHE_STEP, &node->pos);
+        node->k = k;
+        node->valid = TRUE;
+    }
+
+    return &node->pos;
+}
+
+/**
+ * \brief Get the position of the sun.
+ * \param jul_utc The time (Julian date).
+ * \param sun The ECI position of the sun [km], including the magnitude.
+ *
+ * This is Calculate_Solar_Position() within the accuracy described above.
+ */
+void solar_cache_pos(gdouble jul_utc, vector_t * sun)
+{
+    solar_node_t   *nodes = g_private_get(&solar_nodes);
+    const vector_t *p0, *p1;
+    gdouble         x, f;
+    gint64          k;
+
+    if (nodes == NULL)
+    {
+        nodes = g_new0(solar_node_t, SOLAR_CACHE_SIZE);
+        g_private_set(&solar_nodes, nodes);
+    }
+
+    x = jul_utc / SOLAR_CACHE_STEP;
+    k = (gint64) floor(x);
+    f = x - k;
+
+    p0 = solar_node(nodes, k);
+    p1 = solar_node(nodes, k + 1);
+
+    sun->x = p0->x + f * (p1->x - p0->x);
+    sun->y = p0->y + f * (p1->y - p0->y);
+    sun->z = p0->z + f * (p1->z - p0->z);
+
+    Magnitude(sun);
+}
+
+/**
+ * \brief Get the elevation of the sun.
+ * \param jul_utc The time (Julian date).
+ * \param sun The position of the sun at jul_utc from solar_cache_pos().
+ * \param frame The observer frame of the QTH, see predict_obs_frame().
+ * \return The elevation of the sun [deg].
+ *
+ * This is the elevation Calculate_Obs() gives for the sun, but without
+ * the azimuth, range and range rate.
+ */
+gdouble solar_cache_el(gdouble jul_utc, const vector_t * sun,
+                       const obs_frame_t * frame)
+{
+    vector_t        obs_pos, obs_vel, up, range;
+
+    Calculate_User_Frame(jul_utc, frame, &obs_pos, &obs_vel, &up);
+
+    range.x = sun->x - obs_pos.x;
+    range.y = sun->y - obs_pos.y;
+    range.z = sun->z - obs_pos.z;
+    Magnitude(&range);
+
+    return Degrees(ArcSin((up.x * range.x + up.y * range.y +
+                           up.z * range.z) / range.w));
+}
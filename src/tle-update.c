@@ -40,6 +40,7 @@
 
 #include "compat.h"
 #include "gpredict-utils.h"
+#include "pass-cache.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
@@ -1316,6 +1317,8 @@ static void update_tle_in_file(const gchar * ldname,
                                        ntle->status);
                 updateddata = TRUE;
 
+                /* passes predicted from the old elements are useless */
+                pass_cache_invalidate(catnr);
             }
             else if (tle.epoch == ntle->epoch)
             {